@@ -17,6 +17,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "dialogs/fetchdialog.h"
 #include "dialogs/initdialog.h"
 #include "dialogs/mergedialog.h"
+#include "dialogs/pickaxedialog.h"
 #include "dialogs/pulldialog.h"
 #include "dialogs/reposettingsdialog.h"
 #include "dialogs/runnerdialog.h"
@@ -160,12 +161,14 @@ void AppWindow::updateActions(bool enabled)
 {
     mRepoStatusAction->setEnabled(enabled);
     mRepoCleanupAction->setEnabled(enabled);
+    mRepoCommitGraphAction->setEnabled(enabled);
     mRepoPullAction->setEnabled(enabled);
     mRepoFetchAction->setEnabled(enabled);
     mRepoPushAction->setEnabled(enabled);
     mRepoMergeAction->setEnabled(enabled);
     mDiffBranchesAction->setEnabled(enabled);
     mRepoSearchAction->setEnabled(enabled);
+    mRepoPickaxeAction->setEnabled(enabled);
     mRepoSettingsAction->setEnabled(enabled);
     mRepoSwitchAction->setEnabled(enabled);
     mRepoDiffTreeAction->setEnabled(enabled);
@@ -201,6 +204,10 @@ void AppWindow::initActions()
     mRepoCleanupAction = actionCollection->addAction(QStringLiteral("repo_cleanup"), this, &AppWindow::cleanup);
     mRepoCleanupAction->setText(i18nc("@action", "Cleanup…"));
 
+    mRepoCommitGraphAction = actionCollection->addAction(QStringLiteral("repo_commit_graph"), this, &AppWindow::writeCommitGraph);
+    mRepoCommitGraphAction->setText(i18nc("@action", "Update commit graph…"));
+    mRepoCommitGraphAction->setToolTip(i18n("Write git's commit-graph file, which speeds up loading and comparing history"));
+
     mRepoPullAction = actionCollection->addAction(QStringLiteral("repo_pull"), this, &AppWindow::pull);
     mRepoPullAction->setText(i18nc("@action", "Pull…"));
     mRepoPullAction->setIcon(QIcon::fromTheme(QStringLiteral("git-pull")));
@@ -223,6 +230,9 @@ void AppWindow::initActions()
     mRepoSearchAction = actionCollection->addAction(QStringLiteral("repo_search"), this, &AppWindow::search);
     mRepoSearchAction->setText(i18nc("@action", "Search…"));
 
+    mRepoPickaxeAction = actionCollection->addAction(QStringLiteral("repo_pickaxe"), this, &AppWindow::pickaxe);
+    mRepoPickaxeAction->setText(i18nc("@action", "Find Commits Changing Text…"));
+
     mRepoSettingsAction = actionCollection->addAction(QStringLiteral("repo_settings"), this, &AppWindow::repoSettings);
     mRepoSettingsAction->setText(i18nc("@action", "Repo settings…"));
 
@@ -382,6 +392,12 @@ void AppWindow::search()
     d.exec();
 }
 
+void AppWindow::pickaxe()
+{
+    PickaxeDialog d(mGitData->manager(), mGitData->commitsModel(), this);
+    d.exec();
+}
+
 void AppWindow::repoSettings()
 {
     RepoSettingsDialog d(mGitData->manager(), this);
@@ -424,6 +440,13 @@ void AppWindow::cleanup()
     }
 }
 
+void AppWindow::writeCommitGraph()
+{
+    RunnerDialog runner(mGitData->manager(), this);
+    runner.run({QStringLiteral("commit-graph"), QStringLiteral("write"), QStringLiteral("--reachable"), QStringLiteral("--changed-paths")});
+    runner.exec();
+}
+
 template<class T>
 void AppWindow::addPage(const QString &actionName)
 {
@@ -48,11 +48,13 @@ private:
     void clone();
     void diffBranches();
     void search();
+    void pickaxe();
     void repoSettings();
     void repoSwitch();
     void repoDiffTree();
     void merge();
     void cleanup();
+    void writeCommitGraph();
     void initActions();
     void changeLogs();
     void initRecentRepos(const QString &newItem = QString());
@@ -74,12 +76,14 @@ private:
     QAction *mRepoCloneAction = nullptr;
     QAction *mRepoStatusAction = nullptr;
     QAction *mRepoCleanupAction = nullptr;
+    QAction *mRepoCommitGraphAction = nullptr;
     QAction *mRepoPullAction = nullptr;
     QAction *mRepoFetchAction = nullptr;
     QAction *mRepoPushAction = nullptr;
     QAction *mRepoMergeAction = nullptr;
     QAction *mDiffBranchesAction = nullptr;
     QAction *mRepoSearchAction = nullptr;
+    QAction *mRepoPickaxeAction = nullptr;
     QAction *mRepoSettingsAction = nullptr;
     QAction *mRepoSwitchAction = nullptr;
     QAction *mRepoDiffTreeAction = nullptr;
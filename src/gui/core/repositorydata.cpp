@@ -25,6 +25,12 @@ RepositoryData::RepositoryData(Git::Manager *git)
     , mStashesCache{new StashesModel{mManager, this}}
     , mTagsModel{new TagsModel{mManager, this}}
 {
+    // Models are loaded together on a thread pool instead of each one reacting to pathChanged on its own
+    const QList<AbstractGitItemsModel *> models{mRemotesModel, mSubmodulesModel, mBranchesModel, mLogsCache, mStashesCache, mTagsModel};
+    for (auto const &model : models)
+        disconnect(mManager, &Git::Manager::pathChanged, model, nullptr);
+
+    connect(mManager, &Git::Manager::pathChanged, this, &RepositoryData::loadAll);
 }
 
 RepositoryData::~RepositoryData()
@@ -33,12 +39,12 @@ RepositoryData::~RepositoryData()
 
 void RepositoryData::loadAll()
 {
-    mRemotesModel->load();
-    mSubmodulesModel->reload();
-    mBranchesModel->load();
-    mLogsCache->load();
-    mStashesCache->load();
-    mTagsModel->load();
+    mRemotesModel->loadAsync();
+    mSubmodulesModel->loadAsync();
+    mBranchesModel->loadAsync();
+    mLogsCache->loadAsync();
+    mStashesCache->loadAsync();
+    mTagsModel->loadAsync();
 }
 
 Git::Manager *RepositoryData::manager() const
@@ -5,16 +5,22 @@ SPDX-License-Identifier: GPL-3.0-or-later
 */
 
 #include "cachetest.h"
+#include "caches/blobscache.h"
 #include "caches/branchescache.h"
 #include "caches/commitscache.h"
 #include "caches/remotescache.h"
 #include "caches/tagscache.h"
 #include "testcommon.h"
 
+#include <QSignalSpy>
 #include <QTest>
+#include <entities/blob.h>
+#include <entities/commit.h>
 #include <entities/tag.h>
 #include <gitmanager.h>
 
+#include <git2/blob.h>
+
 QTEST_GUILESS_MAIN(CacheTest)
 
 CacheTest::CacheTest(QObject *parent)
@@ -32,6 +38,110 @@ void CacheTest::initTestCase()
     TestCommon::initSignature(mManager);
 }
 
+void CacheTest::sharedLookup()
+{
+    auto commits = mManager->commits()->allCommits();
+    QVERIFY(!commits.isEmpty());
+
+    auto commit = commits.first();
+    QCOMPARE(mManager->commits()->find(commit->commitHash()), commit);
+    QCOMPARE(mManager->commits()->find(commit->commitShortHash()), commit);
+}
+
+void CacheTest::boundedCache()
+{
+    auto cache = mManager->commits();
+    auto commits = cache->allCommits();
+    QVERIFY(commits.size() > 10);
+
+    auto statsBefore = cache->stats();
+    cache->setMaxSize(10);
+    QCOMPARE(cache->size(), 10);
+    QCOMPARE(cache->stats().evictions - statsBefore.evictions, statsBefore.size - 10);
+
+    // the most recently used entries are kept
+    QVERIFY(cache->contains(commits.last()->oid()));
+    QVERIFY(!cache->contains(commits.first()->oid()));
+
+    cache->setMaxSize(0);
+    QCOMPARE(cache->allCommits().size(), commits.size());
+}
+
+void CacheTest::commitIndex()
+{
+    auto commits = mManager->commits()->allCommits();
+
+    // a second manager reads the history back from the index written above
+    Git::Manager manager{mManager->path()};
+    auto indexed = manager.commits()->allCommits();
+
+    QCOMPARE(indexed.size(), commits.size());
+    for (int i = 0; i < commits.size(); ++i) {
+        QCOMPARE(indexed.at(i)->oid(), commits.at(i)->oid());
+        QCOMPARE(indexed.at(i)->message(), commits.at(i)->message());
+        QCOMPARE(indexed.at(i)->parentOids(), commits.at(i)->parentOids());
+        QCOMPARE(indexed.at(i)->childOids(), commits.at(i)->childOids());
+        QCOMPARE(indexed.at(i)->commitTime(), commits.at(i)->commitTime());
+        QCOMPARE(indexed.at(i)->author()->email(), commits.at(i)->author()->email());
+    }
+}
+
+void CacheTest::blobs()
+{
+    auto cache = mManager->blobs();
+
+    auto blob = cache->find(QStringLiteral("HEAD"), QStringLiteral("CMakeLists.txt"));
+    QVERIFY(blob);
+    QCOMPARE(blob->text(), mManager->runGit({QStringLiteral("show"), QStringLiteral("HEAD:CMakeLists.txt")}));
+    QCOMPARE(mManager->fileContent(QStringLiteral("HEAD"), QStringLiteral("CMakeLists.txt")), blob->text());
+
+    const auto hits = cache->stats().hits;
+    QCOMPARE(cache->find(QStringLiteral("HEAD"), QStringLiteral("/CMakeLists.txt")), blob);
+    QCOMPARE(cache->stats().hits, hits + 1);
+
+    // contents are not cut at the first NUL
+    const QByteArray binary{"a\0b", 3};
+    git_oid oid;
+    QCOMPARE(git_blob_create_from_buffer(&oid, mManager->repoPtr(), binary.constData(), binary.size()), 0);
+    auto binaryBlob = cache->findByOid(&oid);
+    QVERIFY(binaryBlob);
+    QCOMPARE(binaryBlob->size(), qint64{3});
+    QCOMPARE(binaryBlob->data(), binary);
+    QVERIFY(binaryBlob->isBinary());
+
+    QVERIFY(!cache->find(QStringLiteral("HEAD"), QStringLiteral("src")));
+}
+
+void CacheTest::changeSets()
+{
+    auto cache = mManager->branches();
+    qRegisterMetaType<Git::BranchesCache::ChangeSet>();
+    QSignalSpy spy{cache, &Git::BranchesCache::changed};
+
+    // changes made in one go arrive in one change set
+    QVERIFY(cache->create(QStringLiteral("changeset-1")));
+    QVERIFY(cache->create(QStringLiteral("changeset-2")));
+    QCOMPARE(spy.count(), 0);
+    QTRY_COMPARE(spy.count(), 1);
+
+    auto changes = spy.takeFirst().at(0).value<Git::BranchesCache::ChangeSet>();
+    QCOMPARE(changes.inserted.size(), 2);
+    QCOMPARE(changes.inserted.at(0), cache->findByName(QStringLiteral("changeset-1")));
+    QCOMPARE(changes.inserted.at(1), cache->findByName(QStringLiteral("changeset-2")));
+    QVERIFY(changes.removed.isEmpty());
+
+    // a branch that comes and goes in the same turn is not reported
+    QVERIFY(cache->create(QStringLiteral("changeset-3")));
+    QVERIFY(cache->remove(cache->findByName(QStringLiteral("changeset-3"))));
+    QTest::qWait(50);
+    QCOMPARE(spy.count(), 0);
+
+    QVERIFY(cache->remove(cache->findByName(QStringLiteral("changeset-1"))));
+    QVERIFY(cache->remove(cache->findByName(QStringLiteral("changeset-2"))));
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.takeFirst().at(0).value<Git::BranchesCache::ChangeSet>().removed.size(), 2);
+}
+
 void CacheTest::saveData()
 {
     mCommits = mManager->commits()->allCommits();
@@ -42,8 +152,15 @@ void CacheTest::saveData()
 
 void CacheTest::switchToInvalidPath()
 {
+    const auto pool = mManager->stringPool();
+    const auto subject = mCommits.first()->subject();
+
     auto ok = mManager->open("/invalid/path");
     QVERIFY(!ok);
+
+    // the strings of the old repository go with its commits, the ones kept here still have them
+    QVERIFY(mManager->stringPool() != pool);
+    QCOMPARE(mCommits.first()->subject(), subject);
 }
 
 void CacheTest::checkBranch_data()
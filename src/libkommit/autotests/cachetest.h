@@ -27,6 +27,11 @@ public:
 private Q_SLOTS:
     void initTestCase();
 
+    void sharedLookup();
+    void boundedCache();
+    void commitIndex();
+    void blobs();
+    void changeSets();
     void saveData();
     void switchToInvalidPath();
     void checkBranch_data();
@@ -0,0 +1,142 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "commitgraphtest.h"
+#include "caches/commitgraph.h"
+#include "caches/commitscache.h"
+#include "testcommon.h"
+
+#include <QHash>
+#include <QTest>
+#include <entities/commit.h>
+#include <gitmanager.h>
+
+#include <git2/graph.h>
+
+QTEST_GUILESS_MAIN(CommitGraphTest)
+
+CommitGraphTest::CommitGraphTest(QObject *parent)
+    : QObject{parent}
+{
+}
+
+void CommitGraphTest::initTestCase()
+{
+    auto path = TestCommon::getTempPath();
+    mManager = new Git::Manager;
+
+    auto ok = mManager->clone("https://invent.kde.org/sdk/kommit.git", path);
+    QVERIFY(ok);
+    TestCommon::initSignature(mManager);
+}
+
+void CommitGraphTest::missingGraph()
+{
+    auto graph = mManager->commitGraph();
+    QVERIFY(!graph->isValid());
+    QCOMPARE(graph->size(), 0u);
+}
+
+void CommitGraphTest::writeGraph()
+{
+    mManager->runGit({QStringLiteral("commit-graph"), QStringLiteral("write"), QStringLiteral("--reachable")});
+
+    auto graph = mManager->commitGraph();
+    QVERIFY(graph->isValid());
+    QVERIFY(graph->size() > 0);
+}
+
+void CommitGraphTest::commitData()
+{
+    auto graph = mManager->commitGraph();
+    const auto commits = mManager->commits()->allCommits();
+    QVERIFY(!commits.isEmpty());
+
+    QVarLengthArray<quint32, 2> parents;
+    for (const auto &commit : commits) {
+        quint32 position;
+        QVERIFY(graph->find(commit->oid(), &position));
+        QCOMPARE(graph->oid(position), commit->oid());
+        QCOMPARE(graph->commitTime(position), commit->commitTime().toSecsSinceEpoch());
+
+        graph->parents(position, parents);
+        QList<Git::Oid> parentOids;
+        for (auto parent : parents)
+            parentOids << graph->oid(parent);
+        QCOMPARE(parentOids, commit->parentOids());
+    }
+}
+
+void CommitGraphTest::topologicalOrder()
+{
+    const auto commits = mManager->commits()->allCommits();
+
+    QHash<Git::Oid, int> rows;
+    for (int i = 0; i < commits.size(); ++i)
+        rows.insert(commits.at(i)->oid(), i);
+
+    // children always come before their parents
+    for (int i = 0; i < commits.size(); ++i)
+        for (const auto &parent : commits.at(i)->parentOids())
+            QVERIFY(rows.value(parent, -1) > i);
+}
+
+void CommitGraphTest::reachability()
+{
+    auto graph = mManager->commitGraph();
+    const auto commits = mManager->commits()->allCommits();
+    QVERIFY(commits.size() > 100);
+
+    const auto first = commits.first()->oid();
+    const auto second = commits.at(commits.size() / 2)->oid();
+
+    quint32 firstPosition;
+    quint32 secondPosition;
+    QVERIFY(graph->find(first, &firstPosition));
+    QVERIFY(graph->find(second, &secondPosition));
+
+    QCOMPARE(graph->isAncestor(secondPosition, firstPosition),
+             git_graph_descendant_of(mManager->repoPtr(), first.oidPtr(), second.oidPtr()) == 1);
+    QVERIFY(!graph->isAncestor(firstPosition, secondPosition));
+
+    size_t ahead;
+    size_t behind;
+    QCOMPARE(git_graph_ahead_behind(&ahead, &behind, mManager->repoPtr(), first.oidPtr(), second.oidPtr()), 0);
+    QCOMPARE(graph->aheadBehind(firstPosition, secondPosition), qMakePair(static_cast<int>(ahead), static_cast<int>(behind)));
+}
+
+void CommitGraphTest::changedPaths()
+{
+    auto graph = mManager->commitGraph();
+    QVERIFY(!graph->hasChangedPaths());
+    QVERIFY(graph->pathKeys("README.md").isEmpty());
+
+    mManager->runGit({QStringLiteral("commit-graph"), QStringLiteral("write"), QStringLiteral("--reachable"), QStringLiteral("--changed-paths")});
+    graph = mManager->commitGraph();
+    QVERIFY(graph->hasChangedPaths());
+
+    const auto file = QStringLiteral("src/libkommit/gitmanager.cpp");
+    const auto keys = graph->pathKeys(file.toUtf8());
+    QVERIFY(!keys.isEmpty());
+
+    // a filter may report false positives, but never misses a commit that changed the file
+    const auto changes = mManager->runGit({QStringLiteral("log"), QStringLiteral("--first-parent"), QStringLiteral("--format=%H"), QStringLiteral("--"), file})
+                             .split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+    QVERIFY(!changes.isEmpty());
+    for (const auto &hash : changes) {
+        quint32 position;
+        QVERIFY(graph->find(Git::Oid::fromString(hash), &position));
+        QVERIFY(graph->pathChanged(position, keys) != Git::CommitGraph::PathChange::Unchanged);
+    }
+
+    const auto expected = mManager->runGit({QStringLiteral("log"), QStringLiteral("--format=%H"), QStringLiteral("--"), file}).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+    QCOMPARE(mManager->fileLog(file), expected);
+}
+
+void CommitGraphTest::cleanupTestCase()
+{
+    TestCommon::cleanPath(mManager);
+}
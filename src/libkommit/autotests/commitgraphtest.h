@@ -0,0 +1,35 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+namespace Git
+{
+class Manager;
+};
+
+class CommitGraphTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CommitGraphTest(QObject *parent = nullptr);
+    ~CommitGraphTest() override = default;
+
+private Q_SLOTS:
+    void initTestCase();
+    void missingGraph();
+    void writeGraph();
+    void commitData();
+    void topologicalOrder();
+    void reachability();
+    void changedPaths();
+    void cleanupTestCase();
+
+private:
+    Git::Manager *mManager;
+};
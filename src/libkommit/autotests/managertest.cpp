@@ -0,0 +1,786 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "managertest.h"
+#include "blamedata.h"
+#include "caches/blamecache.h"
+#include "caches/commitscache.h"
+#include "entities/commit.h"
+#include "entities/index.h"
+#include "entities/tree.h"
+#include "entities/oid.h"
+#include "filestatus.h"
+#include "gitmanager.h"
+#include "grep.h"
+#include "historyblobs.h"
+#include "linehistory.h"
+#include "managerpool.h"
+#include "observers/pushobserver.h"
+#include "pickaxe.h"
+#include "testcommon.h"
+#include "types.h"
+#include "workingtreestatus.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFuture>
+#include <QMutex>
+#include <QProcess>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(ManagerTest)
+
+namespace
+{
+
+// The results the git command line produced before these functions were reimplemented on libgit2
+QStringList gitLines(Git::Manager *manager, const QStringList &args)
+{
+    QStringList lines;
+    const auto out = manager->runGit(args).split(QLatin1Char('\n'));
+    for (const auto &line : out)
+        if (!line.trimmed().isEmpty())
+            lines << line;
+    return lines;
+}
+
+QMap<QString, QString> nameStatus(Git::Manager *manager, const QStringList &args)
+{
+    QMap<QString, QString> statuses;
+    for (const auto &line : gitLines(manager, args)) {
+        const auto parts = line.split(QLatin1Char('\t'));
+        if (parts.size() == 2)
+            statuses.insert(parts.at(1), parts.at(0));
+    }
+    return statuses;
+}
+
+QString statusLetter(Git::ChangeStatus status)
+{
+    switch (status) {
+    case Git::ChangeStatus::Added:
+        return QStringLiteral("A");
+    case Git::ChangeStatus::Modified:
+        return QStringLiteral("M");
+    case Git::ChangeStatus::Removed:
+        return QStringLiteral("D");
+    default:
+        return {};
+    }
+}
+
+QString statusLetter(Git::FileStatus::Status status)
+{
+    switch (status) {
+    case Git::FileStatus::Added:
+        return QStringLiteral("A");
+    case Git::FileStatus::Modified:
+        return QStringLiteral("M");
+    case Git::FileStatus::Removed:
+        return QStringLiteral("D");
+    default:
+        return {};
+    }
+}
+
+}
+
+ManagerTest::ManagerTest(QObject *parent)
+    : QObject{parent}
+{
+}
+
+ManagerTest::~ManagerTest()
+{
+    delete mManager;
+}
+
+void ManagerTest::initTestCase()
+{
+    auto path = TestCommon::getTempPath();
+    mManager = new Git::Manager;
+    QVERIFY(mManager->init(path));
+    TestCommon::initSignature(mManager);
+
+    TestCommon::touch(mManager, QStringLiteral("a.txt"));
+    TestCommon::touch(mManager, QStringLiteral("dir/b.txt"));
+    TestCommon::touch(mManager, QStringLiteral("dir/sub/c.txt"));
+    mManager->commit(QStringLiteral("initial"));
+}
+
+void ManagerTest::commit()
+{
+    TestCommon::touch(mManager, QStringLiteral("a.txt"));
+    TestCommon::touch(mManager, QStringLiteral("d.txt"));
+    mManager->runGit({QStringLiteral("rm"), QStringLiteral("-q"), QStringLiteral("dir/b.txt")});
+    mManager->commit(QStringLiteral("second\n\n  "));
+
+    QCOMPARE(gitLines(mManager, {QStringLiteral("log"), QStringLiteral("--format=%s")}), QStringList({QStringLiteral("second"), QStringLiteral("initial")}));
+    QCOMPARE(gitLines(mManager, {QStringLiteral("log"), QStringLiteral("-1"), QStringLiteral("--format=%an <%ae>")}),
+             QStringList{QStringLiteral("kommit test user <kommit@kde.org>")});
+    QVERIFY(gitLines(mManager, {QStringLiteral("status"), QStringLiteral("--porcelain"), QStringLiteral("--untracked-files=no")}).isEmpty());
+}
+
+void ManagerTest::changedFiles()
+{
+    for (const auto &rev : {QStringLiteral("HEAD"), QStringLiteral("HEAD~1")}) {
+        const auto expected = nameStatus(mManager, {QStringLiteral("show"), QStringLiteral("--no-renames"), QStringLiteral("--name-status"), QStringLiteral("--format="), rev});
+        const auto files = mManager->changedFiles(rev);
+
+        QCOMPARE(files.size(), expected.size());
+        for (auto i = files.constBegin(); i != files.constEnd(); ++i)
+            QCOMPARE(statusLetter(i.value()), expected.value(i.key()));
+    }
+}
+
+void ManagerTest::ls()
+{
+    for (const auto &rev : {QStringLiteral("HEAD"), QStringLiteral("HEAD~1")}) {
+        auto expected = gitLines(mManager, {QStringLiteral("ls-tree"), QStringLiteral("--name-only"), QStringLiteral("-r"), rev});
+        auto files = mManager->ls(rev);
+        expected.sort();
+        files.sort();
+        QCOMPARE(files, expected);
+    }
+}
+
+void ManagerTest::diffBranch()
+{
+    TestCommon::touch(mManager->path() + QStringLiteral("/dir/sub/c.txt"));
+
+    const auto expected = nameStatus(mManager, {QStringLiteral("diff"), QStringLiteral("--no-renames"), QStringLiteral("HEAD~1"), QStringLiteral("--name-status")});
+    const auto files = mManager->diffBranch(QStringLiteral("HEAD~1"));
+
+    QCOMPARE(files.size(), expected.size());
+    for (const auto &file : files)
+        QCOMPARE(statusLetter(file.status()), expected.value(file.name()));
+
+    QVERIFY(mManager->revertFile(QStringLiteral("dir/sub/c.txt")));
+}
+
+void ManagerTest::diff()
+{
+    // header lines differ in abbreviation length, the hunks must be identical
+    const auto changeLines = [](const QString &patch) {
+        QStringList lines;
+        for (const auto &line : patch.split(QLatin1Char('\n')))
+            if (line.startsWith(QLatin1Char('+')) || line.startsWith(QLatin1Char('-')) || line.startsWith(QLatin1Char('@')))
+                lines << line;
+        return lines;
+    };
+
+    const auto expected = mManager->runGit({QStringLiteral("diff"), QStringLiteral("--no-renames"), QStringLiteral("HEAD~1"), QStringLiteral("HEAD")});
+    const auto patch = mManager->diff(QStringLiteral("HEAD~1"), QStringLiteral("HEAD"));
+
+    QVERIFY(!patch.isEmpty());
+    QCOMPARE(changeLines(patch), changeLines(expected));
+}
+
+void ManagerTest::saveFile()
+{
+    const auto target = TestCommon::getTempPath() + QStringLiteral("/saved.txt");
+    mManager->saveFile(QStringLiteral("HEAD~1"), QStringLiteral("a.txt"), target);
+
+    QFile f{target};
+    QVERIFY(f.open(QIODevice::ReadOnly));
+    QCOMPARE(QString::fromUtf8(f.readAll()), mManager->runGit({QStringLiteral("show"), QStringLiteral("HEAD~1:a.txt")}));
+}
+
+void ManagerTest::ignoredFiles()
+{
+    QFile ignore{mManager->path() + QStringLiteral("/.gitignore")};
+    QVERIFY(ignore.open(QIODevice::WriteOnly));
+    ignore.write("*.log\nbuild/\n");
+    ignore.close();
+
+    TestCommon::touch(mManager->path() + QStringLiteral("/x.log"));
+    TestCommon::touch(mManager->path() + QStringLiteral("/build/out.o"));
+
+    auto files = mManager->ignoredFiles();
+    files.sort();
+    QCOMPARE(files, QStringList({QStringLiteral("build/"), QStringLiteral("x.log")}));
+}
+
+void ManagerTest::fileLog()
+{
+    mManager->runGit({QStringLiteral("mv"), QStringLiteral("a.txt"), QStringLiteral("moved.txt")});
+    mManager->commit(QStringLiteral("rename"));
+    TestCommon::touch(mManager, QStringLiteral("moved.txt"));
+    mManager->commit(QStringLiteral("change moved"));
+
+    for (const auto &file : {QStringLiteral("a.txt"), QStringLiteral("moved.txt"), QStringLiteral("dir/b.txt")})
+        QCOMPARE(mManager->fileLog(file), gitLines(mManager, {QStringLiteral("log"), QStringLiteral("--format=%H"), QStringLiteral("--"), file}));
+
+    QStringList hashes;
+    QStringList paths;
+    mManager->fileLog(
+        QStringLiteral("moved.txt"),
+        [&](const Git::Oid &commit, const QString &path) {
+            hashes << commit.toString();
+            paths << path;
+            return true;
+        },
+        true);
+    QCOMPARE(hashes, gitLines(mManager, {QStringLiteral("log"), QStringLiteral("--follow"), QStringLiteral("--format=%H"), QStringLiteral("--"), QStringLiteral("moved.txt")}));
+    QCOMPARE(paths.last(), QStringLiteral("a.txt"));
+}
+
+void ManagerTest::walkTree()
+{
+    TestCommon::touch(mManager, QStringLiteral("dir/sub/e.txt"));
+    TestCommon::touch(mManager, QStringLiteral("dir/f.txt"));
+    mManager->commit(QStringLiteral("nested"));
+
+    // "<mode> <type> <oid> <size>\t<path>"
+    QStringList expected;
+    for (const auto &line : gitLines(mManager, {QStringLiteral("ls-tree"), QStringLiteral("-r"), QStringLiteral("-l"), QStringLiteral("HEAD")})) {
+        const auto parts = line.split(QLatin1Char('\t'));
+        const auto fields = parts.first().simplified().split(QLatin1Char(' '));
+        expected << QStringLiteral("%1 %2 %3").arg(parts.last(), fields.at(2), fields.at(3));
+    }
+
+    QStringList files;
+    QVERIFY(mManager->walkTree(QStringLiteral("HEAD"), [&files](const Git::TreeWalker::Entry &entry) {
+        if (!entry.isDir())
+            files << QStringLiteral("%1 %2 %3").arg(entry.path(), entry.oid().toString(), QString::number(entry.size()));
+        return Git::TreeWalker::Action::Continue;
+    }));
+    QCOMPARE(files, expected);
+
+    QStringList visited;
+    QVERIFY(mManager->walkTree(
+        QStringLiteral("HEAD"),
+        [&visited](const Git::TreeWalker::Entry &entry) {
+            visited << entry.path();
+            return entry.isDir() ? Git::TreeWalker::Action::SkipChildren : Git::TreeWalker::Action::Continue;
+        },
+        QStringLiteral("dir")));
+    QCOMPARE(visited, QStringList({QStringLiteral("dir/f.txt"), QStringLiteral("dir/sub")}));
+
+    int count{0};
+    QVERIFY(!mManager->walkTree(QStringLiteral("HEAD"), [&count](const Git::TreeWalker::Entry &) {
+        ++count;
+        return Git::TreeWalker::Action::Stop;
+    }));
+    QCOMPARE(count, 1);
+}
+
+void ManagerTest::runAsync()
+{
+    const auto expected = mManager->ls(QStringLiteral("HEAD"));
+
+    QMutex mutex;
+    QSet<Git::Manager *> handles;
+    QList<QStringList> results;
+    QList<QFuture<void>> jobs;
+    for (int i = 0; i < 8; ++i) {
+        jobs << mManager->runAsync([&](Git::Manager *manager) {
+            const auto files = manager->ls(QStringLiteral("HEAD"));
+
+            QMutexLocker locker(&mutex);
+            results << files;
+            handles.insert(manager);
+        });
+    }
+    for (auto &job : jobs)
+        job.waitForFinished();
+
+    QCOMPARE(results.size(), 8);
+    for (const auto &files : std::as_const(results))
+        QCOMPARE(files, expected);
+    QVERIFY(!handles.isEmpty());
+    QVERIFY(!handles.contains(mManager));
+
+    // finished jobs give their handles back to the pool
+    auto manager = mManager->workerPool()->acquire();
+    QVERIFY(handles.contains(manager.data()));
+    QCOMPARE(manager->path(), mManager->path());
+}
+
+void ManagerTest::workingTreeStatus()
+{
+    auto status = mManager->workingTreeStatus();
+    QCOMPARE(status->files(), mManager->changedFiles());
+
+    QList<Git::WorkingTreeStatus::Delta> deltas;
+    auto connection = connect(status, &Git::WorkingTreeStatus::changed, this, [&deltas](const Git::WorkingTreeStatus::Delta &delta) {
+        deltas << delta;
+    });
+
+    // created and removed files are reported by the directory watches
+    const auto untracked = QStringLiteral("dir/sub/untracked.txt");
+    TestCommon::touch(mManager->path() + QLatin1Char('/') + untracked);
+    QTRY_VERIFY(status->files().contains(untracked));
+    QCOMPARE(status->files(), mManager->changedFiles());
+    QCOMPARE(deltas.last().added.value(untracked), Git::ChangeStatus::Added);
+
+    QVERIFY(QFile::remove(mManager->path() + QLatin1Char('/') + untracked));
+    QTRY_VERIFY(!status->files().contains(untracked));
+    QCOMPARE(status->files(), mManager->changedFiles());
+    QVERIFY(deltas.last().removed.contains(untracked));
+
+    // staging replaces the index
+    TestCommon::touch(mManager, QStringLiteral("staged.txt"));
+    QTRY_COMPARE(status->files(), mManager->changedFiles());
+    QVERIFY(status->files().contains(QStringLiteral("staged.txt")));
+
+    // a file written in place needs a refresh
+    QFile file{mManager->path() + QStringLiteral("/moved.txt")};
+    QVERIFY(file.open(QIODevice::Append));
+    file.write("more");
+    file.close();
+    status->refresh();
+    QCOMPARE(status->files(), mManager->changedFiles());
+    QCOMPARE(status->files().value(QStringLiteral("moved.txt")), Git::ChangeStatus::Modified);
+
+    disconnect(connection);
+}
+
+void ManagerTest::blame()
+{
+    const auto write = [this](const QStringList &lines) {
+        QFile f{mManager->path() + QStringLiteral("/blame.txt")};
+        QVERIFY(f.open(QIODevice::WriteOnly | QIODevice::Text));
+        f.write(lines.join(QLatin1Char('\n')).toUtf8() + '\n');
+        f.close();
+        mManager->addFile(QStringLiteral("blame.txt"));
+    };
+
+    QStringList lines{QStringLiteral("one"), QStringLiteral("two"), QStringLiteral("three"), QStringLiteral("four"), QStringLiteral("five")};
+    write(lines);
+    mManager->commit(QStringLiteral("blame 1"));
+    lines[1] = QStringLiteral("TWO");
+    lines << QStringLiteral("six");
+    write(lines);
+    mManager->commit(QStringLiteral("blame 2"));
+    lines.removeAt(3);
+    lines.insert(0, QStringLiteral("zero"));
+    write(lines);
+    mManager->commit(QStringLiteral("blame 3"));
+
+    // commit of every line, as "<hash> <line>) <content>" of git blame has it
+    const auto expected = [this]() {
+        QStringList commits;
+        for (const auto &line :
+             gitLines(mManager, {QStringLiteral("blame"), QStringLiteral("--root"), QStringLiteral("-l"), QStringLiteral("-s"), QStringLiteral("blame.txt")}))
+            commits << line.section(QLatin1Char(' '), 0, 0);
+        return commits;
+    };
+    QList<Git::BlameHunk> hunks;
+    Git::BlameOptions options;
+    const auto blamed = [&]() {
+        hunks.clear();
+        QStringList commits;
+        if (!mManager->blame(
+                QStringLiteral("blame.txt"),
+                [&hunks](const Git::BlameHunk &hunk) {
+                    hunks << hunk;
+                    return true;
+                },
+                options))
+            return commits;
+
+        while (commits.size() < lines.size())
+            commits << QString{};
+        for (const auto &hunk : std::as_const(hunks))
+            for (int i = 0; i < hunk.lineCount; ++i)
+                commits[hunk.finalStartLineNumber - 1 + i] = hunk.commitId.toString();
+        return commits;
+    };
+
+    QCOMPARE(blamed(), expected());
+
+    // newest first
+    auto head = mManager->runGit({QStringLiteral("rev-parse"), QStringLiteral("HEAD")}).trimmed();
+    QCOMPARE(hunks.first().commitId.toString(), head);
+    for (const auto &hunk : std::as_const(hunks))
+        QVERIFY(!hunk.boundary);
+
+    // the next revision starts from the cached blame of its parent
+    const auto hits = Git::BlameCache::instance()->stats().hits;
+    lines[2] = QStringLiteral("THREE");
+    write(lines);
+    mManager->commit(QStringLiteral("blame 4"));
+    QCOMPARE(blamed(), expected());
+    QCOMPARE(Git::BlameCache::instance()->stats().hits, hits + 1);
+
+    // blames that do not follow renames have their own entries
+    options.followRenames = false;
+    QCOMPARE(blamed(), expected());
+    QCOMPARE(Git::BlameCache::instance()->stats().hits, hits + 1);
+    QCOMPARE(blamed(), expected());
+    QCOMPARE(Git::BlameCache::instance()->stats().hits, hits + 2);
+    options.followRenames = true;
+
+    // nothing older than HEAD is looked into
+    head = mManager->runGit({QStringLiteral("rev-parse"), QStringLiteral("HEAD")}).trimmed();
+    options.oldestCommit = Git::Oid::fromString(head);
+    hunks.clear();
+    QVERIFY(mManager->blame(
+        QStringLiteral("blame.txt"),
+        [&hunks](const Git::BlameHunk &hunk) {
+            hunks << hunk;
+            return true;
+        },
+        options));
+    QCOMPARE(hunks.size(), 1);
+    QVERIFY(hunks.first().boundary);
+    QCOMPARE(hunks.first().lineCount, lines.size());
+
+    // canceled after the first hunk
+    int count{0};
+    QVERIFY(!mManager->blame(
+        QStringLiteral("blame.txt"),
+        [&count](const Git::BlameHunk &) {
+            ++count;
+            return false;
+        },
+        {}));
+    QCOMPARE(count, 1);
+}
+
+void ManagerTest::lineHistory()
+{
+    // lines 2-3 of blame.txt are "one" and "TWO"; an insertion above them and changes below do not count
+    QStringList expected;
+    for (const auto &line : gitLines(mManager, {QStringLiteral("log"), QStringLiteral("-L2,3:blame.txt"), QStringLiteral("--format=commit:%H")}))
+        if (line.startsWith(QStringLiteral("commit:")))
+            expected << line.mid(7);
+
+    QStringList commits;
+    QList<Git::LineHistoryEntry> entries;
+    QVERIFY(mManager->lineHistory(QStringLiteral("blame.txt"), {Git::LineRange{2, 2}}, [&](const Git::LineHistoryEntry &entry) {
+        commits << entry.commitId.toString();
+        entries << entry;
+        return true;
+    }));
+    QCOMPARE(commits, expected);
+    QCOMPARE(commits.size(), 2);
+
+    // the lines moved up by one in the versions before "zero" was inserted
+    QCOMPARE(entries.first().ranges.size(), 1);
+    QCOMPARE(entries.first().ranges.first().start, 1);
+    QCOMPARE(entries.first().ranges.first().count, 2);
+
+    // line numbers of an older version of the file
+    expected.clear();
+    for (const auto &line : gitLines(mManager, {QStringLiteral("log"), QStringLiteral("-L1,2:blame.txt"), QStringLiteral("--format=commit:%H"), QStringLiteral("HEAD~1")}))
+        if (line.startsWith(QStringLiteral("commit:")))
+            expected << line.mid(7);
+    commits.clear();
+    QVERIFY(mManager->lineHistory(
+        QStringLiteral("blame.txt"),
+        {Git::LineRange{1, 2}},
+        [&commits](const Git::LineHistoryEntry &entry) {
+            commits << entry.commitId.toString();
+            return true;
+        },
+        QStringLiteral("HEAD~1")));
+    QCOMPARE(commits, expected);
+}
+
+void ManagerTest::historyBlobs()
+{
+    // the last commits only touch blame.txt, every other file is the same blob at the same path in all of them
+    const QStringList places{QStringLiteral("HEAD"), QStringLiteral("HEAD~1"), QStringLiteral("HEAD~2")};
+
+    Git::HistoryBlobs history;
+    for (const auto &place : places)
+        QVERIFY(history.addPlace(mManager, place));
+    QCOMPARE(history.places(), places);
+
+    QSet<QPair<QString, QString>> distinct;
+    for (const auto &file : history.files())
+        distinct.insert(qMakePair(file.path, file.blob.toString()));
+    QCOMPARE(distinct.size(), history.files().size());
+
+    int listed{0};
+    for (int i = 0; i < places.size(); ++i) {
+        QSet<QPair<QString, QString>> expected;
+        for (const auto &line : gitLines(mManager, {QStringLiteral("ls-tree"), QStringLiteral("-r"), places.at(i)})) {
+            const auto parts = line.split(QLatin1Char('\t'));
+            expected.insert(qMakePair(parts.at(1), parts.at(0).split(QLatin1Char(' ')).at(2)));
+        }
+
+        QSet<QPair<QString, QString>> actual;
+        for (int file = 0; file < history.files().size(); ++file)
+            if (history.placesOf(file).contains(i))
+                actual.insert(qMakePair(history.files().at(file).path, history.files().at(file).blob.toString()));
+        QCOMPARE(actual, expected);
+        listed += expected.size();
+    }
+    QVERIFY(history.files().size() < listed);
+
+    int blobFiles{0};
+    const auto blobs = history.blobs();
+    for (const auto &files : blobs)
+        blobFiles += files.size();
+    QCOMPARE(blobFiles, history.files().size());
+}
+
+void ManagerTest::pickaxe()
+{
+    QList<Git::Oid> commits;
+    for (const auto &line : gitLines(mManager, {QStringLiteral("rev-list"), QStringLiteral("HEAD")}))
+        commits << Git::Oid::fromString(line);
+
+    const auto found = [&](const Git::PickaxeOptions &options) {
+        QStringList hashes;
+        mManager->pickaxe(commits, options, [&hashes](const Git::PickaxeMatch &match) {
+            hashes << match.commitId.toString();
+            return true;
+        });
+        return hashes;
+    };
+
+    Git::PickaxeOptions options;
+    options.text = QStringLiteral("TWO");
+    const auto occurrences = found(options);
+    QVERIFY(!occurrences.isEmpty());
+    QCOMPARE(occurrences, gitLines(mManager, {QStringLiteral("log"), QStringLiteral("-STWO"), QStringLiteral("--format=%H")}));
+
+    options.text = QStringLiteral("two");
+    options.caseSensitivity = Qt::CaseInsensitive;
+    QCOMPARE(found(options), gitLines(mManager, {QStringLiteral("log"), QStringLiteral("-Stwo"), QStringLiteral("-i"), QStringLiteral("--format=%H")}));
+
+    options.text = QStringLiteral("^z");
+    options.mode = Git::PickaxeOptions::Mode::ChangedLines;
+    options.caseSensitivity = Qt::CaseSensitive;
+    const auto changedLines = found(options);
+    QVERIFY(!changedLines.isEmpty());
+    QCOMPARE(changedLines, gitLines(mManager, {QStringLiteral("log"), QStringLiteral("-G^z"), QStringLiteral("--format=%H")}));
+
+    options.path = QStringLiteral("a.txt");
+    QVERIFY(found(options).isEmpty());
+}
+
+void ManagerTest::grep()
+{
+    const auto write = [this](const QString &fileName, const QByteArray &content) {
+        QFile f{mManager->path() + QLatin1Char('/') + fileName};
+        QVERIFY(f.open(QIODevice::WriteOnly));
+        f.write(content);
+        f.close();
+    };
+
+    // .gitignore leaves out *.log since ignoredFiles()
+    QDir{mManager->path()}.mkpath(QStringLiteral("grep"));
+    write(QStringLiteral("grep/tracked.txt"), "alpha\nBeta gamma\n\nbeta\nbetabeta");
+    write(QStringLiteral("grep/binary.dat"), QByteArray("beta\0beta", 9));
+    write(QStringLiteral("grep/new.txt"), "beta\n");
+    write(QStringLiteral("grep/skip.log"), "beta\n");
+    mManager->addFile(QStringLiteral("grep/tracked.txt"));
+    mManager->addFile(QStringLiteral("grep/binary.dat"));
+
+    auto tracked = mManager->workingTreeFiles({QStringLiteral("grep")});
+    tracked.sort();
+    QCOMPARE(tracked, QStringList({QStringLiteral("grep/binary.dat"), QStringLiteral("grep/tracked.txt")}));
+
+    auto all = mManager->workingTreeFiles({QStringLiteral("grep")}, true);
+    all.sort();
+    QCOMPARE(all, QStringList({QStringLiteral("grep/binary.dat"), QStringLiteral("grep/new.txt"), QStringLiteral("grep/tracked.txt")}));
+    QVERIFY(mManager->workingTreeFiles({QStringLiteral("gre")}).isEmpty());
+    QVERIFY(mManager->workingTreeFiles({}).contains(QStringLiteral("grep/tracked.txt")));
+
+    const auto found = [this](const QStringList &files, const Git::GrepOptions &options) {
+        QStringList lines;
+        mManager->grep(files, options, [&lines](const Git::GrepMatch &match) {
+            lines << QStringLiteral("%1:%2:%3").arg(match.path).arg(match.line).arg(match.text);
+            return true;
+        });
+        return lines;
+    };
+    const auto gitGrep = [this](const QStringList &args) {
+        return gitLines(mManager, QStringList{QStringLiteral("grep"), QStringLiteral("-n"), QStringLiteral("-I")} + args + QStringList{QStringLiteral("--"), QStringLiteral("grep")});
+    };
+
+    Git::GrepOptions options;
+    options.text = QStringLiteral("beta");
+    QCOMPARE(found(tracked, options), gitGrep({QStringLiteral("beta")}));
+    QCOMPARE(found(all, options), gitGrep({QStringLiteral("--untracked"), QStringLiteral("beta")}));
+
+    options.caseSensitivity = Qt::CaseInsensitive;
+    QCOMPARE(found(tracked, options), gitGrep({QStringLiteral("-i"), QStringLiteral("BETA")}));
+
+    options.text = QStringLiteral("ta$|^al");
+    options.regularExpression = true;
+    options.caseSensitivity = Qt::CaseSensitive;
+    QCOMPARE(found(tracked, options), gitGrep({QStringLiteral("-E"), QStringLiteral("ta$|^al")}));
+
+    options.text = QStringLiteral("(");
+    QVERIFY(!mManager->grep(tracked, options, [](const Git::GrepMatch &) {
+        return true;
+    }));
+}
+
+void ManagerTest::tree()
+{
+    // names in a directory, as ls-tree lists them
+    const auto names = [this](const QString &directory) {
+        QStringList entries;
+        for (const auto &path : gitLines(mManager, {QStringLiteral("ls-tree"), QStringLiteral("--name-only"), QStringLiteral("HEAD"), directory + QLatin1Char('/')}))
+            entries << path.mid(directory.size() + 1);
+        return entries;
+    };
+
+    const auto tree = mManager->tree(QStringLiteral("HEAD"));
+    QVERIFY(tree);
+    QCOMPARE(tree->entries(QString{}, Git::Tree::EntryType::All), gitLines(mManager, {QStringLiteral("ls-tree"), QStringLiteral("--name-only"), QStringLiteral("HEAD")}));
+    QCOMPARE(tree->entries(QStringLiteral("dir/sub"), Git::Tree::EntryType::File), names(QStringLiteral("dir/sub")));
+    QCOMPARE(tree->entries(QStringLiteral("/dir/"), Git::Tree::EntryType::Dir), QStringList{QStringLiteral("sub")});
+    QVERIFY(tree->entries(QStringLiteral("missing")).isEmpty());
+    QVERIFY(!tree->subtree(QStringLiteral("a.txt")));
+
+    auto files = tree->entries(Git::Tree::EntryType::File);
+    auto expected = gitLines(mManager, {QStringLiteral("ls-tree"), QStringLiteral("-r"), QStringLiteral("--name-only"), QStringLiteral("HEAD")});
+    files.sort();
+    expected.sort();
+    QCOMPARE(files, expected);
+
+    // a directory is listed once for every tree that has it
+    const auto head = mManager->commits()->find(gitLines(mManager, {QStringLiteral("rev-parse"), QStringLiteral("HEAD")}).first());
+    QVERIFY(head);
+    const auto subtree = tree->subtree(QStringLiteral("dir/sub"));
+    QVERIFY(subtree);
+    QCOMPARE(head->tree()->subtree(QStringLiteral("dir/sub")), subtree);
+    QCOMPARE(subtree->entries(QString{}, Git::Tree::EntryType::File), names(QStringLiteral("dir/sub")));
+}
+
+void ManagerTest::extract()
+{
+    QTemporaryDir destination;
+    QVERIFY(destination.isValid());
+
+    const auto tree = mManager->tree(QStringLiteral("HEAD"));
+    QVERIFY(tree);
+
+    int lastWritten{-1};
+    int lastTotal{-1};
+    Git::Tree::ExtractOptions options;
+    options.progress = [&](int written, int total) {
+        lastWritten = written;
+        lastTotal = total;
+        return true;
+    };
+    QVERIFY(tree->extract(destination.path(), QStringLiteral("dir"), options));
+
+    const auto files = gitLines(mManager, {QStringLiteral("ls-tree"), QStringLiteral("-r"), QStringLiteral("--name-only"), QStringLiteral("HEAD"), QStringLiteral("dir/")});
+    QVERIFY(!files.isEmpty());
+    QCOMPARE(lastWritten, files.size());
+    QCOMPARE(lastTotal, files.size());
+
+    for (const auto &path : files) {
+        QFile file{QDir{destination.path()}.filePath(path.mid(4))};
+        QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(path));
+        QCOMPARE(QString::fromUtf8(file.readAll()), mManager->runGit({QStringLiteral("show"), QStringLiteral("HEAD:") + path}));
+    }
+}
+
+void ManagerTest::addFiles()
+{
+    QStringList files;
+    QDir{mManager->path()}.mkpath(QStringLiteral("stage"));
+    for (int i = 0; i < 20; ++i) {
+        const auto path = QStringLiteral("stage/file%1.txt").arg(i);
+        QFile f{mManager->path() + QLatin1Char('/') + path};
+        QVERIFY(f.open(QIODevice::WriteOnly));
+        f.write(QByteArray::number(i).repeated(i + 1));
+        files << path;
+    }
+
+    // a path gone from the work tree is removed from the index
+    QVERIFY(QFile::remove(mManager->path() + QStringLiteral("/grep/binary.dat")));
+    QVERIFY(mManager->addFiles(files + QStringList{QStringLiteral("grep/binary.dat")}));
+
+    QVERIFY(gitLines(mManager, {QStringLiteral("ls-files"), QStringLiteral("--"), QStringLiteral("grep/binary.dat")}).isEmpty());
+    QVERIFY(gitLines(mManager, {QStringLiteral("diff"), QStringLiteral("--name-only"), QStringLiteral("--"), QStringLiteral("stage")}).isEmpty());
+    for (const auto &path : std::as_const(files)) {
+        const auto staged = gitLines(mManager, {QStringLiteral("ls-files"), QStringLiteral("-s"), QStringLiteral("--"), path});
+        QCOMPARE(staged.size(), 1);
+        const auto hash = gitLines(mManager, {QStringLiteral("hash-object"), path}).first();
+        QCOMPARE(staged.first(), QStringLiteral("100644 %1 0\t%2").arg(hash, path));
+    }
+
+    // nothing is written until the transaction is committed
+    const auto index = mManager->index();
+    QVERIFY(index);
+    QVERIFY(index->begin());
+    QVERIFY(index->removePaths({files.first()}));
+    QVERIFY(index->rollback());
+    QVERIFY(index->commit());
+    QCOMPARE(gitLines(mManager, {QStringLiteral("ls-files"), QStringLiteral("--"), files.first()}), QStringList{files.first()});
+}
+
+void ManagerTest::commitChecks()
+{
+    // only whitespace is cleaned up, as git commit -m does
+    QVERIFY(mManager->commit(QStringLiteral("#123 fix crash\n\n# kept")));
+    QCOMPARE(gitLines(mManager, {QStringLiteral("log"), QStringLiteral("-1"), QStringLiteral("--format=%B")}),
+             QStringList({QStringLiteral("#123 fix crash"), QStringLiteral("# kept")}));
+
+    QVERIFY(!mManager->commit(QStringLiteral("nothing")));
+    QCOMPARE(gitLines(mManager, {QStringLiteral("log"), QStringLiteral("-1"), QStringLiteral("--format=%s")}), QStringList{QStringLiteral("#123 fix crash")});
+
+    // with a hook configured git itself makes the commit
+    const auto hookPath = mManager->path() + QStringLiteral("/.git/hooks/commit-msg");
+    QDir{}.mkpath(mManager->path() + QStringLiteral("/.git/hooks"));
+    QFile hook{hookPath};
+    QVERIFY(hook.open(QIODevice::WriteOnly));
+    hook.write("#!/bin/sh\necho hooked >> \"$1\"\n");
+    hook.close();
+    hook.setPermissions(hook.permissions() | QFileDevice::ExeOwner);
+
+    TestCommon::touch(mManager, QStringLiteral("hooked.txt"));
+    QVERIFY(mManager->commit(QStringLiteral("with hook")));
+    QCOMPARE(gitLines(mManager, {QStringLiteral("log"), QStringLiteral("-1"), QStringLiteral("--format=%B")}),
+             QStringList({QStringLiteral("with hook"), QStringLiteral("hooked")}));
+    QVERIFY(QFile::remove(hookPath));
+}
+
+void ManagerTest::push()
+{
+    QTemporaryDir remoteDir;
+    QVERIFY(remoteDir.isValid());
+    mManager->runGit({QStringLiteral("init"), QStringLiteral("--bare"), remoteDir.path()});
+    mManager->runGit({QStringLiteral("remote"), QStringLiteral("add"), QStringLiteral("pushtarget"), remoteDir.path()});
+
+    // the current branch tracks a branch of another name
+    const auto branch = mManager->runGit({QStringLiteral("rev-parse"), QStringLiteral("--abbrev-ref"), QStringLiteral("HEAD")}).trimmed();
+    mManager->runGit({QStringLiteral("config"), QStringLiteral("branch.%1.remote").arg(branch), QStringLiteral("pushtarget")});
+    mManager->runGit({QStringLiteral("config"), QStringLiteral("branch.%1.merge").arg(branch), QStringLiteral("refs/heads/upstream")});
+
+    const auto remoteHead = [&remoteDir]() {
+        QProcess p;
+        p.start(QStringLiteral("git"), {QStringLiteral("--git-dir"), remoteDir.path(), QStringLiteral("rev-parse"), QStringLiteral("refs/heads/upstream")});
+        p.waitForFinished();
+        return QString::fromUtf8(p.readAllStandardOutput()).trimmed();
+    };
+    const auto head = [this]() {
+        return mManager->runGit({QStringLiteral("rev-parse"), QStringLiteral("HEAD")}).trimmed();
+    };
+
+    Git::PushObserver observer;
+    mManager->push(&observer);
+    QCOMPARE(remoteHead(), head());
+
+    // without an observer git pushes, following push.default
+    mManager->runGit({QStringLiteral("config"), QStringLiteral("push.default"), QStringLiteral("upstream")});
+    TestCommon::touch(mManager, QStringLiteral("pushed.txt"));
+    QVERIFY(mManager->commit(QStringLiteral("pushed")));
+    mManager->push();
+    QCOMPARE(remoteHead(), head());
+
+    mManager->runGit({QStringLiteral("config"), QStringLiteral("--unset"), QStringLiteral("push.default")});
+    mManager->runGit({QStringLiteral("config"), QStringLiteral("--remove-section"), QStringLiteral("branch.%1").arg(branch)});
+    mManager->runGit({QStringLiteral("remote"), QStringLiteral("remove"), QStringLiteral("pushtarget")});
+}
+
+void ManagerTest::cleanupTestCase()
+{
+    TestCommon::cleanPath(mManager);
+}
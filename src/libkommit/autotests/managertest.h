@@ -0,0 +1,50 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+namespace Git
+{
+class Manager;
+};
+
+class ManagerTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ManagerTest(QObject *parent = nullptr);
+    ~ManagerTest() override;
+
+private Q_SLOTS:
+    void initTestCase();
+    void commit();
+    void changedFiles();
+    void ls();
+    void diffBranch();
+    void diff();
+    void saveFile();
+    void ignoredFiles();
+    void fileLog();
+    void walkTree();
+    void runAsync();
+    void workingTreeStatus();
+    void blame();
+    void lineHistory();
+    void historyBlobs();
+    void pickaxe();
+    void grep();
+    void tree();
+    void extract();
+    void addFiles();
+    void commitChecks();
+    void push();
+    void cleanupTestCase();
+
+private:
+    Git::Manager *mManager;
+};
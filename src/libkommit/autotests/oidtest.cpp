@@ -0,0 +1,80 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "oidtest.h"
+
+#include <QHash>
+#include <QTest>
+#include <entities/oid.h>
+
+#include <type_traits>
+
+QTEST_GUILESS_MAIN(OidTest)
+
+static_assert(std::is_trivially_copyable<Git::Oid>::value, "Oid must stay a plain value");
+
+namespace
+{
+const auto hashA = QStringLiteral("05659b9f92b7932bb2c04ced181dbdde294cb0bb");
+const auto hashB = QStringLiteral("05659c0000000000000000000000000000000000");
+}
+
+OidTest::OidTest(QObject *parent)
+    : QObject{parent}
+{
+}
+
+void OidTest::nullOid()
+{
+    Git::Oid oid;
+    QVERIFY(oid.isNull());
+    QVERIFY(Git::Oid::fromString(QStringLiteral("not a hash")).isNull());
+    QVERIFY(Git::Oid::fromString(QString()).isNull());
+    QVERIFY(Git::Oid{static_cast<const git_oid *>(nullptr)}.isNull());
+}
+
+void OidTest::roundTrip()
+{
+    auto oid = Git::Oid::fromString(hashA);
+    QVERIFY(!oid.isNull());
+    QCOMPARE(oid.toString(), hashA);
+    QCOMPARE(oid.toShortString(), hashA.left(7));
+    QCOMPARE(oid.toShortString(12), hashA.left(12));
+    QCOMPARE(Git::Oid{oid.oidPtr()}, oid);
+    QVERIFY(oid == hashA);
+}
+
+void OidTest::prefix()
+{
+    auto oid = Git::Oid::fromString(hashA);
+    QVERIFY(oid.startsWith(QStringLiteral("05659b9")));
+    QVERIFY(oid.startsWith(QStringLiteral("05659")));
+    QVERIFY(!oid.startsWith(QStringLiteral("05659c")));
+    QVERIFY(oid.startsWith(hashA));
+    QVERIFY(oid.startsWith(QString()));
+}
+
+void OidTest::ordering()
+{
+    auto a = Git::Oid::fromString(hashA);
+    auto b = Git::Oid::fromString(hashB);
+    QVERIFY(a < b);
+    QVERIFY(!(b < a));
+    QVERIFY(a != b);
+    QVERIFY(a.compare(b) < 0);
+}
+
+void OidTest::hashing()
+{
+    QHash<Git::Oid, int> hash;
+    hash.insert(Git::Oid::fromString(hashA), 1);
+    hash.insert(Git::Oid::fromString(hashB), 2);
+    QCOMPARE(hash.value(Git::Oid::fromString(hashA)), 1);
+    QCOMPARE(hash.value(Git::Oid::fromString(hashB)), 2);
+    QCOMPARE(qHash(Git::Oid::fromString(hashA)), qHash(Git::Oid::fromString(hashA)));
+}
+
+#include "moc_oidtest.cpp"
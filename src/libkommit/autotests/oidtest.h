@@ -0,0 +1,24 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class OidTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit OidTest(QObject *parent = nullptr);
+    ~OidTest() override = default;
+
+private Q_SLOTS:
+    void nullOid();
+    void roundTrip();
+    void prefix();
+    void ordering();
+    void hashing();
+};
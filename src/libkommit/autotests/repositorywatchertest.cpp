@@ -0,0 +1,92 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "repositorywatchertest.h"
+#include "caches/branchescache.h"
+#include "caches/stashescache.h"
+#include "gitmanager.h"
+#include "repositorywatcher.h"
+#include "testcommon.h"
+
+#include <QSignalSpy>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(RepositoryWatcherTest)
+
+RepositoryWatcherTest::RepositoryWatcherTest(QObject *parent)
+    : QObject{parent}
+{
+}
+
+void RepositoryWatcherTest::initTestCase()
+{
+    auto path = TestCommon::getTempPath();
+    mManager = new Git::Manager;
+    QVERIFY(mManager->init(path));
+    TestCommon::initSignature(mManager);
+
+    TestCommon::touch(mManager, QStringLiteral("a.txt"));
+    mManager->commit(QStringLiteral("initial"));
+
+    // read the state the changes below are compared with
+    QVERIFY(mManager->watcher());
+}
+
+void RepositoryWatcherTest::refs()
+{
+    QSignalSpy spy{mManager->watcher(), &Git::RepositoryWatcher::refsChanged};
+    QVERIFY(!mManager->branches()->names().contains(QStringLiteral("feature/x")));
+
+    mManager->runGit({QStringLiteral("branch"), QStringLiteral("feature/x")});
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toStringList(), QStringList{QStringLiteral("refs/heads/feature/x")});
+    QVERIFY(mManager->branches()->names().contains(QStringLiteral("feature/x")));
+
+    // a branch in the directory created above
+    mManager->runGit({QStringLiteral("branch"), QStringLiteral("feature/y")});
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(0).toStringList(), QStringList{QStringLiteral("refs/heads/feature/y")});
+
+    mManager->runGit({QStringLiteral("branch"), QStringLiteral("-D"), QStringLiteral("feature/y")});
+    QTRY_COMPARE(spy.count(), 3);
+    QCOMPARE(spy.at(2).at(0).toStringList(), QStringList{QStringLiteral("refs/heads/feature/y")});
+}
+
+void RepositoryWatcherTest::head()
+{
+    QSignalSpy spy{mManager->watcher(), &Git::RepositoryWatcher::headMoved};
+
+    mManager->runGit({QStringLiteral("checkout"), QStringLiteral("-q"), QStringLiteral("feature/x")});
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(mManager->branches()->currentName(), QStringLiteral("feature/x"));
+}
+
+void RepositoryWatcherTest::index()
+{
+    QSignalSpy spy{mManager->watcher(), &Git::RepositoryWatcher::indexChanged};
+    QSignalSpy headSpy{mManager->watcher(), &Git::RepositoryWatcher::headMoved};
+
+    TestCommon::touch(mManager, QStringLiteral("b.txt"));
+    QTRY_VERIFY(spy.count() >= 1);
+    QCOMPARE(headSpy.count(), 0);
+}
+
+void RepositoryWatcherTest::stash()
+{
+    QSignalSpy spy{mManager->watcher(), &Git::RepositoryWatcher::stashChanged};
+    QCOMPARE(mManager->stashes()->allStashes().size(), 0);
+
+    QVERIFY(mManager->stashes()->create(QStringLiteral("stash1")));
+    QTRY_VERIFY(spy.count() >= 1);
+    QCOMPARE(mManager->stashes()->allStashes().size(), 1);
+}
+
+void RepositoryWatcherTest::cleanupTestCase()
+{
+    TestCommon::cleanPath(mManager);
+}
+
+#include "moc_repositorywatchertest.cpp"
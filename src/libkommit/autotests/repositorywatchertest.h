@@ -0,0 +1,33 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+namespace Git
+{
+class Manager;
+};
+
+class RepositoryWatcherTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RepositoryWatcherTest(QObject *parent = nullptr);
+    ~RepositoryWatcherTest() override = default;
+
+private Q_SLOTS:
+    void initTestCase();
+    void refs();
+    void head();
+    void index();
+    void stash();
+    void cleanupTestCase();
+
+private:
+    Git::Manager *mManager;
+};
@@ -0,0 +1,165 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "trigramindextest.h"
+#include "caches/trigramindex.h"
+#include "testcommon.h"
+
+#include <QFile>
+#include <QSignalSpy>
+#include <QTest>
+#include <entities/oid.h>
+#include <gitmanager.h>
+#include <repositorywatcher.h>
+
+QTEST_GUILESS_MAIN(TrigramIndexTest)
+
+namespace
+{
+
+quint32 trigram(const char *text)
+{
+    return quint32(uchar(text[0])) << 16 | quint32(uchar(text[1])) << 8 | uchar(text[2]);
+}
+
+Git::Oid blobOf(Git::Manager *manager, const QString &file)
+{
+    return Git::Oid::fromString(manager->runGit({QStringLiteral("rev-parse"), QStringLiteral("HEAD:") + file}).trimmed());
+}
+
+}
+
+TrigramIndexTest::TrigramIndexTest(QObject *parent)
+    : QObject{parent}
+{
+}
+
+void TrigramIndexTest::initTestCase()
+{
+    auto path = TestCommon::getTempPath();
+    mManager = new Git::Manager;
+    QVERIFY(mManager->init(path));
+    TestCommon::initSignature(mManager);
+
+    TestCommon::touch(mManager, QStringLiteral("a.txt"));
+    TestCommon::touch(mManager, QStringLiteral("dir/b.txt"));
+    mManager->commit(QStringLiteral("initial"));
+}
+
+void TrigramIndexTest::textQuery()
+{
+    using Query = Git::TrigramIndex::Query;
+
+    QVERIFY(Query::fromText(QStringLiteral("ab"), Qt::CaseSensitive).matchesAll());
+
+    // letters are folded, so both cases give the same trigrams
+    const auto query = Query::fromText(QStringLiteral("HeLlo"), Qt::CaseSensitive);
+    QCOMPARE(query.alternatives().size(), 1);
+    QCOMPARE(query.alternatives().first(), (QList<quint32>{trigram("ell"), trigram("hel"), trigram("llo")}));
+    QCOMPARE(Query::fromText(QStringLiteral("hello"), Qt::CaseInsensitive).alternatives(), query.alternatives());
+}
+
+void TrigramIndexTest::regularExpressionQuery()
+{
+    using Query = Git::TrigramIndex::Query;
+
+    auto query = Query::fromRegularExpression(QStringLiteral("foo.*bar"), Qt::CaseSensitive);
+    QCOMPARE(query.alternatives(), (QList<QList<quint32>>{{trigram("bar"), trigram("foo")}}));
+
+    query = Query::fromRegularExpression(QStringLiteral("foo|bar"), Qt::CaseSensitive);
+    QCOMPARE(query.alternatives(), (QList<QList<quint32>>{{trigram("foo")}, {trigram("bar")}}));
+
+    // an optional character or group is not required
+    query = Query::fromRegularExpression(QStringLiteral("colou?r"), Qt::CaseSensitive);
+    QCOMPARE(query.alternatives(), (QList<QList<quint32>>{{trigram("col"), trigram("olo")}}));
+    query = Query::fromRegularExpression(QStringLiteral("(foo)?bar\\.baz"), Qt::CaseSensitive);
+    QCOMPARE(query.alternatives(), (QList<QList<quint32>>{{trigram(".ba"), trigram("ar."), trigram("bar"), trigram("baz"), trigram("r.b")}}));
+
+    QVERIFY(Query::fromRegularExpression(QStringLiteral("a[bc]d"), Qt::CaseSensitive).matchesAll());
+    QVERIFY(Query::fromRegularExpression(QStringLiteral("foo|\\d+"), Qt::CaseSensitive).matchesAll());
+    QVERIFY(Query::fromRegularExpression(QStringLiteral("(?x) f o o"), Qt::CaseSensitive).matchesAll());
+
+    // arguments of escapes are not literals
+    query = Query::fromRegularExpression(QStringLiteral("\\x41bcd"), Qt::CaseSensitive);
+    QCOMPARE(query.alternatives(), (QList<QList<quint32>>{{trigram("bcd")}}));
+    query = Query::fromRegularExpression(QStringLiteral("\\x{41}bcd"), Qt::CaseSensitive);
+    QCOMPARE(query.alternatives(), (QList<QList<quint32>>{{trigram("bcd")}}));
+    query = Query::fromRegularExpression(QStringLiteral("foo\\c|bar"), Qt::CaseSensitive);
+    QCOMPARE(query.alternatives(), (QList<QList<quint32>>{{trigram("bar"), trigram("foo")}}));
+    query = Query::fromRegularExpression(QStringLiteral("\\0123abc"), Qt::CaseSensitive);
+    QCOMPARE(query.alternatives(), (QList<QList<quint32>>{{trigram("3ab"), trigram("abc")}}));
+    query = Query::fromRegularExpression(QStringLiteral("\\o{101}xyz"), Qt::CaseSensitive);
+    QCOMPARE(query.alternatives(), (QList<QList<quint32>>{{trigram("xyz")}}));
+    query = Query::fromRegularExpression(QStringLiteral("(a)\\12abc"), Qt::CaseSensitive);
+    QCOMPARE(query.alternatives(), (QList<QList<quint32>>{{trigram("abc")}}));
+    query = Query::fromRegularExpression(QStringLiteral("[\\c]]abc"), Qt::CaseSensitive);
+    QCOMPARE(query.alternatives(), (QList<QList<quint32>>{{trigram("abc")}}));
+    QVERIFY(Query::fromRegularExpression(QStringLiteral("\\oxyz"), Qt::CaseSensitive).matchesAll());
+    QVERIFY(Query::fromRegularExpression(QStringLiteral("abc\\c"), Qt::CaseSensitive).matchesAll());
+}
+
+void TrigramIndexTest::build()
+{
+    auto index = mManager->trigramIndex();
+    QSignalSpy spy{index, &Git::TrigramIndex::updated};
+    index->update();
+    QVERIFY(spy.wait());
+    QVERIFY(!index->isUpdating());
+    QCOMPARE(index->blobCount(), 2);
+    QVERIFY(QFile::exists(index->path()));
+
+    const auto content = TestCommon::readFile(mManager->path() + QStringLiteral("/a.txt"));
+    const auto a = blobOf(mManager, QStringLiteral("a.txt"));
+    const auto b = blobOf(mManager, QStringLiteral("dir/b.txt"));
+
+    auto mayMatch = index->filter(Git::TrigramIndex::Query::fromText(content.mid(4, 12), Qt::CaseSensitive));
+    QVERIFY(mayMatch(a));
+    QVERIFY(!mayMatch(b));
+
+    // blobs the index has not seen are always candidates
+    QVERIFY(mayMatch(Git::Oid::fromString(QStringLiteral("0123456789abcdef0123456789abcdef01234567"))));
+
+    mayMatch = index->filter(Git::TrigramIndex::Query::fromText(QStringLiteral("not in any file"), Qt::CaseSensitive));
+    QVERIFY(!mayMatch(a));
+    QVERIFY(!mayMatch(b));
+}
+
+void TrigramIndexTest::reload()
+{
+    auto index = mManager->trigramIndex();
+    index->reset();
+    QCOMPARE(index->blobCount(), 0);
+
+    // nothing is left to index, the saved file is all it takes
+    QSignalSpy spy{index, &Git::TrigramIndex::updated};
+    QSignalSpy progressSpy{index, &Git::TrigramIndex::progress};
+    index->update();
+    QVERIFY(spy.wait());
+    QCOMPARE(index->blobCount(), 2);
+    QVERIFY(progressSpy.isEmpty());
+}
+
+void TrigramIndexTest::newCommits()
+{
+    auto index = mManager->trigramIndex();
+    QSignalSpy spy{index, &Git::TrigramIndex::updated};
+
+    const auto content = TestCommon::touch(mManager, QStringLiteral("c.txt"));
+    mManager->commit(QStringLiteral("second"));
+    // the moved branch is enough, nothing reads the commits on this manager
+    mManager->watcher()->check();
+    QVERIFY(spy.wait());
+    QCOMPARE(index->blobCount(), 3);
+
+    const auto mayMatch = index->filter(Git::TrigramIndex::Query::fromText(content.mid(4, 12), Qt::CaseInsensitive));
+    QVERIFY(mayMatch(blobOf(mManager, QStringLiteral("c.txt"))));
+    QVERIFY(!mayMatch(blobOf(mManager, QStringLiteral("a.txt"))));
+}
+
+void TrigramIndexTest::cleanupTestCase()
+{
+    TestCommon::cleanPath(mManager);
+}
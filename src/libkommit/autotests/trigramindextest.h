@@ -0,0 +1,34 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+namespace Git
+{
+class Manager;
+};
+
+class TrigramIndexTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TrigramIndexTest(QObject *parent = nullptr);
+    ~TrigramIndexTest() override = default;
+
+private Q_SLOTS:
+    void initTestCase();
+    void textQuery();
+    void regularExpressionQuery();
+    void build();
+    void reload();
+    void newCommits();
+    void cleanupTestCase();
+
+private:
+    Git::Manager *mManager;
+};
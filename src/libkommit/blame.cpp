@@ -0,0 +1,242 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "blame_p.h"
+#include "caches/blamecache.h"
+#include "gitglobal_p.h"
+#include "history_p.h"
+
+#include <git2/blob.h>
+
+#include <QHash>
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+
+namespace Git
+{
+
+namespace
+{
+
+// Lines of one version of a blamed file that are not attributed yet, zero based
+struct BlameSuspect {
+    int start;
+    int finalStart;
+    int count;
+};
+
+// Moves the suspects the old blob has as well to passed, with their line numbers in the old blob.
+// What stays in suspects was changed between the two. suspects must be sorted.
+bool passBlame(git_repository *repo, const Oid &oldBlob, const Oid &newBlob, QVector<BlameSuspect> &suspects, QVector<BlameSuspect> &passed)
+{
+    QVector<LineDiffHunk> hunks;
+    if (!diffLines(repo, oldBlob, newBlob, &hunks))
+        return false;
+
+    QVector<BlameSuspect> changed;
+    for (const auto &suspect : std::as_const(suspects)) {
+        const auto end = suspect.start + suspect.count;
+        // suspects from different merge parents may overlap, so each one looks up its first hunk
+        auto hunk = std::partition_point(hunks.cbegin(),
+                                         hunks.cend(),
+                                         [&suspect](const LineDiffHunk &h) {
+                                             return h.newEnd <= suspect.start;
+                                         })
+            - hunks.cbegin();
+        for (auto pos = suspect.start; pos < end;) {
+            while (hunk < hunks.size() && hunks.at(hunk).newEnd <= pos)
+                ++hunk;
+
+            const auto finalStart = suspect.finalStart + pos - suspect.start;
+            if (hunk < hunks.size() && hunks.at(hunk).newStart <= pos) {
+                const auto stop = std::min(end, hunks.at(hunk).newEnd);
+                changed << BlameSuspect{pos, finalStart, stop - pos};
+                pos = stop;
+            } else {
+                const auto stop = hunk < hunks.size() ? std::min(end, hunks.at(hunk).newStart) : end;
+                const auto delta = hunk ? hunks.at(hunk - 1).delta : 0;
+                passed << BlameSuspect{pos + delta, finalStart, stop - pos};
+                pos = stop;
+            }
+        }
+    }
+
+    suspects.swap(changed);
+    return true;
+}
+
+}
+
+bool blameFile(git_repository *repo, CommitGraph *graph, const QString &fileName, const std::function<bool(const BlameHunk &)> &callback, const BlameOptions &options)
+{
+    auto path = fileName.toUtf8();
+    while (path.startsWith('/'))
+        path.remove(0, 1);
+
+    const auto start = revisionCommit(repo, options.revision);
+    HistoryCommit startCommit;
+    if (start.isNull() || !readHistoryCommit(repo, graph, start, &startCommit))
+        return false;
+
+    const auto startBlob = blobAt(repo, startCommit.tree, path);
+    git_blob *blob{nullptr};
+    if (startBlob.isNull() || git_blob_lookup(&blob, repo, startBlob.oidPtr()))
+        return false;
+
+    const auto size = git_blob_rawsize(blob);
+    const auto content = static_cast<const char *>(git_blob_rawcontent(blob));
+    int lineCount = std::count(content, content + size, '\n');
+    if (size && content[size - 1] != '\n')
+        ++lineCount;
+    git_blob_free(blob);
+
+    // the same commit may be reached with different names of the file
+    using Key = QPair<Oid, QByteArray>;
+    struct Pending {
+        HistoryCommit commit;
+        Oid blob;
+        QVector<BlameSuspect> suspects;
+    };
+    struct Queued {
+        qint64 time;
+        Key key;
+
+        bool operator<(const Queued &other) const
+        {
+            return time < other.time;
+        }
+    };
+
+    QHash<Key, Pending> pending;
+    std::priority_queue<Queued> queue;
+
+    // bounded blames would leave boundary hunks in the cache, and must not pick up older lines from it
+    const auto useCache = !options.since.isValid() && options.oldestCommit.isNull();
+    auto cache = BlameCache::instance();
+    BlameCache::Hunks found;
+    const auto report = [&](const BlameHunk &hunk) {
+        if (useCache)
+            found << hunk;
+        return callback(hunk);
+    };
+
+    const auto suspect = [&](const Oid &id, const HistoryCommit &commit, const QByteArray &path, const Oid &blob, const QVector<BlameSuspect> &suspects) {
+        const Key key{id, path};
+        auto it = pending.find(key);
+        if (it != pending.end()) {
+            it->suspects << suspects;
+            return;
+        }
+        pending.insert(key, Pending{commit, blob, suspects});
+        queue.push(Queued{commit.time, key});
+    };
+
+    const auto attribute = [&report](const Key &key, const QVector<BlameSuspect> &suspects, bool boundary) {
+        const auto originPath = QString::fromUtf8(key.second);
+        for (int i = 0; i < suspects.size();) {
+            auto hunk = BlameHunk{key.first, originPath, suspects.at(i).finalStart + 1, suspects.at(i).start + 1, suspects.at(i).count, boundary};
+
+            // ranges split by other commits' hunks are joined again where both versions agree
+            for (++i; i < suspects.size(); ++i) {
+                const auto &next = suspects.at(i);
+                if (next.start != hunk.originStartLineNumber - 1 + hunk.lineCount || next.finalStart != hunk.finalStartLineNumber - 1 + hunk.lineCount)
+                    break;
+                hunk.lineCount += next.count;
+            }
+
+            if (!report(hunk))
+                return false;
+        }
+        return true;
+    };
+
+    // the lines of a cached version take the commits its blame has for them
+    const auto reuse = [&report](const BlameCache::Hunks &cached, const QVector<BlameSuspect> &suspects) {
+        for (const auto &suspect : suspects) {
+            const auto end = suspect.start + suspect.count;
+            auto it = std::partition_point(cached.cbegin(), cached.cend(), [&suspect](const BlameHunk &h) {
+                return h.finalStartLineNumber - 1 + h.lineCount <= suspect.start;
+            });
+            for (; it != cached.cend() && it->finalStartLineNumber - 1 < end; ++it) {
+                const auto first = std::max(suspect.start, it->finalStartLineNumber - 1);
+                const auto last = std::min(end, it->finalStartLineNumber - 1 + it->lineCount);
+                const auto offset = first - (it->finalStartLineNumber - 1);
+                if (!report(BlameHunk{it->commitId,
+                                      it->originPath,
+                                      suspect.finalStart + first - suspect.start + 1,
+                                      it->originStartLineNumber + offset,
+                                      last - first,
+                                      false}))
+                    return false;
+            }
+        }
+        return true;
+    };
+
+    if (!lineCount)
+        return true;
+    suspect(start, startCommit, path, startBlob, {BlameSuspect{0, 0, lineCount}});
+
+    const auto since = options.since.isValid() ? options.since.toSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+
+    while (!queue.empty()) {
+        const auto key = queue.top().key;
+        queue.pop();
+
+        auto current = pending.take(key);
+        std::sort(current.suspects.begin(), current.suspects.end(), [](const BlameSuspect &l, const BlameSuspect &r) {
+            return l.start < r.start;
+        });
+
+        if (key.first == options.oldestCommit || current.commit.time < since) {
+            if (!attribute(key, current.suspects, true))
+                return false;
+            continue;
+        }
+
+        if (useCache) {
+            const auto cached = cache->find(key.second, key.first, options.followRenames);
+            if (!cached.isEmpty()) {
+                if (!reuse(cached, current.suspects))
+                    return false;
+                continue;
+            }
+        }
+
+        const auto parents = fileParents(repo, graph, current.commit, key.second, options.followRenames);
+
+        // a parent with the very same content takes all of it, like the history simplification of git log
+        auto same = std::find_if(parents.cbegin(), parents.cend(), [&current](const FileParent &parent) {
+            return parent.blob == current.blob;
+        });
+        if (same != parents.cend()) {
+            suspect(same->id, same->commit, same->path, same->blob, current.suspects);
+            continue;
+        }
+
+        for (const auto &parent : parents) {
+            if (current.suspects.isEmpty())
+                break;
+            if (parent.blob.isNull())
+                continue;
+
+            QVector<BlameSuspect> passed;
+            if (passBlame(repo, parent.blob, current.blob, current.suspects, passed) && !passed.isEmpty())
+                suspect(parent.id, parent.commit, parent.path, parent.blob, passed);
+        }
+
+        if (!current.suspects.isEmpty() && !attribute(key, current.suspects, false))
+            return false;
+    }
+
+    if (useCache)
+        cache->insert(path, start, options.followRenames, found);
+    return true;
+}
+
+}
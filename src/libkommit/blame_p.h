@@ -0,0 +1,26 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "blamedata.h"
+
+#include <QString>
+
+#include <git2/types.h>
+
+#include <functional>
+
+namespace Git
+{
+
+class CommitGraph;
+
+// The blame behind Manager::blame(). Suspect lines are passed from the newest commits to their
+// parents, and finished blames of older versions are taken from the BlameCache.
+bool blameFile(git_repository *repo, CommitGraph *graph, const QString &fileName, const std::function<bool(const BlameHunk &)> &callback, const BlameOptions &options);
+
+}
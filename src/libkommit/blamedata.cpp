@@ -13,7 +13,7 @@ BlameData::BlameData() = default;
 
 bool operator==(const BlameDataRow &l, const BlameDataRow &r)
 {
-    return l.finalCommit == r.finalCommit;
+    return l.commitId == r.commitId;
 }
 bool operator!=(const BlameDataRow &l, const BlameDataRow &r)
 {
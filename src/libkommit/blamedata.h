@@ -5,9 +5,11 @@ SPDX-License-Identifier: GPL-3.0-or-later
 */
 
 #pragma once
+#include "entities/oid.h"
 #include "gitloglist.h"
 #include "libkommit_export.h"
 
+#include <QDateTime>
 #include <QSharedPointer>
 #include <QString>
 
@@ -18,7 +20,7 @@ struct BlameDataRow {
     BlameDataRow()
     {
     }
-    BlameDataRow(QString commitHash,
+    BlameDataRow(Oid commitId,
                  QString code,
                  QString originPath,
                  QSharedPointer<Commit> finalCommit,
@@ -27,7 +29,7 @@ struct BlameDataRow {
                  QSharedPointer<Signature> originSignature,
                  size_t finalStartLineNumber,
                  size_t originStartLineNumber)
-        : commitHash(std::move(commitHash))
+        : commitId(commitId)
         , code(std::move(code))
         , originPath(std::move(originPath))
         , finalCommit(std::move(finalCommit))
@@ -39,7 +41,7 @@ struct BlameDataRow {
     {
     }
 
-    QString commitHash;
+    Oid commitId;
     QString code;
 
     QString originPath;
@@ -61,4 +63,28 @@ public:
     BlameData();
 };
 
+// Lines of the blamed file that one commit last changed. Plain values only, so hunks can be
+// handed from a worker to another thread and looked up there.
+struct BlameHunk {
+    Oid commitId;
+    // name of the file in that commit
+    QString originPath;
+    // one based, like the line numbers of BlameDataRow
+    int finalStartLineNumber{0};
+    int originStartLineNumber{0};
+    int lineCount{0};
+    // The walk stopped at this commit because of BlameOptions, the lines may be older
+    bool boundary{false};
+};
+
+struct BlameOptions {
+    // version of the file to blame
+    QString revision{QStringLiteral("HEAD")};
+    // the walk does not look past commits older than this, their lines become boundary hunks
+    QDateTime since;
+    // same for this commit; a null oid walks the whole history
+    Oid oldestCommit;
+    bool followRenames{true};
+};
+
 } // namespace Git
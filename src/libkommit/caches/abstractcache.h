@@ -13,7 +13,10 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <git2/types.h>
 
+#include <vector>
+
 #include "libkommit_export.h"
+#include "oidhashmap.h"
 
 namespace Git
 {
@@ -56,45 +59,370 @@ protected:
     QHash<PtrType *, DataMember> mHash;
 };
 
+struct CacheStats {
+    qint64 hits{0};
+    qint64 misses{0};
+    qint64 evictions{0};
+    qint64 cost{0};
+    int size{0};
+};
+
+/**
+ * Object cache keyed by object id.
+ *
+ * Lookups hit the cache first and only fall back to libgit2 on a miss, so the same object is never
+ * loaded twice while it is cached. The cache may be bounded by entry count and/or by cost (roughly
+ * bytes), in which case the least recently used entries are evicted first. Entities handed out
+ * earlier stay valid after eviction, they are just no longer shared.
+ */
 template<class ObjectType, class PtrType>
-class OidCache : public Cache<ObjectType, PtrType>
+class OidCache
 {
 public:
+    using DataMember = QSharedPointer<ObjectType>;
+    using DataList = QList<QSharedPointer<ObjectType>>;
     using GitLookupFunc = int (*)(PtrType **, git_repository *, const git_oid *);
+    using GitIdFunc = const git_oid *(*)(const PtrType *);
+    using GitFreeFunc = void (*)(PtrType *);
 
-    explicit OidCache(Manager *git);
-    OidCache(Manager *git, GitLookupFunc func);
+    OidCache(Manager *git, GitLookupFunc lookupFunc, GitIdFunc idFunc, GitFreeFunc freeFunc);
+    virtual ~OidCache();
 
-    QSharedPointer<ObjectType> findByOid(const git_oid *oid, bool *isNew = nullptr);
+    DataMember findByOid(const git_oid *oid, bool *isNew = nullptr);
+    DataMember findByOid(const Oid &oid, bool *isNew = nullptr);
+
+    // Takes ownership of ptr; it is freed right away if the object is already cached
+    DataMember findByPtr(PtrType *ptr, bool *isNew = nullptr);
+
+    // Cache only, never touches the repository
+    DataMember value(const git_oid *oid);
+    DataMember value(const Oid &oid);
+    bool contains(const git_oid *oid) const;
+    bool contains(const Oid &oid) const;
+
+    bool insert(const git_oid *oid, DataMember obj);
+    bool remove(const git_oid *oid);
+    bool remove(const Oid &oid);
+
+    int size() const;
+    void clear();
+
+    void setMaxSize(int maxSize);
+    int maxSize() const;
+    void setMaxCost(qint64 maxCost);
+    qint64 maxCost() const;
+    qint64 totalCost() const;
+    CacheStats stats() const;
 
 protected:
-    GitLookupFunc gitLookupFunc{nullptr};
+    virtual void clearChildData() = 0;
+    virtual qint64 cost(const ObjectType &obj) const;
+
+    Manager *manager;
+
+private:
+    struct Node {
+        git_oid oid;
+        DataMember data;
+        qint64 cost{0};
+        int prev{-1};
+        int next{-1};
+    };
+
+    DataMember touch(int index);
+    int addNode(const git_oid *oid, DataMember obj);
+    void removeNode(int index);
+    void unlink(int index);
+    void pushFront(int index);
+    void trim();
+
+    GitLookupFunc gitLookupFunc;
+    GitIdFunc gitIdFunc;
+    GitFreeFunc gitFreeFunc;
+
+    std::vector<Node> mNodes;
+    OidHashMap<int> mIndex;
+    int mHead{-1};
+    int mTail{-1};
+    int mFreeList{-1};
+    int mMaxSize{0};
+    qint64 mMaxCost{0};
+    qint64 mTotalCost{0};
+    CacheStats mStats;
 };
 
 template<class ObjectType, class PtrType>
-Q_OUTOFLINE_TEMPLATE OidCache<ObjectType, PtrType>::OidCache(Manager *git)
-    : Git::Cache<ObjectType, PtrType>{git}
+Q_OUTOFLINE_TEMPLATE OidCache<ObjectType, PtrType>::OidCache(Manager *git, GitLookupFunc lookupFunc, GitIdFunc idFunc, GitFreeFunc freeFunc)
+    : manager{git}
+    , gitLookupFunc{lookupFunc}
+    , gitIdFunc{idFunc}
+    , gitFreeFunc{freeFunc}
 {
 }
 
 template<class ObjectType, class PtrType>
-Q_OUTOFLINE_TEMPLATE OidCache<ObjectType, PtrType>::OidCache(Manager *git, GitLookupFunc func)
-    : Git::Cache<ObjectType, PtrType>{git}
-    , gitLookupFunc{func}
+Q_OUTOFLINE_TEMPLATE OidCache<ObjectType, PtrType>::~OidCache()
 {
 }
 
 template<class ObjectType, class PtrType>
 Q_OUTOFLINE_TEMPLATE QSharedPointer<ObjectType> OidCache<ObjectType, PtrType>::findByOid(const git_oid *oid, bool *isNew)
 {
+    if (isNew)
+        *isNew = false;
+
+    if (auto index = mIndex.find(oid)) {
+        ++mStats.hits;
+        return touch(*index);
+    }
+
+    ++mStats.misses;
+
     PtrType *ptr;
-    auto r = gitLookupFunc(&ptr, Impl::getRepo(Cache<ObjectType, PtrType>::manager), oid);
-    if (!r)
-        return Cache<ObjectType, PtrType>::findByPtr(ptr, isNew);
+    if (gitLookupFunc(&ptr, Impl::getRepo(manager), oid))
+        return DataMember{};
+
+    auto entity = DataMember{new ObjectType{ptr}};
+    addNode(oid, entity);
+
+    if (isNew)
+        *isNew = true;
+    return entity;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE QSharedPointer<ObjectType> OidCache<ObjectType, PtrType>::findByOid(const Oid &oid, bool *isNew)
+{
+    return findByOid(oid.oidPtr(), isNew);
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE QSharedPointer<ObjectType> OidCache<ObjectType, PtrType>::findByPtr(PtrType *ptr, bool *isNew)
+{
+    Q_ASSERT(gitIdFunc);
 
     if (isNew)
         *isNew = false;
-    return QSharedPointer<ObjectType>{};
+
+    const auto oid = gitIdFunc(ptr);
+    if (auto index = mIndex.find(oid)) {
+        ++mStats.hits;
+        gitFreeFunc(ptr);
+        return touch(*index);
+    }
+
+    ++mStats.misses;
+
+    auto entity = DataMember{new ObjectType{ptr}};
+    addNode(oid, entity);
+
+    if (isNew)
+        *isNew = true;
+    return entity;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE QSharedPointer<ObjectType> OidCache<ObjectType, PtrType>::value(const git_oid *oid)
+{
+    auto index = mIndex.find(oid);
+    return index ? touch(*index) : DataMember{};
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE QSharedPointer<ObjectType> OidCache<ObjectType, PtrType>::value(const Oid &oid)
+{
+    return value(oid.oidPtr());
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE bool OidCache<ObjectType, PtrType>::contains(const git_oid *oid) const
+{
+    return mIndex.contains(oid);
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE bool OidCache<ObjectType, PtrType>::contains(const Oid &oid) const
+{
+    return mIndex.contains(oid);
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE bool OidCache<ObjectType, PtrType>::insert(const git_oid *oid, DataMember obj)
+{
+    if (mIndex.contains(oid))
+        return false;
+
+    addNode(oid, obj);
+    return true;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE bool OidCache<ObjectType, PtrType>::remove(const git_oid *oid)
+{
+    auto index = mIndex.find(oid);
+    if (!index)
+        return false;
+
+    removeNode(*index);
+    return true;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE bool OidCache<ObjectType, PtrType>::remove(const Oid &oid)
+{
+    return remove(oid.oidPtr());
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE int OidCache<ObjectType, PtrType>::size() const
+{
+    return mIndex.size();
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void OidCache<ObjectType, PtrType>::clear()
+{
+    mNodes.clear();
+    mIndex.clear();
+    mHead = mTail = mFreeList = -1;
+    mTotalCost = 0;
+    clearChildData();
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void OidCache<ObjectType, PtrType>::setMaxSize(int maxSize)
+{
+    mMaxSize = maxSize;
+    trim();
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE int OidCache<ObjectType, PtrType>::maxSize() const
+{
+    return mMaxSize;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void OidCache<ObjectType, PtrType>::setMaxCost(qint64 maxCost)
+{
+    mMaxCost = maxCost;
+    trim();
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE qint64 OidCache<ObjectType, PtrType>::maxCost() const
+{
+    return mMaxCost;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE qint64 OidCache<ObjectType, PtrType>::totalCost() const
+{
+    return mTotalCost;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE CacheStats OidCache<ObjectType, PtrType>::stats() const
+{
+    auto s = mStats;
+    s.cost = mTotalCost;
+    s.size = mIndex.size();
+    return s;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE qint64 OidCache<ObjectType, PtrType>::cost(const ObjectType &obj) const
+{
+    Q_UNUSED(obj)
+    return sizeof(ObjectType);
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE QSharedPointer<ObjectType> OidCache<ObjectType, PtrType>::touch(int index)
+{
+    if (index != mHead) {
+        unlink(index);
+        pushFront(index);
+    }
+    return mNodes[index].data;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE int OidCache<ObjectType, PtrType>::addNode(const git_oid *oid, DataMember obj)
+{
+    int index;
+    if (mFreeList != -1) {
+        index = mFreeList;
+        mFreeList = mNodes[index].next;
+    } else {
+        index = static_cast<int>(mNodes.size());
+        mNodes.emplace_back();
+    }
+
+    auto &node = mNodes[index];
+    git_oid_cpy(&node.oid, oid);
+    node.data = obj;
+    node.cost = obj ? cost(*obj) : 0;
+    mTotalCost += node.cost;
+
+    pushFront(index);
+    mIndex.insert(oid, index);
+    trim();
+    return index;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void OidCache<ObjectType, PtrType>::removeNode(int index)
+{
+    auto &node = mNodes[index];
+    unlink(index);
+    mIndex.remove(&node.oid);
+    mTotalCost -= node.cost;
+
+    node.data.reset();
+    node.cost = 0;
+    node.next = mFreeList;
+    mFreeList = index;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void OidCache<ObjectType, PtrType>::unlink(int index)
+{
+    auto &node = mNodes[index];
+    if (node.prev != -1)
+        mNodes[node.prev].next = node.next;
+    else
+        mHead = node.next;
+
+    if (node.next != -1)
+        mNodes[node.next].prev = node.prev;
+    else
+        mTail = node.prev;
+
+    node.prev = node.next = -1;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void OidCache<ObjectType, PtrType>::pushFront(int index)
+{
+    auto &node = mNodes[index];
+    node.prev = -1;
+    node.next = mHead;
+    if (mHead != -1)
+        mNodes[mHead].prev = index;
+    mHead = index;
+    if (mTail == -1)
+        mTail = index;
+}
+
+template<class ObjectType, class PtrType>
+Q_OUTOFLINE_TEMPLATE void OidCache<ObjectType, PtrType>::trim()
+{
+    // the most recently used entry always survives, even if it alone exceeds the cost limit
+    while (mTail != mHead && ((mMaxSize > 0 && mIndex.size() > mMaxSize) || (mMaxCost > 0 && mTotalCost > mMaxCost))) {
+        removeNode(mTail);
+        ++mStats.evictions;
+    }
 }
 
 template<class ObjectType, class PtrType>
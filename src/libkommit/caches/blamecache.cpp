@@ -0,0 +1,90 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "blamecache.h"
+
+#include <algorithm>
+
+namespace Git
+{
+
+namespace
+{
+// a hunk is a few dozen bytes, so this keeps the blames of a few thousand files
+constexpr int defaultMaxCost = 200000;
+}
+
+Q_GLOBAL_STATIC(BlameCache, blameCacheInstance)
+
+BlameCache::BlameCache()
+    : mCache{defaultMaxCost}
+{
+}
+
+BlameCache *BlameCache::instance()
+{
+    return blameCacheInstance;
+}
+
+BlameCache::Hunks BlameCache::find(const QByteArray &path, const Oid &commit, bool followRenames)
+{
+    QMutexLocker locker(&mMutex);
+
+    auto hunks = mCache.object(Key{{commit, path}, followRenames});
+    if (!hunks) {
+        ++mStats.misses;
+        return {};
+    }
+    ++mStats.hits;
+    return *hunks;
+}
+
+void BlameCache::insert(const QByteArray &path, const Oid &commit, bool followRenames, Hunks hunks)
+{
+    std::sort(hunks.begin(), hunks.end(), [](const BlameHunk &l, const BlameHunk &r) {
+        return l.finalStartLineNumber < r.finalStartLineNumber;
+    });
+
+    // empty files have nothing to reuse
+    if (hunks.isEmpty())
+        return;
+    const auto cost = static_cast<int>(hunks.size());
+    const Key key{{commit, path}, followRenames};
+
+    QMutexLocker locker(&mMutex);
+
+    const auto size = mCache.size();
+    const auto existed = mCache.contains(key);
+    mCache.insert(key, new Hunks{std::move(hunks)}, cost);
+    mStats.evictions += size + (existed ? 0 : 1) - mCache.size();
+}
+
+void BlameCache::clear()
+{
+    QMutexLocker locker(&mMutex);
+    mCache.clear();
+}
+
+void BlameCache::setMaxCost(int maxCost)
+{
+    QMutexLocker locker(&mMutex);
+
+    const auto size = mCache.size();
+    mCache.setMaxCost(maxCost);
+    mStats.evictions += size - mCache.size();
+}
+
+CacheStats BlameCache::stats() const
+{
+    QMutexLocker locker(&mMutex);
+
+    auto s = mStats;
+    s.cost = mCache.totalCost();
+    s.size = mCache.size();
+    return s;
+}
+
+}
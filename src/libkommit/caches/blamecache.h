@@ -0,0 +1,56 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "abstractcache.h"
+#include "blamedata.h"
+#include "entities/oid.h"
+#include "libkommit_export.h"
+
+#include <QByteArray>
+#include <QCache>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+
+namespace Git
+{
+
+/**
+ * Finished blames by path and commit, shared by all managers and threads.
+ *
+ * A commit id fixes the whole history behind it, so results stay valid for good and can be reused
+ * by any repository that has the commit. Blaming a descendant stops at the first commit found here
+ * and only attributes the lines changed since. Blames that follow renames are kept apart from the
+ * ones that do not, their lines may come from other files. Bounded by the number of hunks kept.
+ */
+class LIBKOMMIT_EXPORT BlameCache
+{
+public:
+    using Hunks = QList<BlameHunk>;
+
+    BlameCache();
+    static BlameCache *instance();
+
+    // Hunks sorted by final line number, empty if the blame is not cached
+    Q_REQUIRED_RESULT Hunks find(const QByteArray &path, const Oid &commit, bool followRenames);
+    // Only blames of the whole history may be stored, boundary hunks would be taken as final
+    void insert(const QByteArray &path, const Oid &commit, bool followRenames, Hunks hunks);
+    void clear();
+
+    void setMaxCost(int maxCost);
+    Q_REQUIRED_RESULT CacheStats stats() const;
+
+private:
+    using Key = QPair<QPair<Oid, QByteArray>, bool>;
+
+    mutable QMutex mMutex;
+    QCache<Key, Hunks> mCache;
+    CacheStats mStats;
+};
+
+}
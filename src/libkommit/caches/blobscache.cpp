@@ -0,0 +1,66 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "blobscache.h"
+#include "gitglobal_p.h"
+#include "gitmanager.h"
+
+#include <git2/blob.h>
+#include <git2/object.h>
+#include <git2/revparse.h>
+#include <git2/tree.h>
+
+namespace Git
+{
+
+namespace
+{
+constexpr qint64 defaultMaxCost{64 * 1024 * 1024};
+}
+
+BlobsCache::BlobsCache(Manager *parent)
+    : OidCache<Blob, git_blob>{parent, git_blob_lookup, git_blob_id, git_blob_free}
+{
+    setMaxCost(defaultMaxCost);
+}
+
+BlobsCache::DataMember BlobsCache::find(const QString &place, const QString &path)
+{
+    git_object *placeObject{nullptr};
+    git_object *tree{nullptr};
+    git_tree_entry *entry{nullptr};
+
+    auto filePath = path;
+    if (filePath.startsWith(QLatin1Char('/')))
+        filePath = filePath.mid(1);
+
+    BEGIN
+    STEP git_revparse_single(&placeObject, manager->repoPtr(), place.toUtf8().constData());
+    STEP git_object_peel(&tree, placeObject, GIT_OBJECT_TREE);
+    STEP git_tree_entry_bypath(&entry, reinterpret_cast<git_tree *>(tree), filePath.toUtf8().constData());
+    PRINT_ERROR;
+
+    DataMember blob;
+    if (IS_OK && git_tree_entry_type(entry) == GIT_OBJECT_BLOB)
+        blob = findByOid(git_tree_entry_id(entry));
+
+    git_tree_entry_free(entry);
+    git_object_free(tree);
+    git_object_free(placeObject);
+    return blob;
+}
+
+void BlobsCache::clearChildData()
+{
+}
+
+qint64 BlobsCache::cost(const Blob &blob) const
+{
+    // UTF-16 text takes about twice the bytes of the raw content
+    return sizeof(Blob) + (blob.isBinary() ? blob.size() : blob.size() * 3);
+}
+
+}
@@ -0,0 +1,37 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <git2/types.h>
+
+#include "abstractcache.h"
+#include "entities/blob.h"
+#include "libkommit_export.h"
+
+namespace Git
+{
+
+/**
+ * File contents by blob id, shared by every view that shows them.
+ *
+ * The same blob shows up in many commits, so diffs, file viewers, blame and search all read it
+ * from here. The cache is bounded by memory; a text blob is counted with its decoded text.
+ */
+class LIBKOMMIT_EXPORT BlobsCache : public OidCache<Blob, git_blob>
+{
+public:
+    explicit BlobsCache(Manager *parent);
+
+    // Blob of the file at path in the tree place (a commit, branch, tag or tree) points to
+    Q_REQUIRED_RESULT DataMember find(const QString &place, const QString &path);
+
+protected:
+    void clearChildData() override;
+    qint64 cost(const Blob &blob) const override;
+};
+
+}
@@ -28,6 +28,7 @@ public:
     QList<BranchesCache::DataMember> list;
     QMap<QString, BranchesCache::DataMember> dataByName;
     QHash<git_reference *, BranchesCache::DataMember> dataByRef;
+    ChangeSetCollector<BranchesCache::DataMember> changes;
 
     BranchesCachePrivate(BranchesCache *parent, Manager *manager);
     void add(BranchesCache::DataMember newItem);
@@ -67,6 +68,8 @@ BranchesCache::DataMember BranchesCache::findByName(const QString &key)
 
 bool BranchesCache::create(const QString &name)
 {
+    Q_D(BranchesCache);
+
     git_reference *ref{nullptr};
     git_commit *commit{nullptr};
     git_reference *head{nullptr};
@@ -89,6 +92,11 @@ bool BranchesCache::create(const QString &name)
 
     PRINT_ERROR;
 
+    if (IS_OK) {
+        if (auto branch = findByName(name))
+            d->changes.insert(branch);
+    }
+
     return IS_OK;
 }
 
@@ -100,7 +108,7 @@ bool BranchesCache::remove(DataMember branch)
     STEP git_branch_delete(branch->refPtr());
 
     if (IS_OK && d->remove(branch)) {
-        Q_EMIT removed(branch);
+        d->changes.remove(branch);
         return true;
     }
     return false;
@@ -198,6 +206,9 @@ void BranchesCache::clearChildData()
 BranchesCachePrivate::BranchesCachePrivate(BranchesCache *parent, Manager *manager)
     : q_ptr{parent}
     , manager{manager}
+    , changes{parent, [parent](const BranchesCache::ChangeSet &set) {
+                  Q_EMIT parent->changed(set);
+              }}
 {
 }
 
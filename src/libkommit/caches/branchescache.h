@@ -7,6 +7,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
 
 #include "caches/abstractcache.h"
+#include "caches/changeset.h"
 #include "entities/branch.h"
 #include "libkommit_export.h"
 #include "types.h"
@@ -28,6 +29,7 @@ class LIBKOMMIT_EXPORT BranchesCache : public QObject, public Cache<Branch, git_
 public:
     using DataMember = QSharedPointer<Branch>;
     using DataList = QList<DataMember>;
+    using ChangeSet = Git::ChangeSet<DataMember>;
 
     explicit BranchesCache(Manager *manager);
     virtual ~BranchesCache();
@@ -46,8 +48,8 @@ protected:
 
 Q_SIGNALS:
     void currentChanged(DataMember oldBranch, DataMember newBranch);
-    void added(DataMember branch);
-    void removed(DataMember branch);
+    // Branches created or removed through this cache, once per event loop turn
+    void changed(const Git::BranchesCache::ChangeSet &changes);
     void reseted();
 
 private:
@@ -55,3 +57,5 @@ private:
     Q_DECLARE_PRIVATE(BranchesCache)
 };
 };
+
+Q_DECLARE_METATYPE(Git::BranchesCache::ChangeSet)
@@ -0,0 +1,162 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QList>
+#include <QMetaObject>
+#include <QObject>
+#include <QThread>
+
+#include <functional>
+#include <utility>
+
+namespace Git
+{
+
+// Items a cache gained, lost or refreshed
+template<class T>
+class ChangeSet
+{
+public:
+    QList<T> inserted;
+    QList<T> removed;
+    QList<T> updated;
+
+    Q_REQUIRED_RESULT bool isEmpty() const
+    {
+        return inserted.isEmpty() && removed.isEmpty() && updated.isEmpty();
+    }
+
+    void clear()
+    {
+        inserted.clear();
+        removed.clear();
+        updated.clear();
+    }
+};
+
+/**
+ * Collects the changes of a cache and hands them out as one change set per event loop turn, so
+ * listeners update once for a whole batch instead of once per item.
+ *
+ * An item inserted and removed within the same turn is not reported at all. Items are looked up by
+ * hash, so T needs qHash(); a whole history rewritten at once costs linear time. Changes are only
+ * collected on the main thread: caches of the worker handles of ManagerPool have no listeners,
+ * and the threads they run on may never get back to an event loop.
+ */
+template<class T>
+class ChangeSetCollector
+{
+public:
+    using Emitter = std::function<void(const ChangeSet<T> &changes)>;
+
+    ChangeSetCollector(QObject *owner, Emitter emitter)
+        : mOwner{owner}
+        , mEmitter{std::move(emitter)}
+    {
+    }
+
+    void insert(const T &item)
+    {
+        if (!schedule())
+            return;
+        auto it = mStates.find(item);
+        if (it == mStates.end()) {
+            mStates.insert(item, State::Inserted);
+            mOrder << item;
+        } else if (*it == State::Removed) {
+            mStates.erase(it);
+        }
+    }
+
+    void remove(const T &item)
+    {
+        if (!schedule())
+            return;
+        auto it = mStates.find(item);
+        if (it == mStates.end()) {
+            mStates.insert(item, State::Removed);
+            mOrder << item;
+        } else if (*it == State::Inserted) {
+            mStates.erase(it);
+        } else {
+            *it = State::Removed;
+        }
+    }
+
+    void update(const T &item)
+    {
+        if (!schedule())
+            return;
+        if (!mStates.contains(item)) {
+            mStates.insert(item, State::Updated);
+            mOrder << item;
+        }
+    }
+
+    // Emits what was collected so far right away
+    void flush()
+    {
+        mScheduled = false;
+
+        // an item is in the order once per time it got a state, it is reported at its first place
+        ChangeSet<T> changes;
+        for (const auto &item : std::as_const(mOrder)) {
+            auto it = mStates.find(item);
+            if (it == mStates.end())
+                continue;
+            switch (*it) {
+            case State::Inserted:
+                changes.inserted << item;
+                break;
+            case State::Removed:
+                changes.removed << item;
+                break;
+            case State::Updated:
+                changes.updated << item;
+                break;
+            }
+            mStates.erase(it);
+        }
+        mOrder.clear();
+        mStates.clear();
+
+        if (!changes.isEmpty())
+            mEmitter(changes);
+    }
+
+private:
+    bool schedule()
+    {
+        auto app = QCoreApplication::instance();
+        if (!app || QThread::currentThread() != app->thread() || mOwner->thread() != app->thread())
+            return false;
+
+        if (!mScheduled) {
+            mScheduled = true;
+            QMetaObject::invokeMethod(
+                mOwner,
+                [this]() {
+                    flush();
+                },
+                Qt::QueuedConnection);
+        }
+        return true;
+    }
+
+    QObject *const mOwner;
+    const Emitter mEmitter;
+    enum class State { Inserted, Removed, Updated };
+
+    QHash<T, State> mStates;
+    QList<T> mOrder;
+    bool mScheduled{false};
+};
+
+}
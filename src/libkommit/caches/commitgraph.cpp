@@ -0,0 +1,619 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "commitgraph.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QtEndian>
+
+#include <cstring>
+#include <queue>
+#include <utility>
+
+namespace Git
+{
+
+namespace
+{
+
+constexpr int headerSize = 8;
+constexpr int chunkEntrySize = 12;
+constexpr int rawOidSize = 20;
+constexpr int fanoutSize = 256 * 4;
+constexpr int commitDataSize = rawOidSize + 16;
+
+constexpr quint32 chunkFanout = 0x4f494446; // "OIDF"
+constexpr quint32 chunkOidLookup = 0x4f49444c; // "OIDL"
+constexpr quint32 chunkCommitData = 0x43444154; // "CDAT"
+constexpr quint32 chunkExtraEdges = 0x45444745; // "EDGE"
+constexpr quint32 chunkBloomIndex = 0x42494458; // "BIDX"
+constexpr quint32 chunkBloomData = 0x42444154; // "BDAT"
+
+constexpr quint32 parentNone = 0x70000000;
+constexpr quint32 extraEdgesNeeded = 0x80000000;
+constexpr quint32 lastEdge = 0x80000000;
+constexpr quint32 edgeMask = 0x7fffffff;
+
+constexpr int bloomHeaderSize = 12;
+constexpr quint32 bloomSeed0 = 0x293ae76f;
+constexpr quint32 bloomSeed1 = 0x7e646e2c;
+
+quint32 be32(const uchar *p)
+{
+    return qFromBigEndian<quint32>(p);
+}
+
+quint32 rotateLeft(quint32 value, int count)
+{
+    return (value << count) | (value >> (32 - count));
+}
+
+// The murmur3 variant git hashes filter keys with. Version 1 of the filters was written with
+// bytes read as signed chars, which only matters for bytes >= 0x80.
+quint32 murmur3(quint32 seed, const QByteArray &data, quint32 hashVersion)
+{
+    constexpr quint32 c1 = 0xcc9e2d51;
+    constexpr quint32 c2 = 0x1b873593;
+    constexpr quint32 m = 5;
+    constexpr quint32 n = 0xe6546b64;
+
+    const auto byte = [&data, hashVersion](int i) -> quint32 {
+        if (hashVersion == 1)
+            return static_cast<quint32>(static_cast<qint32>(static_cast<signed char>(data.at(i))));
+        return static_cast<uchar>(data.at(i));
+    };
+
+    const int length = data.size();
+    const int blocks = length / 4;
+    for (int i = 0; i < blocks; ++i) {
+        auto k = byte(4 * i) | (byte(4 * i + 1) << 8) | (byte(4 * i + 2) << 16) | (byte(4 * i + 3) << 24);
+        k *= c1;
+        k = rotateLeft(k, 15);
+        k *= c2;
+
+        seed ^= k;
+        seed = rotateLeft(seed, 13) * m + n;
+    }
+
+    quint32 k{0};
+    const auto tail = blocks * 4;
+    switch (length & 3) {
+    case 3:
+        k ^= byte(tail + 2) << 16;
+        Q_FALLTHROUGH();
+    case 2:
+        k ^= byte(tail + 1) << 8;
+        Q_FALLTHROUGH();
+    case 1:
+        k ^= byte(tail);
+        k *= c1;
+        k = rotateLeft(k, 15);
+        k *= c2;
+        seed ^= k;
+        break;
+    }
+
+    seed ^= static_cast<quint32>(length);
+    seed ^= seed >> 16;
+    seed *= 0x85ebca6b;
+    seed ^= seed >> 13;
+    seed *= 0xc2b2ae35;
+    seed ^= seed >> 16;
+    return seed;
+}
+
+QString fileSignature(const QString &path)
+{
+    QFileInfo fi{path};
+    if (!fi.exists())
+        return {};
+    return QStringLiteral("%1:%2:%3").arg(path).arg(fi.size()).arg(fi.lastModified().toMSecsSinceEpoch());
+}
+
+}
+
+CommitGraph::CommitGraph() = default;
+
+CommitGraph::~CommitGraph()
+{
+    clear();
+}
+
+bool CommitGraph::refresh(const QString &infoPath)
+{
+    const auto singlePath = infoPath + QStringLiteral("commit-graph");
+    const auto chainPath = infoPath + QStringLiteral("commit-graphs/commit-graph-chain");
+
+    // like git, a single file takes precedence over a chain
+    auto signature = fileSignature(singlePath);
+    const auto isChain = signature.isEmpty();
+    if (isChain)
+        signature = fileSignature(chainPath);
+
+    if (infoPath == mInfoPath && signature == mSignature)
+        return isValid();
+
+    clear();
+
+    if (!isChain) {
+        if (!loadLayer(singlePath))
+            clear();
+    } else if (!signature.isEmpty()) {
+        QFile chain{chainPath};
+        if (chain.open(QIODevice::ReadOnly)) {
+            const auto hashes = chain.readAll().split('\n');
+            for (const auto &hash : hashes) {
+                if (hash.trimmed().isEmpty())
+                    continue;
+
+                if (!loadLayer(infoPath + QStringLiteral("commit-graphs/graph-%1.graph").arg(QString::fromLatin1(hash.trimmed())))) {
+                    clear();
+                    break;
+                }
+            }
+        }
+    }
+
+    // remembered even if loading failed, so a broken file is not parsed again on every call
+    mInfoPath = infoPath;
+    mSignature = signature;
+    return isValid();
+}
+
+void CommitGraph::clear()
+{
+    for (auto &layer : mLayers)
+        delete layer.file;
+    mLayers.clear();
+    mInfoPath.clear();
+    mSignature.clear();
+    mSize = 0;
+    mBloomHashVersion = 0;
+    mBloomHashCount = 0;
+}
+
+bool CommitGraph::loadLayer(const QString &fileName)
+{
+    auto file = new QFile{fileName};
+    const auto fail = [file]() {
+        delete file;
+        return false;
+    };
+
+    if (!file->open(QIODevice::ReadOnly))
+        return fail();
+
+    const auto size = file->size();
+    const auto data = file->map(0, size);
+    if (!data || size < headerSize + chunkEntrySize)
+        return fail();
+
+    // version 1, SHA-1 object ids
+    if (std::memcmp(data, "CGPH", 4) || data[4] != 1 || data[5] != 1)
+        return fail();
+
+    const auto chunkCount = data[6];
+    const auto baseCount = data[7];
+    if (baseCount != mLayers.size() || headerSize + (chunkCount + 1) * chunkEntrySize > size)
+        return fail();
+
+    Layer layer;
+    layer.file = file;
+
+    qint64 oidsSize{0};
+    qint64 commitDataLength{0};
+    qint64 bloomIndexLength{0};
+    qint64 bloomDataLength{0};
+    for (int i = 0; i < chunkCount; ++i) {
+        const auto entry = data + headerSize + i * chunkEntrySize;
+        const auto id = be32(entry);
+        const auto offset = qFromBigEndian<quint64>(entry + 4);
+        const auto next = qFromBigEndian<quint64>(entry + chunkEntrySize + 4);
+        if (offset > next || next > quint64(size))
+            return fail();
+
+        const auto length = static_cast<qint64>(next - offset);
+        switch (id) {
+        case chunkFanout:
+            if (length != fanoutSize)
+                return fail();
+            layer.fanout = data + offset;
+            break;
+        case chunkOidLookup:
+            layer.oids = data + offset;
+            oidsSize = length;
+            break;
+        case chunkCommitData:
+            layer.commitData = data + offset;
+            commitDataLength = length;
+            break;
+        case chunkExtraEdges:
+            layer.extraEdges = data + offset;
+            layer.extraEdgeCount = static_cast<quint32>(length / 4);
+            break;
+        case chunkBloomIndex:
+            layer.bloomIndex = data + offset;
+            bloomIndexLength = length;
+            break;
+        case chunkBloomData:
+            layer.bloomData = data + offset;
+            bloomDataLength = length;
+            break;
+        }
+    }
+
+    if (!layer.fanout || !layer.oids || !layer.commitData)
+        return fail();
+
+    layer.count = be32(layer.fanout + 255 * 4);
+    if (oidsSize < qint64(layer.count) * rawOidSize || commitDataLength < qint64(layer.count) * commitDataSize)
+        return fail();
+
+    // filters are optional, a layer whose filters can't be used is still a valid graph
+    if (layer.bloomIndex && layer.bloomData && bloomIndexLength >= qint64(layer.count) * 4 && bloomDataLength >= bloomHeaderSize) {
+        const auto hashVersion = be32(layer.bloomData);
+        const auto hashCount = be32(layer.bloomData + 4);
+        const auto compatible = mBloomHashCount ? hashVersion == mBloomHashVersion && hashCount == mBloomHashCount : true;
+
+        if ((hashVersion == 1 || hashVersion == 2) && hashCount && compatible) {
+            mBloomHashVersion = hashVersion;
+            mBloomHashCount = hashCount;
+            layer.bloomData += bloomHeaderSize;
+            layer.bloomDataSize = static_cast<quint32>(bloomDataLength - bloomHeaderSize);
+        } else {
+            layer.bloomIndex = layer.bloomData = nullptr;
+        }
+    } else {
+        layer.bloomIndex = layer.bloomData = nullptr;
+    }
+
+    layer.base = mSize;
+    mSize += layer.count;
+    mLayers.push_back(layer);
+    return true;
+}
+
+bool CommitGraph::isValid() const
+{
+    return !mLayers.empty();
+}
+
+quint32 CommitGraph::size() const
+{
+    return mSize;
+}
+
+bool CommitGraph::find(const Oid &oid, quint32 *position) const
+{
+    const auto raw = oid.oidPtr()->id;
+
+    for (const auto &layer : mLayers) {
+        quint32 low = raw[0] ? be32(layer.fanout + (raw[0] - 1) * 4) : 0;
+        quint32 high = be32(layer.fanout + raw[0] * 4);
+
+        while (low < high) {
+            const auto middle = low + (high - low) / 2;
+            const auto cmp = std::memcmp(layer.oids + middle * rawOidSize, raw, rawOidSize);
+            if (!cmp) {
+                *position = layer.base + middle;
+                return true;
+            }
+            if (cmp < 0)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+    }
+    return false;
+}
+
+const CommitGraph::Layer *CommitGraph::layerOf(quint32 position) const
+{
+    for (const auto &layer : mLayers)
+        if (position >= layer.base && position < layer.base + layer.count)
+            return &layer;
+    return nullptr;
+}
+
+const uchar *CommitGraph::commitDataOf(quint32 position) const
+{
+    auto layer = layerOf(position);
+    return layer ? layer->commitData + (position - layer->base) * commitDataSize : nullptr;
+}
+
+Oid CommitGraph::oid(quint32 position) const
+{
+    auto layer = layerOf(position);
+    if (!layer)
+        return {};
+
+    git_oid oid;
+    git_oid_fromraw(&oid, layer->oids + (position - layer->base) * rawOidSize);
+    return Oid{oid};
+}
+
+Oid CommitGraph::tree(quint32 position) const
+{
+    auto data = commitDataOf(position);
+    if (!data)
+        return {};
+
+    git_oid oid;
+    git_oid_fromraw(&oid, data);
+    return Oid{oid};
+}
+
+qint64 CommitGraph::commitTime(quint32 position) const
+{
+    auto data = commitDataOf(position);
+    if (!data)
+        return 0;
+    return (qint64(be32(data + rawOidSize + 8) & 0x3) << 32) | be32(data + rawOidSize + 12);
+}
+
+quint32 CommitGraph::generation(quint32 position) const
+{
+    auto data = commitDataOf(position);
+    return data ? be32(data + rawOidSize + 8) >> 2 : 0;
+}
+
+void CommitGraph::parents(quint32 position, QVarLengthArray<quint32, 2> &out) const
+{
+    out.clear();
+
+    auto layer = layerOf(position);
+    if (!layer)
+        return;
+
+    const auto data = layer->commitData + (position - layer->base) * commitDataSize;
+    const auto first = be32(data + rawOidSize);
+    const auto second = be32(data + rawOidSize + 4);
+
+    if (first == parentNone || first >= mSize)
+        return;
+    out.append(first);
+
+    if (second == parentNone)
+        return;
+
+    if (!(second & extraEdgesNeeded)) {
+        if (second < mSize)
+            out.append(second);
+        return;
+    }
+
+    for (auto edge = second & edgeMask; edge < layer->extraEdgeCount; ++edge) {
+        const auto value = be32(layer->extraEdges + edge * 4);
+        if ((value & edgeMask) < mSize)
+            out.append(value & edgeMask);
+        if (value & lastEdge)
+            break;
+    }
+}
+
+bool CommitGraph::isAncestor(quint32 ancestor, quint32 descendant) const
+{
+    if (ancestor == descendant)
+        return true;
+
+    // a commit's level is always above the level of all its ancestors
+    const auto minGeneration = generation(ancestor);
+    const auto canSkip = [this, minGeneration](quint32 position) {
+        const auto g = generation(position);
+        return minGeneration && g && g <= minGeneration;
+    };
+
+    if (canSkip(descendant))
+        return false;
+
+    std::vector<bool> seen(mSize);
+    std::vector<quint32> stack{descendant};
+    QVarLengthArray<quint32, 2> list;
+
+    while (!stack.empty()) {
+        const auto position = stack.back();
+        stack.pop_back();
+
+        parents(position, list);
+        for (auto parent : list) {
+            if (parent == ancestor)
+                return true;
+            if (seen[parent] || canSkip(parent))
+                continue;
+            seen[parent] = true;
+            stack.push_back(parent);
+        }
+    }
+    return false;
+}
+
+QPair<int, int> CommitGraph::aheadBehind(quint32 local, quint32 upstream) const
+{
+    enum Flag : quint8 { Local = 1, Upstream = 2, Both = Local | Upstream };
+
+    if (local == upstream)
+        return qMakePair(0, 0);
+
+    // descendants are always visited before their ancestors, so a commit's flags are final when popped
+    const auto priority = [this](quint32 position) {
+        return (quint64(generation(position)) << 34) | quint64(commitTime(position));
+    };
+
+    QHash<quint32, quint8> flags;
+    std::priority_queue<std::pair<quint64, quint32>> queue;
+    int pending{0};
+
+    const auto mark = [&](quint32 position, quint8 flag) {
+        auto it = flags.find(position);
+        if (it == flags.end()) {
+            flags.insert(position, flag);
+            queue.emplace(priority(position), position);
+            if (flag != Both)
+                ++pending;
+        } else if ((*it | flag) != *it) {
+            *it |= flag;
+            if (*it == Both)
+                --pending;
+        }
+    };
+
+    mark(local, Local);
+    mark(upstream, Upstream);
+
+    int ahead{0};
+    int behind{0};
+    QVarLengthArray<quint32, 2> list;
+
+    // once everything left in the queue is reachable from both sides the rest of the history is shared
+    while (pending && !queue.empty()) {
+        const auto position = queue.top().second;
+        queue.pop();
+
+        const auto flag = flags.value(position);
+        if (flag == Local)
+            ++ahead;
+        else if (flag == Upstream)
+            ++behind;
+        if (flag != Both)
+            --pending;
+
+        parents(position, list);
+        for (auto parent : list)
+            mark(parent, flag);
+    }
+
+    return qMakePair(ahead, behind);
+}
+
+QList<quint32> CommitGraph::topologicalOrder(const QList<quint32> &tips, const QList<quint32> &hidden) const
+{
+    QList<quint32> order;
+    QVarLengthArray<quint32, 2> list;
+
+    std::vector<bool> uninteresting(mSize);
+    std::vector<quint32> stack;
+    for (auto position : hidden) {
+        if (position < mSize && !uninteresting[position]) {
+            uninteresting[position] = true;
+            stack.push_back(position);
+        }
+    }
+    while (!stack.empty()) {
+        const auto position = stack.back();
+        stack.pop_back();
+        parents(position, list);
+        for (auto parent : list) {
+            if (!uninteresting[parent]) {
+                uninteresting[parent] = true;
+                stack.push_back(parent);
+            }
+        }
+    }
+
+    // number of not yet emitted children, -1 for commits that are not part of the walk
+    std::vector<qint32> pendingChildren(mSize, -1);
+    for (auto position : tips) {
+        if (position < mSize && !uninteresting[position] && pendingChildren[position] == -1) {
+            pendingChildren[position] = 0;
+            stack.push_back(position);
+        }
+    }
+    while (!stack.empty()) {
+        const auto position = stack.back();
+        stack.pop_back();
+        parents(position, list);
+        for (auto parent : list) {
+            if (uninteresting[parent])
+                continue;
+            if (pendingChildren[parent] == -1) {
+                pendingChildren[parent] = 1;
+                stack.push_back(parent);
+            } else {
+                ++pendingChildren[parent];
+            }
+        }
+    }
+
+    std::priority_queue<std::pair<qint64, quint32>> queue;
+    for (auto position : tips)
+        if (position < mSize && pendingChildren[position] == 0) {
+            pendingChildren[position] = -1;
+            queue.emplace(commitTime(position), position);
+        }
+
+    while (!queue.empty()) {
+        const auto position = queue.top().second;
+        queue.pop();
+        order << position;
+
+        parents(position, list);
+        for (auto parent : list) {
+            if (uninteresting[parent] || pendingChildren[parent] <= 0)
+                continue;
+            if (!--pendingChildren[parent])
+                queue.emplace(commitTime(parent), parent);
+        }
+    }
+
+    return order;
+}
+
+bool CommitGraph::hasChangedPaths() const
+{
+    return mBloomHashCount != 0;
+}
+
+CommitGraph::PathKeys CommitGraph::pathKeys(const QByteArray &path) const
+{
+    PathKeys keys;
+    if (!mBloomHashCount)
+        return keys;
+
+    // the filters hold every changed file and all of its parent directories
+    auto prefix = path;
+    while (!prefix.isEmpty()) {
+        const auto hash0 = murmur3(bloomSeed0, prefix, mBloomHashVersion);
+        const auto hash1 = murmur3(bloomSeed1, prefix, mBloomHashVersion);
+        for (quint32 i = 0; i < mBloomHashCount; ++i)
+            keys << hash0 + i * hash1;
+
+        const auto slash = prefix.lastIndexOf('/');
+        if (slash < 0)
+            break;
+        prefix.truncate(slash);
+    }
+    return keys;
+}
+
+CommitGraph::PathChange CommitGraph::pathChanged(quint32 position, const PathKeys &keys) const
+{
+    auto layer = layerOf(position);
+    if (!layer || !layer->bloomIndex || keys.isEmpty())
+        return PathChange::Unknown;
+
+    const auto index = position - layer->base;
+    const auto begin = index ? be32(layer->bloomIndex + (index - 1) * 4) : 0;
+    const auto end = be32(layer->bloomIndex + index * 4);
+    // no filter was computed for this commit
+    if (end <= begin || end > layer->bloomDataSize)
+        return PathChange::Unknown;
+
+    const auto filter = layer->bloomData + begin;
+    const auto bitCount = (end - begin) * 8;
+    for (int i = 0; i < keys.size(); i += mBloomHashCount) {
+        for (quint32 j = 0; j < mBloomHashCount; ++j) {
+            const auto bit = keys.at(i + j) % bitCount;
+            if (!(filter[bit / 8] & (1 << (bit % 8))))
+                return PathChange::Unchanged;
+        }
+    }
+    return PathChange::MaybeChanged;
+}
+
+}
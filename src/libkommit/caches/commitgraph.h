@@ -0,0 +1,106 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVarLengthArray>
+#include <QVector>
+
+#include <vector>
+
+#include "entities/oid.h"
+#include "libkommit_export.h"
+
+class QFile;
+
+namespace Git
+{
+
+/**
+ * Reader for git's commit-graph file (objects/info/commit-graph or a commit-graphs chain).
+ *
+ * Gives parents, commit times and generation numbers of the commits it covers straight from
+ * the memory-mapped file, so history can be ordered and compared without inflating commit
+ * objects. Commits are addressed by their position in the graph; parents of a covered commit
+ * are always covered too. The file is written by `git commit-graph write`, commits created
+ * after that are not part of it.
+ *
+ * When the file was written with --changed-paths it also has a Bloom filter per commit of the
+ * paths that changed compared to the first parent, which lets path-limited walks skip most
+ * commits without reading a single tree.
+ */
+class LIBKOMMIT_EXPORT CommitGraph
+{
+public:
+    enum class PathChange {
+        Unknown,
+        Unchanged,
+        MaybeChanged,
+    };
+    using PathKeys = QVector<quint32>;
+
+    CommitGraph();
+    ~CommitGraph();
+
+    // Reloads when the files under infoPath (an objects/info/ directory) changed since the last call
+    bool refresh(const QString &infoPath);
+    void clear();
+
+    Q_REQUIRED_RESULT bool isValid() const;
+    Q_REQUIRED_RESULT quint32 size() const;
+
+    Q_REQUIRED_RESULT bool find(const Oid &oid, quint32 *position) const;
+    Q_REQUIRED_RESULT Oid oid(quint32 position) const;
+    Q_REQUIRED_RESULT Oid tree(quint32 position) const;
+    Q_REQUIRED_RESULT qint64 commitTime(quint32 position) const;
+    // Topological level; 0 if the file was written without generation numbers
+    Q_REQUIRED_RESULT quint32 generation(quint32 position) const;
+    void parents(quint32 position, QVarLengthArray<quint32, 2> &out) const;
+
+    Q_REQUIRED_RESULT bool isAncestor(quint32 ancestor, quint32 descendant) const;
+    // Number of commits only reachable from local, and only reachable from upstream
+    Q_REQUIRED_RESULT QPair<int, int> aheadBehind(quint32 local, quint32 upstream) const;
+    // Same order as a revwalk sorted by GIT_SORT_TOPOLOGICAL | GIT_SORT_TIME
+    Q_REQUIRED_RESULT QList<quint32> topologicalOrder(const QList<quint32> &tips, const QList<quint32> &hidden = {}) const;
+
+    Q_REQUIRED_RESULT bool hasChangedPaths() const;
+    // Filter hashes of path (relative to the work tree, no leading slash) and its directories
+    Q_REQUIRED_RESULT PathKeys pathKeys(const QByteArray &path) const;
+    // Whether the commit changed the path compared to its first parent, Unknown when it has no filter
+    Q_REQUIRED_RESULT PathChange pathChanged(quint32 position, const PathKeys &keys) const;
+
+private:
+    struct Layer {
+        QFile *file{nullptr};
+        const uchar *fanout{nullptr};
+        const uchar *oids{nullptr};
+        const uchar *commitData{nullptr};
+        const uchar *extraEdges{nullptr};
+        quint32 extraEdgeCount{0};
+        const uchar *bloomIndex{nullptr};
+        const uchar *bloomData{nullptr};
+        quint32 bloomDataSize{0};
+        quint32 count{0};
+        // position of the first commit of this layer
+        quint32 base{0};
+    };
+
+    bool loadLayer(const QString &fileName);
+    const Layer *layerOf(quint32 position) const;
+    const uchar *commitDataOf(quint32 position) const;
+
+    std::vector<Layer> mLayers;
+    QString mInfoPath;
+    QString mSignature;
+    quint32 mSize{0};
+    quint32 mBloomHashVersion{0};
+    quint32 mBloomHashCount{0};
+};
+
+}
@@ -0,0 +1,393 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "commitindex.h"
+#include "caches/stringpool.h"
+#include "entities/commit.h"
+#include "entities/commit_p.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QVarLengthArray>
+
+#include <git2/oid.h>
+#include <git2/repository.h>
+
+#include <cstring>
+
+namespace Git
+{
+
+namespace
+{
+
+constexpr char indexMagic[4] = {'K', 'C', 'I', 'X'};
+constexpr quint32 indexVersion = 1;
+constexpr int rawOidSize = 20;
+
+struct IndexHeader {
+    char magic[4];
+    quint32 version;
+    quint32 tipCount;
+    quint32 commitCount;
+    quint32 linkCount;
+    // parents that are not part of the index themselves (shallow clones)
+    quint32 extraOidCount;
+    quint32 stringsSize;
+    quint32 extensionCount;
+};
+
+struct IndexRecord {
+    qint64 commitTime;
+    qint32 authorTimeDelta;
+    qint16 commitTimeOffset;
+    qint16 authorTimeOffset;
+    quint32 subject;
+    quint32 author;
+    quint32 committer;
+    quint32 firstLink;
+    quint32 parentCount;
+};
+
+class Reader
+{
+public:
+    Reader(const uchar *data, qint64 size)
+        : mData{data}
+        , mSize{size}
+    {
+    }
+
+    const uchar *take(qint64 length)
+    {
+        if (length < 0 || mPos + length > mSize)
+            return nullptr;
+        auto p = mData + mPos;
+        mPos += length;
+        return p;
+    }
+
+    template<typename T>
+    bool read(T *out)
+    {
+        auto p = take(sizeof(T));
+        if (!p)
+            return false;
+        std::memcpy(out, p, sizeof(T));
+        return true;
+    }
+
+private:
+    const uchar *mData;
+    qint64 mSize;
+    qint64 mPos{0};
+};
+
+Oid readOid(const uchar *raw)
+{
+    git_oid oid;
+    git_oid_fromraw(&oid, raw);
+    return Oid{oid};
+}
+
+void appendOid(QByteArray &buffer, const Oid &oid)
+{
+    buffer.append(reinterpret_cast<const char *>(oid.oidPtr()->id), rawOidSize);
+}
+
+template<typename T>
+void appendValue(QByteArray &buffer, const T &value)
+{
+    buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+}
+
+CommitIndex::CommitIndex(git_repository *repo)
+    : mRepo{repo}
+    , mPool{StringPool::of(repo)}
+{
+}
+
+QString CommitIndex::path() const
+{
+    return QString::fromUtf8(git_repository_path(mRepo)) + QStringLiteral("kommit/commits.idx");
+}
+
+bool CommitIndex::load()
+{
+    mTips.clear();
+    mCommits.clear();
+    mExtensions.clear();
+
+    QFile file{path()};
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const auto size = file.size();
+    auto data = file.map(0, size);
+    if (!data)
+        return false;
+
+    auto ok = parse(data, size);
+    file.unmap(data);
+
+    if (!ok) {
+        mTips.clear();
+        mCommits.clear();
+        mExtensions.clear();
+    }
+    return ok;
+}
+
+bool CommitIndex::parse(const uchar *data, qint64 size)
+{
+    Reader reader{data, size};
+
+    IndexHeader header;
+    if (!reader.read(&header) || std::memcmp(header.magic, indexMagic, sizeof(indexMagic)) || header.version != indexVersion)
+        return false;
+
+    auto tips = reader.take(qint64(header.tipCount) * rawOidSize);
+    auto oids = reader.take(qint64(header.commitCount) * rawOidSize);
+    auto records = reader.take(qint64(header.commitCount) * sizeof(IndexRecord));
+    auto links = reader.take(qint64(header.linkCount) * sizeof(quint32));
+    auto extraOids = reader.take(qint64(header.extraOidCount) * rawOidSize);
+    auto strings = reader.take(header.stringsSize);
+    if (!tips || !oids || !records || !links || !extraOids || !strings)
+        return false;
+
+    for (quint32 i = 0; i < header.tipCount; ++i)
+        mTips << readOid(tips + i * rawOidSize);
+
+    // file offsets are translated to pool offsets once per distinct string
+    QHash<quint32, quint32> poolOffsets;
+    bool stringsOk{true};
+    auto internString = [&](quint32 offset) -> quint32 {
+        auto it = poolOffsets.constFind(offset);
+        if (it != poolOffsets.cend())
+            return *it;
+
+        quint32 length;
+        if (qint64(offset) + sizeof(length) > header.stringsSize) {
+            stringsOk = false;
+            return 0;
+        }
+        std::memcpy(&length, strings + offset, sizeof(length));
+        if (qint64(offset) + sizeof(length) + length > header.stringsSize) {
+            stringsOk = false;
+            return 0;
+        }
+
+        auto poolOffset = mPool->intern(reinterpret_cast<const char *>(strings + offset + sizeof(length)), static_cast<int>(length));
+        poolOffsets.insert(offset, poolOffset);
+        return poolOffset;
+    };
+
+    QList<Oid> ids;
+    ids.reserve(header.commitCount);
+    for (quint32 i = 0; i < header.commitCount; ++i)
+        ids << readOid(oids + i * rawOidSize);
+
+    mCommits.reserve(header.commitCount);
+    QVarLengthArray<Oid, 4> parents;
+    for (quint32 i = 0; i < header.commitCount; ++i) {
+        IndexRecord record;
+        std::memcpy(&record, records + i * sizeof(IndexRecord), sizeof(IndexRecord));
+
+        if (qint64(record.firstLink) + record.parentCount > header.linkCount)
+            return false;
+
+        parents.clear();
+        for (quint32 j = 0; j < record.parentCount; ++j) {
+            quint32 link;
+            std::memcpy(&link, links + (record.firstLink + j) * sizeof(quint32), sizeof(link));
+            if (link < header.commitCount)
+                parents.append(ids.at(link));
+            else if (link - header.commitCount < header.extraOidCount)
+                parents.append(readOid(extraOids + (link - header.commitCount) * rawOidSize));
+            else
+                return false;
+        }
+
+        auto d = new CommitPrivate{mRepo, ids.at(i), mPool.data()};
+        d->commitTime = record.commitTime;
+        d->authorTimeDelta = record.authorTimeDelta;
+        d->commitTimeOffset = record.commitTimeOffset;
+        d->authorTimeOffset = record.authorTimeOffset;
+        d->subject = internString(record.subject);
+        d->author = internString(record.author);
+        d->committer = internString(record.committer);
+        d->setParents(parents.constData(), parents.size());
+
+        mCommits << QSharedPointer<Commit>{new Commit{d}};
+
+        if (!stringsOk)
+            return false;
+    }
+
+    for (quint32 i = 0; i < header.extensionCount; ++i) {
+        quint32 nameLength;
+        quint32 dataLength;
+        const uchar *name;
+        const uchar *extensionData;
+        if (!reader.read(&nameLength) || !(name = reader.take(nameLength)) || !reader.read(&dataLength) || !(extensionData = reader.take(dataLength)))
+            return false;
+
+        mExtensions.insert(QByteArray{reinterpret_cast<const char *>(name), static_cast<int>(nameLength)},
+                           QByteArray{reinterpret_cast<const char *>(extensionData), static_cast<int>(dataLength)});
+    }
+
+    return true;
+}
+
+bool CommitIndex::save() const
+{
+    const auto filePath = path();
+    if (!QDir{}.mkpath(QFileInfo{filePath}.absolutePath()))
+        return false;
+
+    const auto commitCount = static_cast<quint32>(mCommits.size());
+
+    QHash<Oid, quint32> indexByOid;
+    indexByOid.reserve(mCommits.size());
+    for (quint32 i = 0; i < commitCount; ++i)
+        indexByOid.insert(mCommits.at(i)->oid(), i);
+
+    QByteArray oids;
+    QByteArray records;
+    QByteArray links;
+    QByteArray extraOids;
+    QByteArray strings;
+    oids.reserve(mCommits.size() * rawOidSize);
+    records.reserve(mCommits.size() * sizeof(IndexRecord));
+
+    // commits created before a reset of the manager's caches have their strings in an older pool
+    QHash<QPair<const StringPool *, quint32>, quint32> stringOffsets;
+    auto addString = [&](const StringPool *pool, quint32 poolOffset) -> quint32 {
+        const auto key = qMakePair(pool, poolOffset);
+        auto it = stringOffsets.constFind(key);
+        if (it != stringOffsets.cend())
+            return *it;
+
+        const auto value = pool->value(poolOffset);
+        const auto offset = static_cast<quint32>(strings.size());
+        appendValue(strings, static_cast<quint32>(value.size()));
+        strings.append(value);
+        stringOffsets.insert(key, offset);
+        return offset;
+    };
+
+    QHash<Oid, quint32> extraIndex;
+    quint32 linkCount{0};
+    for (const auto &commit : mCommits) {
+        auto d = commit->d_ptr;
+
+        IndexRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.commitTime = d->commitTime;
+        record.authorTimeDelta = d->authorTimeDelta;
+        record.commitTimeOffset = d->commitTimeOffset;
+        record.authorTimeOffset = d->authorTimeOffset;
+        record.subject = addString(d->pool.data(), d->subject);
+        record.author = addString(d->pool.data(), d->author);
+        record.committer = addString(d->pool.data(), d->committer);
+        record.firstLink = linkCount;
+        record.parentCount = d->parentCount;
+
+        for (quint16 i = 0; i < d->parentCount; ++i) {
+            const auto &parent = d->links[i];
+            auto link = indexByOid.value(parent, commitCount);
+            if (link == commitCount) {
+                auto it = extraIndex.constFind(parent);
+                if (it == extraIndex.cend()) {
+                    it = extraIndex.insert(parent, static_cast<quint32>(extraIndex.size()));
+                    appendOid(extraOids, parent);
+                }
+                link = commitCount + *it;
+            }
+            appendValue(links, link);
+            ++linkCount;
+        }
+
+        appendOid(oids, commit->oid());
+        appendValue(records, record);
+    }
+
+    IndexHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, indexMagic, sizeof(indexMagic));
+    header.version = indexVersion;
+    header.tipCount = static_cast<quint32>(mTips.size());
+    header.commitCount = commitCount;
+    header.linkCount = linkCount;
+    header.extraOidCount = static_cast<quint32>(extraIndex.size());
+    header.stringsSize = static_cast<quint32>(strings.size());
+    header.extensionCount = static_cast<quint32>(mExtensions.size());
+
+    QSaveFile file{filePath};
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QByteArray head;
+    appendValue(head, header);
+    for (const auto &tip : mTips)
+        appendOid(head, tip);
+
+    file.write(head);
+    file.write(oids);
+    file.write(records);
+    file.write(links);
+    file.write(extraOids);
+    file.write(strings);
+
+    for (auto i = mExtensions.constBegin(); i != mExtensions.constEnd(); ++i) {
+        QByteArray extension;
+        appendValue(extension, static_cast<quint32>(i.key().size()));
+        extension.append(i.key());
+        appendValue(extension, static_cast<quint32>(i.value().size()));
+        extension.append(i.value());
+        file.write(extension);
+    }
+
+    return file.commit();
+}
+
+const QList<Oid> &CommitIndex::tips() const
+{
+    return mTips;
+}
+
+void CommitIndex::setTips(const QList<Oid> &tips)
+{
+    mTips = tips;
+}
+
+const QList<QSharedPointer<Commit>> &CommitIndex::commits() const
+{
+    return mCommits;
+}
+
+void CommitIndex::setCommits(const QList<QSharedPointer<Commit>> &commits)
+{
+    mCommits = commits;
+    mExtensions.clear();
+}
+
+QByteArray CommitIndex::extension(const QByteArray &name) const
+{
+    return mExtensions.value(name);
+}
+
+void CommitIndex::setExtension(const QByteArray &name, const QByteArray &data)
+{
+    mExtensions.insert(name, data);
+}
+
+}
@@ -0,0 +1,64 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QSharedPointer>
+#include <QString>
+
+#include <git2/types.h>
+
+#include "caches/stringpool.h"
+#include "entities/oid.h"
+#include "libkommit_export.h"
+
+namespace Git
+{
+
+class Commit;
+
+/**
+ * Sidecar file in <gitdir>/kommit/ holding the topologically sorted history of all branches.
+ *
+ * The file stores the branch tips it was built from, one fixed size record per commit with
+ * parent indices, times and offsets into a deduplicated string table, and named extension
+ * blobs for data derived from the commit list (e.g. the graph lanes). It is memory-mapped
+ * when loaded. Extensions are dropped whenever the commit list changes.
+ */
+class LIBKOMMIT_NO_EXPORT CommitIndex
+{
+public:
+    explicit CommitIndex(git_repository *repo);
+
+    Q_REQUIRED_RESULT QString path() const;
+
+    bool load();
+    bool save() const;
+
+    Q_REQUIRED_RESULT const QList<Oid> &tips() const;
+    void setTips(const QList<Oid> &tips);
+
+    Q_REQUIRED_RESULT const QList<QSharedPointer<Commit>> &commits() const;
+    void setCommits(const QList<QSharedPointer<Commit>> &commits);
+
+    Q_REQUIRED_RESULT QByteArray extension(const QByteArray &name) const;
+    void setExtension(const QByteArray &name, const QByteArray &data);
+
+private:
+    bool parse(const uchar *data, qint64 size);
+
+    git_repository *mRepo;
+    // strings of the commits read from the file
+    StringPoolPointer mPool;
+    QList<Oid> mTips;
+    QList<QSharedPointer<Commit>> mCommits;
+    QMap<QByteArray, QByteArray> mExtensions;
+};
+
+}
@@ -5,6 +5,8 @@ SPDX-License-Identifier: GPL-3.0-or-later
 */
 
 #include "commitscache.h"
+#include "caches/commitgraph.h"
+#include "caches/commitindex.h"
 #include "caches/referencecache.h"
 #include "entities/branch.h"
 #include "entities/commit.h"
@@ -12,29 +14,73 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "gitmanager.h"
 #include "types.h"
 
+#include <git2/branch.h>
 #include <git2/commit.h>
+#include <git2/graph.h>
+#include <git2/oid.h>
+#include <git2/refs.h>
 #include <git2/revparse.h>
 
+#include <algorithm>
+
 namespace Git
 {
 
+namespace
+{
+
+QList<Oid> branchTips(git_repository *repo)
+{
+    QList<Oid> tips;
+
+    git_branch_iterator *it;
+    if (git_branch_iterator_new(&it, repo, GIT_BRANCH_ALL))
+        return tips;
+
+    git_reference *ref;
+    git_branch_t type;
+    while (!git_branch_next(&ref, &type, it)) {
+        git_oid oid;
+        if (!git_reference_name_to_id(&oid, repo, git_reference_name(ref)))
+            tips << Oid{oid};
+        git_reference_free(ref);
+    }
+    git_branch_iterator_free(it);
+
+    std::sort(tips.begin(), tips.end());
+    tips.erase(std::unique(tips.begin(), tips.end()), tips.end());
+    return tips;
+}
+
+}
+
 CommitsCache::CommitsCache(Manager *parent)
-    : Git::OidCache<Commit, git_commit>{parent, git_commit_lookup}
+    : Git::OidCache<Commit, git_commit>{parent, git_commit_lookup, git_commit_id, git_commit_free}
+    , mChanges{this, [this](const ChangeSet &changes) {
+                   Q_EMIT changed(changes);
+               }}
 {
 }
 
+CommitsCache::~CommitsCache() = default;
+
 QSharedPointer<Commit> CommitsCache::find(const QString &hash)
 {
-    git_commit *commit;
+    // full hashes are by far the most common input, so skip revparse for them
+    git_oid oid;
+    if (hash.size() == GIT_OID_HEXSZ && !git_oid_fromstr(&oid, hash.toLatin1().constData()))
+        return findByOid(&oid);
+
     git_object *commitObject;
     BEGIN
     STEP git_revparse_single(&commitObject, manager->repoPtr(), hash.toLatin1().constData());
-    STEP git_commit_lookup(&commit, manager->repoPtr(), git_object_id(commitObject));
 
-    if (IS_OK)
-        return Cache::findByPtr(commit);
+    if (IS_ERROR)
+        return QSharedPointer<Commit>{};
 
-    return QSharedPointer<Commit>{};
+    auto commit = findByOid(git_object_id(commitObject));
+    git_object_free(commitObject);
+    return commit;
 }
 
 QList<QSharedPointer<Commit>> CommitsCache::allCommits()
@@ -44,49 +90,154 @@ QList<QSharedPointer<Commit>> CommitsCache::allCommits()
     if (!manager->isValid())
         return list;
 
-    git_revwalk *walker;
-    git_oid oid;
+    auto repo = manager->repoPtr();
+    auto graph = manager->commitGraph();
+    const auto tips = branchTips(repo);
 
-    BEGIN
-    STEP git_revwalk_new(&walker, manager->repoPtr());
-    STEP git_revwalk_sorting(walker, GIT_SORT_TOPOLOGICAL | GIT_SORT_TIME);
-    // STEP git_revwalk_push_head(walker);
+    // positions in the commit-graph, only usable if every tip is covered by it
+    const auto graphPositions = [graph](const QList<Oid> &oids, QList<quint32> *positions) {
+        if (!graph->isValid())
+            return false;
+        quint32 position;
+        for (const auto &oid : oids) {
+            if (!graph->find(oid, &position))
+                return false;
+            *positions << position;
+        }
+        return true;
+    };
+    const auto isDescendantOf = [graph, repo](const Oid &commit, const Oid &ancestor) {
+        quint32 commitPosition;
+        quint32 ancestorPosition;
+        if (graph->isValid() && graph->find(commit, &commitPosition) && graph->find(ancestor, &ancestorPosition))
+            return graph->isAncestor(ancestorPosition, commitPosition);
+        return git_graph_descendant_of(repo, commit.oidPtr(), ancestor.oidPtr()) == 1;
+    };
 
-    // include all branches
-    git_reference *ref;
-    git_branch_iterator *it;
-    git_branch_t b;
+    mIndex.reset(new CommitIndex{repo});
+    auto indexed = mIndex->load();
+    const auto hadHistory = indexed;
+    const auto changed = !indexed || mIndex->tips() != tips;
 
-    git_branch_iterator_new(&it, manager->repoPtr(), GIT_BRANCH_ALL);
+    // the index can only be extended if every commit in it is still reachable, otherwise
+    // (e.g. after a rebase or a deleted branch) the history is walked from scratch
+    QList<Oid> hidden;
+    if (indexed && changed) {
+        for (const auto &oldTip : mIndex->tips()) {
+            auto reachable = std::binary_search(tips.cbegin(), tips.cend(), oldTip);
+            for (auto it = tips.cbegin(); !reachable && it != tips.cend(); ++it)
+                reachable = isDescendantOf(*it, oldTip);
 
-    while (!git_branch_next(&ref, &b, it)) {
-        auto refname = git_reference_name(ref);
-        git_revwalk_push_ref(walker, refname);
+            if (!reachable) {
+                indexed = false;
+                break;
+            }
+            hidden << oldTip;
+        }
     }
-    git_branch_iterator_free(it);
 
-    if (IS_ERROR)
-        return list;
+    QList<quint32> tipPositions;
+    QList<quint32> hiddenPositions;
+    if (changed && graphPositions(tips, &tipPositions) && (!indexed || graphPositions(hidden, &hiddenPositions))) {
+        // the order comes straight from the commit-graph, commits are only parsed once to create the entities
+        const auto order = graph->topologicalOrder(tipPositions, hiddenPositions);
+        list.reserve(order.size());
+        for (auto position : order) {
+            auto en = findByOid(graph->oid(position));
+            if (en)
+                list << en;
+        }
+    } else if (changed) {
+        git_revwalk *walker{nullptr};
+        git_oid oid;
 
-    while (!git_revwalk_next(&oid, walker)) {
-        auto en = findByOid(&oid);
-        en->clearChildren();
-        list << en;
+        BEGIN
+        STEP git_revwalk_new(&walker, repo);
+        STEP git_revwalk_sorting(walker, GIT_SORT_TOPOLOGICAL | GIT_SORT_TIME);
+
+        for (const auto &tip : tips)
+            STEP git_revwalk_push(walker, tip.oidPtr());
+        if (indexed)
+            for (const auto &oldTip : hidden)
+                STEP git_revwalk_hide(walker, oldTip.oidPtr());
+
+        if (IS_ERROR) {
+            git_revwalk_free(walker);
+            return list;
+        }
+
+        while (!git_revwalk_next(&oid, walker)) {
+            auto en = findByOid(&oid);
+            if (en)
+                list << en;
+        }
+        git_revwalk_free(walker);
+    }
+
+    const auto walkedCount = list.size();
+
+    // new commits can't be ancestors of indexed ones, so putting them first keeps the order topological
+    if (indexed) {
+        list.reserve(list.size() + mIndex->commits().size());
+        for (const auto &commit : mIndex->commits()) {
+            if (auto cached = value(commit->oid())) {
+                list << cached;
+            } else {
+                insert(commit->oid().oidPtr(), commit);
+                list << commit;
+            }
+        }
+    }
+
+    OidHashMap<int> indexByOid;
+    indexByOid.reserve(list.size());
+    for (auto &commit : list) {
+        commit->clearChildren();
+        indexByOid.insert(commit->oid(), indexByOid.size());
     }
 
+    // every parent of a walked commit is walked too, so children can be resolved without lookups
     for (auto &commit : list) {
-        for (auto const &parentHash : commit->parents()) {
-            auto parent = find(parentHash);
-            parent->addChild(commit->commitHash());
+        for (int i = 0; i < commit->parentCount(); ++i) {
+            if (auto parentIndex = indexByOid.find(commit->parentOid(i)))
+                list.at(*parentIndex)->addChild(commit->oid());
         }
         commit->setReferences(manager->references()->findForCommit(commit));
     }
 
-    git_revwalk_free(walker);
+    if (changed && hadHistory) {
+        if (indexed) {
+            for (int i = 0; i < walkedCount; ++i)
+                mChanges.insert(list.at(i));
+        } else {
+            // walked from scratch, the old history is still loaded in the index
+            OidHashMap<int> previous;
+            for (const auto &commit : mIndex->commits())
+                previous.insert(commit->oid(), 0);
+            for (const auto &commit : std::as_const(list))
+                if (!previous.contains(commit->oid()))
+                    mChanges.insert(commit);
+            for (const auto &commit : mIndex->commits())
+                if (!indexByOid.contains(commit->oid()))
+                    mChanges.remove(commit);
+        }
+    }
+
+    if (changed) {
+        mIndex->setCommits(list);
+        mIndex->setTips(tips);
+        mIndex->save();
+    }
+
     return list;
 }
 
 QList<QSharedPointer<Commit>> CommitsCache::commitsInBranch(QSharedPointer<Branch> branch)
+{
+    return commitsInBranch(branch->refName());
+}
+
+QList<QSharedPointer<Commit>> CommitsCache::commitsInBranch(const QString &refName)
 {
     PointerList<Commit> list;
 
@@ -97,8 +248,7 @@ QList<QSharedPointer<Commit>> CommitsCache::commitsInBranch(QSharedPointer<Branc
     STEP git_revwalk_new(&walker, manager->repoPtr());
     STEP git_revwalk_sorting(walker, GIT_SORT_TOPOLOGICAL);
 
-    auto refName = git_reference_name(branch->refPtr());
-    STEP git_revwalk_push_ref(walker, refName);
+    STEP git_revwalk_push_ref(walker, refName.toUtf8().constData());
 
     if (IS_ERROR)
         return list;
@@ -110,8 +260,28 @@ QList<QSharedPointer<Commit>> CommitsCache::commitsInBranch(QSharedPointer<Branc
     return list;
 }
 
+QByteArray CommitsCache::indexExtension(const QByteArray &name) const
+{
+    return mIndex ? mIndex->extension(name) : QByteArray{};
+}
+
+void CommitsCache::setIndexExtension(const QByteArray &name, const QByteArray &data)
+{
+    if (!mIndex)
+        return;
+
+    mIndex->setExtension(name, data);
+    mIndex->save();
+}
+
 void CommitsCache::clearChildData()
 {
+    mIndex.reset();
+}
+
+qint64 CommitsCache::cost(const Commit &commit) const
+{
+    return sizeof(Commit) + commit.memoryUsage();
 }
 };
 
@@ -7,8 +7,10 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
 
 #include <QObject>
+#include <QScopedPointer>
 
 #include "abstractcache.h"
+#include "changeset.h"
 #include "entities/commit.h"
 #include "libkommit_export.h"
 
@@ -18,24 +20,41 @@ namespace Git
 {
 
 class Branch;
+class CommitIndex;
 
 class LIBKOMMIT_EXPORT CommitsCache : public QObject, public OidCache<Commit, git_commit>
 {
     Q_OBJECT
 
 public:
+    using ChangeSet = Git::ChangeSet<DataMember>;
+
     explicit CommitsCache(Manager *parent);
+    ~CommitsCache();
 
     Q_REQUIRED_RESULT QSharedPointer<Commit> find(const QString &hash);
 
     Q_REQUIRED_RESULT QList<QSharedPointer<Commit>> allCommits();
     Q_REQUIRED_RESULT QList<QSharedPointer<Commit>> commitsInBranch(QSharedPointer<Branch> branch);
+    // Same as above by the full name of the branch reference, for threads that do not own the branch
+    Q_REQUIRED_RESULT QList<QSharedPointer<Commit>> commitsInBranch(const QString &refName);
+
+    // Data derived from the result of allCommits() that is stored next to the commit index and
+    // invalidated together with it
+    Q_REQUIRED_RESULT QByteArray indexExtension(const QByteArray &name) const;
+    void setIndexExtension(const QByteArray &name, const QByteArray &data);
 
 protected:
     void clearChildData() override;
+    qint64 cost(const Commit &commit) const override;
+
+private:
+    QScopedPointer<CommitIndex> mIndex;
+    ChangeSetCollector<DataMember> mChanges;
 
 Q_SIGNALS:
-    void added(DataMember commit);
-    void removed(DataMember commit);
+    // Commits allCommits() found or lost compared to the history it returned before (none for
+    // the first history of a repository), once per event loop turn
+    void changed(const Git::CommitsCache::ChangeSet &changes);
 };
 }
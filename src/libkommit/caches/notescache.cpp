@@ -17,15 +17,25 @@ SPDX-License-Identifier: GPL-3.0-or-later
 namespace Git
 {
 
+namespace
+{
+
+// notes are keyed by the annotated object rather than by their own blob id
+int noteLookup(git_note **out, git_repository *repo, const git_oid *oid)
+{
+    return git_note_read(out, repo, NULL, oid);
+}
+
+}
+
 NotesCache::NotesCache(Manager *parent)
-    : Cache<Note, git_note>{parent}
+    : OidCache<Note, git_note>{parent, noteLookup, nullptr, git_note_free}
 {
 }
 
 NotesCache::DataList NotesCache::allNotes()
 {
     struct wrapper {
-        git_repository *repo;
         NotesCache *notesCache;
         DataList notes;
     };
@@ -33,27 +43,16 @@ NotesCache::DataList NotesCache::allNotes()
         Q_UNUSED(blob_id);
 
         auto w = reinterpret_cast<wrapper *>(payload);
-        git_note *note;
-        if (!git_note_read(&note, w->repo, NULL, annotated_object_id))
-            w->notes << w->notesCache->findByPtr(note);
+        if (auto note = w->notesCache->findByOid(annotated_object_id))
+            w->notes << note;
         return 0;
     };
     wrapper w;
     w.notesCache = this;
-    w.repo = manager->repoPtr();
     git_note_foreach(manager->repoPtr(), NULL, cb, &w);
     return w.notes;
 }
 
-NotesCache::DataMember NotesCache::findByOid(const git_oid *oid)
-{
-    git_note *note;
-    if (git_note_read(&note, manager->repoPtr(), NULL, oid))
-        return {};
-
-    return findByPtr(note);
-}
-
 void NotesCache::clearChildData()
 {
 }
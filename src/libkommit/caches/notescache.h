@@ -20,15 +20,18 @@ namespace Git
 
 class Oid;
 
-class LIBKOMMIT_EXPORT NotesCache : public Cache<Note, git_note>
+class LIBKOMMIT_EXPORT NotesCache : public OidCache<Note, git_note>
 {
 public:
     explicit NotesCache(Manager *parent);
 
     Q_REQUIRED_RESULT DataList allNotes();
-    Q_REQUIRED_RESULT DataMember findByOid(const git_oid *oid);
 
 protected:
     void clearChildData() override;
+
+private:
+    // a note is keyed by the object it annotates, which cannot be told from the git_note
+    using OidCache<Note, git_note>::findByPtr;
 };
 };
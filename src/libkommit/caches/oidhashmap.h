@@ -0,0 +1,202 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QtGlobal>
+
+#include <utility>
+#include <vector>
+
+#include <git2/oid.h>
+
+#include "entities/oid.h"
+
+namespace Git
+{
+
+/**
+ * Flat open-addressing hash map keyed by object id.
+ *
+ * Uses linear probing over a power-of-two table and backward-shift deletion, so there are no
+ * tombstones and lookups never touch more than one contiguous run of slots.
+ */
+template<class T>
+class OidHashMap
+{
+public:
+    OidHashMap() = default;
+
+    Q_REQUIRED_RESULT int size() const
+    {
+        return mSize;
+    }
+
+    Q_REQUIRED_RESULT bool isEmpty() const
+    {
+        return !mSize;
+    }
+
+    Q_REQUIRED_RESULT T *find(const git_oid *key)
+    {
+        auto i = indexOf(key);
+        return i == npos ? nullptr : &mSlots[i].value;
+    }
+
+    Q_REQUIRED_RESULT const T *find(const git_oid *key) const
+    {
+        auto i = indexOf(key);
+        return i == npos ? nullptr : &mSlots[i].value;
+    }
+
+    Q_REQUIRED_RESULT bool contains(const git_oid *key) const
+    {
+        return indexOf(key) != npos;
+    }
+
+    // Returns false and leaves the map untouched if the key is already present
+    bool insert(const git_oid *key, T value)
+    {
+        if (static_cast<size_t>(mSize + 1) * 10 > mSlots.size() * 7)
+            rehash(mSlots.empty() ? 16 : mSlots.size() * 2);
+
+        auto i = bucket(key);
+        while (mSlots[i].used) {
+            if (git_oid_equal(&mSlots[i].key, key))
+                return false;
+            i = (i + 1) & mMask;
+        }
+
+        git_oid_cpy(&mSlots[i].key, key);
+        mSlots[i].value = std::move(value);
+        mSlots[i].used = true;
+        ++mSize;
+        return true;
+    }
+
+    bool remove(const git_oid *key)
+    {
+        auto i = indexOf(key);
+        if (i == npos)
+            return false;
+
+        auto j = i;
+        for (;;) {
+            j = (j + 1) & mMask;
+            if (!mSlots[j].used)
+                break;
+
+            // move the entry back if its probe sequence passes over the hole
+            const auto k = bucket(&mSlots[j].key);
+            if (i <= j ? (k <= i || k > j) : (k <= i && k > j)) {
+                mSlots[i] = std::move(mSlots[j]);
+                i = j;
+            }
+        }
+
+        mSlots[i].used = false;
+        mSlots[i].value = T{};
+        --mSize;
+        return true;
+    }
+
+    void clear()
+    {
+        mSlots.clear();
+        mMask = 0;
+        mSize = 0;
+    }
+
+    void reserve(int count)
+    {
+        size_t capacity{16};
+        while (capacity * 7 < static_cast<size_t>(count) * 10)
+            capacity *= 2;
+        if (capacity > mSlots.size())
+            rehash(capacity);
+    }
+
+    Q_REQUIRED_RESULT T *find(const Oid &key)
+    {
+        return find(key.oidPtr());
+    }
+
+    Q_REQUIRED_RESULT const T *find(const Oid &key) const
+    {
+        return find(key.oidPtr());
+    }
+
+    Q_REQUIRED_RESULT bool contains(const Oid &key) const
+    {
+        return contains(key.oidPtr());
+    }
+
+    bool insert(const Oid &key, T value)
+    {
+        return insert(key.oidPtr(), std::move(value));
+    }
+
+    bool remove(const Oid &key)
+    {
+        return remove(key.oidPtr());
+    }
+
+    template<class Func>
+    void forEach(Func callback) const
+    {
+        for (const auto &slot : mSlots)
+            if (slot.used)
+                callback(&slot.key, slot.value);
+    }
+
+private:
+    struct Slot {
+        git_oid key;
+        T value{};
+        bool used{false};
+    };
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    size_t bucket(const git_oid *key) const
+    {
+        return Impl::oidHash(key) & mMask;
+    }
+
+    size_t indexOf(const git_oid *key) const
+    {
+        if (!mSize)
+            return npos;
+
+        auto i = bucket(key);
+        while (mSlots[i].used) {
+            if (git_oid_equal(&mSlots[i].key, key))
+                return i;
+            i = (i + 1) & mMask;
+        }
+        return npos;
+    }
+
+    void rehash(size_t capacity)
+    {
+        std::vector<Slot> old;
+        old.swap(mSlots);
+
+        mSlots.resize(capacity);
+        mMask = capacity - 1;
+        mSize = 0;
+
+        for (auto &slot : old)
+            if (slot.used)
+                insert(&slot.key, std::move(slot.value));
+    }
+
+    std::vector<Slot> mSlots;
+    size_t mMask{0};
+    int mSize{0};
+};
+
+}
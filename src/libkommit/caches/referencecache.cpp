@@ -31,7 +31,7 @@ public:
     ReferenceCachePrivate(ReferenceCache *parent);
 
     QList<QSharedPointer<Reference>> list;
-    QMultiMap<QSharedPointer<Commit>, QSharedPointer<Reference>> dataByCommit;
+    QMultiHash<Oid, QSharedPointer<Reference>> dataByCommit;
     void fill();
 };
 
@@ -118,7 +118,7 @@ ReferenceCache::DataList ReferenceCache::findForCommit(QSharedPointer<Commit> co
     if (!mList.size())
         fill();
 
-    return d->dataByCommit.values(commit);
+    return d->dataByCommit.values(commit->oid());
 }
 
 void ReferenceCache::forEach(std::function<void(DataMember)> callback) const
@@ -172,10 +172,11 @@ void ReferenceCachePrivate::fill()
     while (!git_reference_next(&reference, iterator)) {
         auto ref = q->findByPtr(reference);
         list << ref;
-        auto hash = ref->target()->toString();
-        auto commit = q->manager->commits()->find(hash);
-        if (Q_LIKELY(!commit.isNull())) // TODO: check if is this possible?
-            dataByCommit.insert(commit, ref);
+
+        // keyed by target id, so commits do not have to be loaded just to index the references
+        auto target = ref->target();
+        if (!target.isNull())
+            dataByCommit.insert(target, ref);
     }
 
     git_reference_iterator_free(iterator);
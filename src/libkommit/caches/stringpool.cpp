@@ -0,0 +1,78 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "stringpool.h"
+#include "gitmanager.h"
+
+#include <QHashFunctions>
+
+#include <cstring>
+
+namespace Git
+{
+
+StringPool *StringPool::of(git_repository *repo)
+{
+    if (auto manager = Manager::owner(repo))
+        return manager->stringPool();
+    return instance();
+}
+
+StringPool *StringPool::instance()
+{
+    // held by one reference of its own, the pointers of the commits never delete it
+    static const auto pool = [] {
+        auto pool = new StringPool;
+        pool->ref.ref();
+        return pool;
+    }();
+    return pool;
+}
+
+quint32 StringPool::intern(const char *data, int size)
+{
+    // entries are stored as a native endian length followed by the bytes
+    const auto hash = static_cast<uint>(qHashBits(data, size));
+
+    QMutexLocker locker(&mMutex);
+
+    for (auto it = mOffsets.constFind(hash); it != mOffsets.cend() && it.key() == hash; ++it) {
+        const auto offset = it.value();
+        quint32 length;
+        std::memcpy(&length, mData.constData() + offset, sizeof(length));
+        if (length == static_cast<quint32>(size) && !std::memcmp(mData.constData() + offset + sizeof(length), data, size))
+            return offset;
+    }
+
+    const auto offset = static_cast<quint32>(mData.size());
+    const auto length = static_cast<quint32>(size);
+    mData.append(reinterpret_cast<const char *>(&length), sizeof(length));
+    mData.append(data, size);
+    mOffsets.insert(hash, offset);
+    return offset;
+}
+
+quint32 StringPool::intern(const QByteArray &data)
+{
+    return intern(data.constData(), data.size());
+}
+
+QByteArray StringPool::value(quint32 offset) const
+{
+    QMutexLocker locker(&mMutex);
+
+    quint32 length;
+    std::memcpy(&length, mData.constData() + offset, sizeof(length));
+    return QByteArray{mData.constData() + offset + sizeof(length), static_cast<int>(length)};
+}
+
+qint64 StringPool::size() const
+{
+    QMutexLocker locker(&mMutex);
+    return mData.size();
+}
+
+}
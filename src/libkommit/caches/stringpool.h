@@ -0,0 +1,53 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QExplicitlySharedDataPointer>
+#include <QMultiHash>
+#include <QMutex>
+#include <QSharedData>
+
+#include <git2/types.h>
+
+#include "libkommit_export.h"
+
+namespace Git
+{
+
+/**
+ * Pool of interned byte strings, one for every Manager.
+ *
+ * Each distinct string is stored once and referred to by a 32-bit offset, which lets compact
+ * entities such as Commit keep subjects and identities without owning a string each.
+ * Strings are never removed; interning the same history again costs nothing. A manager starts
+ * a new pool when its caches are reset, the entities still referring to the old one keep it
+ * alive until they are gone.
+ */
+class LIBKOMMIT_NO_EXPORT StringPool : public QSharedData
+{
+public:
+    // Pool of the manager that opened repo, or a shared one for repositories opened without one
+    static StringPool *of(git_repository *repo);
+
+    Q_REQUIRED_RESULT quint32 intern(const char *data, int size);
+    Q_REQUIRED_RESULT quint32 intern(const QByteArray &data);
+    Q_REQUIRED_RESULT QByteArray value(quint32 offset) const;
+
+    Q_REQUIRED_RESULT qint64 size() const;
+
+private:
+    static StringPool *instance();
+
+    mutable QMutex mMutex;
+    QByteArray mData;
+    QMultiHash<uint, quint32> mOffsets;
+};
+
+using StringPoolPointer = QExplicitlySharedDataPointer<StringPool>;
+
+}
@@ -21,6 +21,9 @@ namespace Git
 SubmodulesCache::SubmodulesCache(Manager *manager)
     : QObject{manager}
     , Cache<Submodule, git_submodule>{manager}
+    , mChanges{this, [this](const ChangeSet &changes) {
+                   Q_EMIT changed(changes);
+               }}
 {
 }
 
@@ -43,7 +46,7 @@ SubmodulesCache::DataMember SubmodulesCache::add(const AddSubmoduleOptions &opti
         auto en = findByPtr(submodule);
 
         if (!en.isNull()) {
-            Q_EMIT added(en);
+            mChanges.insert(en);
             return en;
         }
     }
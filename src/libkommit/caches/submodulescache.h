@@ -7,6 +7,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
 
 #include "caches/abstractcache.h"
+#include "caches/changeset.h"
 #include "entities/submodule.h"
 #include "libkommit_export.h"
 
@@ -20,6 +21,8 @@ class LIBKOMMIT_EXPORT SubmodulesCache : public QObject, public Cache<Submodule,
     Q_OBJECT
 
 public:
+    using ChangeSet = Git::ChangeSet<DataMember>;
+
     explicit SubmodulesCache(Manager *manager);
 
     DataMember add(const AddSubmoduleOptions &options);
@@ -32,7 +35,11 @@ protected:
     void clearChildData() override;
 
 Q_SIGNALS:
-    void added(DataMember submodule);
+    // Submodules added through this cache, once per event loop turn
+    void changed(const Git::SubmodulesCache::ChangeSet &changes);
+
+private:
+    ChangeSetCollector<DataMember> mChanges;
 };
 
 }
@@ -18,23 +18,23 @@ namespace Git
 {
 
 TagsCache::TagsCache(Manager *parent)
-    : OidCache<Tag, git_tag>{parent, git_tag_lookup}
+    : OidCache<Tag, git_tag>{parent, git_tag_lookup, git_tag_id, git_tag_free}
 {
 }
 
 QSharedPointer<Tag> TagsCache::find(const QString &key)
 {
-    git_tag *tag;
     git_object *tagObject;
 
     BEGIN
     STEP git_revparse_single(&tagObject, manager->repoPtr(), key.toLatin1().constData());
-    STEP git_tag_lookup(&tag, manager->repoPtr(), git_object_id(tagObject));
 
-    if (IS_OK)
-        return Cache::findByPtr(tag);
+    if (IS_ERROR)
+        return QSharedPointer<Tag>{};
 
-    return QSharedPointer<Tag>{};
+    auto tag = findByOid(git_object_id(tagObject));
+    git_object_free(tagObject);
+    return tag;
 }
 
 void TagsCache::forEach(std::function<void(QSharedPointer<Tag>)> cb)
@@ -53,46 +53,38 @@ void TagsCache::forEach(std::function<void(QSharedPointer<Tag>)> cb)
     w.manager = manager;
 
     auto callback_c = [](const char *name, git_oid *oid_c, void *payload) {
-        Q_UNUSED(name)
         auto w = reinterpret_cast<wrapper *>(payload);
-        git_tag *t;
-
-        BEGIN
-        STEP git_tag_lookup(&t, w->repo, oid_c);
 
-        QSharedPointer<Tag> tag;
-        if (IS_OK) {
-            auto tag = w->cache->findByPtr(t);
+        auto tag = w->cache->findByOid(oid_c);
+        if (tag) {
             w->cb(tag);
             return 0;
-        } else {
-            // TODO: find commit
-            // auto cmt = w->manager->commitsCache()->find(oid_c);
-            // if (!cmt)
-            //     return 0;
-
-            git_commit *commit;
-            RESTART;
+        }
+
+        // lightweight tag, the reference points straight at the commit
+        const auto refName = QString{name};
+        tag = w->cache->mLightTags.value(refName);
+        if (!tag) {
+            git_commit *commit{nullptr};
+            git_reference *ref{nullptr};
+
+            BEGIN
             STEP git_commit_lookup(&commit, w->repo, oid_c);
+            STEP git_reference_lookup(&ref, w->repo, name);
 
             PRINT_ERROR;
-            RETURN_IF_ERR(0);
-
-            if (w->cache->mTagsByCommit.contains(commit)) {
-                auto tag = w->cache->mTagsByCommit.value(commit);
-                w->cb(tag);
+            if (IS_ERROR) {
+                git_reference_free(ref);
+                git_commit_free(commit);
                 return 0;
             }
-            git_reference *ref;
-            STEP git_reference_lookup(&ref, w->repo, name);
-            RETURN_IF_ERR(0);
 
-            auto lightTagName = QString{git_reference_shorthand(ref)};
-            tag.reset(new Tag{commit, lightTagName});
-            w->cb(tag);
-            return 0;
+            tag.reset(new Tag{commit, QString{git_reference_shorthand(ref)}});
+            git_reference_free(ref);
+            w->cache->mLightTags.insert(refName, tag);
         }
 
+        w->cb(tag);
         return 0;
     };
 
@@ -141,14 +133,17 @@ bool TagsCache::remove(QSharedPointer<Tag> tag)
     if (IS_ERROR)
         return false;
 
-    removeFromList(tag->tagPtr());
+    if (tag->tagPtr())
+        OidCache::remove(git_tag_id(tag->tagPtr()));
+    else
+        mLightTags.remove(QStringLiteral("refs/tags/") + tag->name());
 
     return IS_OK;
 }
 
 void TagsCache::clearChildData()
 {
-    mTagsByCommit.clear();
+    mLightTags.clear();
 }
 
 QList<QSharedPointer<Tag>> TagsCache::allTags()
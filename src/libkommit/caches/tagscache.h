@@ -35,7 +35,7 @@ protected:
     void clearChildData() override;
 
 private:
-    QHash<git_commit *, QSharedPointer<Tag>> mTagsByCommit;
+    QHash<QString, QSharedPointer<Tag>> mLightTags;
 };
 
 };
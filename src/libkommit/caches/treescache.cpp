@@ -0,0 +1,37 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "treescache.h"
+
+#include <git2/tree.h>
+
+namespace Git
+{
+
+namespace
+{
+constexpr qint64 defaultMaxCost{16 * 1024 * 1024};
+// a listed entry holds its name, type and id
+constexpr qint64 entryCost{96};
+}
+
+TreesCache::TreesCache(Manager *parent)
+    : OidCache<Tree, git_tree>{parent, git_tree_lookup, git_tree_id, git_tree_free}
+{
+    setMaxCost(defaultMaxCost);
+}
+
+void TreesCache::clearChildData()
+{
+}
+
+qint64 TreesCache::cost(const Tree &tree) const
+{
+    // known before the level is listed, libgit2 has parsed the entries already
+    return sizeof(Tree) + static_cast<qint64>(git_tree_entrycount(tree.gitTree())) * entryCost;
+}
+
+}
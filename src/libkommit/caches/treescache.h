@@ -0,0 +1,35 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <git2/types.h>
+
+#include "abstractcache.h"
+#include "entities/tree.h"
+#include "libkommit_export.h"
+
+namespace Git
+{
+
+/**
+ * Directory levels by tree id.
+ *
+ * Consecutive commits share most of their directories, so a Tree reads the subtrees below it from
+ * here and every commit that has the same directory shows the same, already listed level. The
+ * cache is bounded by the number of entries of the cached levels.
+ */
+class LIBKOMMIT_EXPORT TreesCache : public OidCache<Tree, git_tree>
+{
+public:
+    explicit TreesCache(Manager *parent);
+
+protected:
+    void clearChildData() override;
+    qint64 cost(const Tree &tree) const override;
+};
+
+}
@@ -0,0 +1,878 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "trigramindex.h"
+#include "caches/commitscache.h"
+#include "entities/commit.h"
+#include "gitmanager.h"
+#include "historyblobs.h"
+#include "repositorywatcher.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QSaveFile>
+#include <QWriteLocker>
+
+#include <git2/blob.h>
+#include <git2/oid.h>
+#include <git2/repository.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+namespace Git
+{
+
+namespace
+{
+
+constexpr char indexMagic[4] = {'K', 'T', 'G', 'X'};
+constexpr quint32 indexVersion = 1;
+constexpr int rawOidSize = 20;
+constexpr quint32 trigramMask = 0xffffff;
+// blobs a job collects before taking the write lock
+constexpr int mergeBatch = 256;
+// blobs indexed between two saves of an update
+constexpr int saveInterval = 5000;
+// new commits often come in bursts (fetch, rebase)
+constexpr int updateDelay = 1000;
+
+struct IndexHeader {
+    char magic[4];
+    quint32 version;
+    quint32 commitCount;
+    quint32 blobCount;
+    quint32 trigramCount;
+};
+
+struct PostingRecord {
+    quint32 trigram;
+    qint32 last;
+    quint32 size;
+};
+
+class Reader
+{
+public:
+    Reader(const uchar *data, qint64 size)
+        : mData{data}
+        , mSize{size}
+    {
+    }
+
+    const uchar *take(qint64 length)
+    {
+        if (length < 0 || mPos + length > mSize)
+            return nullptr;
+        auto p = mData + mPos;
+        mPos += length;
+        return p;
+    }
+
+    template<typename T>
+    bool read(T *out)
+    {
+        auto p = take(sizeof(T));
+        if (!p)
+            return false;
+        std::memcpy(out, p, sizeof(T));
+        return true;
+    }
+
+private:
+    const uchar *mData;
+    qint64 mSize;
+    qint64 mPos{0};
+};
+
+Oid readOid(const uchar *raw)
+{
+    git_oid oid;
+    git_oid_fromraw(&oid, raw);
+    return Oid{oid};
+}
+
+void appendOid(QByteArray &buffer, const Oid &oid)
+{
+    buffer.append(reinterpret_cast<const char *>(oid.oidPtr()->id), rawOidSize);
+}
+
+template<typename T>
+void appendValue(QByteArray &buffer, const T &value)
+{
+    buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+inline quint32 foldByte(uchar c)
+{
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+QList<quint32> literalTrigrams(const QString &literal, Qt::CaseSensitivity cs)
+{
+    const auto bytes = literal.toUtf8();
+
+    QList<quint32> trigrams;
+    for (int i = 0; i + 2 < bytes.size(); ++i) {
+        const auto a = static_cast<uchar>(bytes.at(i));
+        const auto b = static_cast<uchar>(bytes.at(i + 1));
+        const auto c = static_cast<uchar>(bytes.at(i + 2));
+
+        // case folding of other scripts can change the bytes of a match, only ASCII is folded in the index
+        if (cs == Qt::CaseInsensitive && (a | b | c) >= 0x80)
+            continue;
+        trigrams << (foldByte(a) << 16 | foldByte(b) << 8 | foldByte(c));
+    }
+    return trigrams;
+}
+
+// Value of an ASCII hexadecimal digit, -1 for anything else
+int digitValue(QChar c)
+{
+    const auto u = c.unicode();
+    if (u >= '0' && u <= '9')
+        return u - '0';
+    if (u >= 'a' && u <= 'f')
+        return u - 'a' + 10;
+    if (u >= 'A' && u <= 'F')
+        return u - 'A' + 10;
+    return -1;
+}
+
+// Index after at most max digits of base starting at i
+int skipDigits(const QString &pattern, int i, int max, int base)
+{
+    for (; max && i < pattern.size(); --max, ++i) {
+        const auto value = digitValue(pattern.at(i));
+        if (value == -1 || value >= base)
+            break;
+    }
+    return i;
+}
+
+/**
+ * i is at the character after a backslash. Returns the index of the last character of the escape,
+ * including arguments such as the digits of \x41 or the character of \cA, or -1 if it is not
+ * understood.
+ */
+int skipEscape(const QString &pattern, int i)
+{
+    const auto hasNext = i + 1 < pattern.size();
+    const auto next = hasNext ? pattern.at(i + 1) : QChar{};
+    const auto skipTo = [&pattern, i](QChar closer) {
+        return pattern.indexOf(closer, i + 2);
+    };
+
+    switch (pattern.at(i).unicode()) {
+    case 'x':
+        if (next == QLatin1Char('{'))
+            return skipTo(QLatin1Char('}'));
+        return skipDigits(pattern, i + 1, 2, 16) - 1;
+    case 'o':
+        return next == QLatin1Char('{') ? skipTo(QLatin1Char('}')) : -1;
+    case 'c':
+        return hasNext ? i + 1 : -1;
+    case '0':
+        return skipDigits(pattern, i + 1, 2, 8) - 1;
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+        // a back reference, or an octal code followed by digits; the digits are dropped either way
+        return skipDigits(pattern, i + 1, pattern.size(), 10) - 1;
+    case 'N':
+        return next == QLatin1Char('{') ? skipTo(QLatin1Char('}')) : i;
+    case 'p':
+    case 'P':
+        if (next == QLatin1Char('{'))
+            return skipTo(QLatin1Char('}'));
+        return hasNext ? i + 1 : -1;
+    case 'g':
+        if (next == QLatin1Char('+') || next == QLatin1Char('-')) {
+            const auto end = skipDigits(pattern, i + 2, pattern.size(), 10);
+            return end == i + 2 ? -1 : end - 1;
+        }
+        if (next.isDigit())
+            return skipDigits(pattern, i + 1, pattern.size(), 10) - 1;
+        Q_FALLTHROUGH();
+    case 'k':
+        if (next == QLatin1Char('{'))
+            return skipTo(QLatin1Char('}'));
+        if (next == QLatin1Char('<'))
+            return skipTo(QLatin1Char('>'));
+        if (next == QLatin1Char('\''))
+            return skipTo(QLatin1Char('\''));
+        return -1;
+    default:
+        return i;
+    }
+}
+
+int skipClass(const QString &pattern, int i)
+{
+    // i is at '['; a ']' right after the opening (or after '^') is part of the class
+    ++i;
+    if (i < pattern.size() && pattern.at(i) == QLatin1Char('^'))
+        ++i;
+    if (i < pattern.size() && pattern.at(i) == QLatin1Char(']'))
+        ++i;
+    for (; i < pattern.size(); ++i) {
+        if (pattern.at(i) == QLatin1Char('\\')) {
+            if (++i == pattern.size())
+                return -1;
+            i = skipEscape(pattern, i);
+            if (i == -1)
+                return -1;
+        } else if (pattern.at(i) == QLatin1Char(']')) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int skipGroup(const QString &pattern, int i)
+{
+    int depth{0};
+    for (; i < pattern.size(); ++i) {
+        const auto c = pattern.at(i);
+        if (c == QLatin1Char('\\')) {
+            if (++i == pattern.size())
+                return -1;
+            i = skipEscape(pattern, i);
+            if (i == -1)
+                return -1;
+        } else if (c == QLatin1Char('[')) {
+            i = skipClass(pattern, i);
+            if (i == -1)
+                return -1;
+        } else if (c == QLatin1Char('(')) {
+            ++depth;
+        } else if (c == QLatin1Char(')') && !--depth) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void chopLastCharacter(QString &run)
+{
+    if (run.size() > 1 && run.back().isLowSurrogate())
+        run.chop(2);
+    else
+        run.chop(1);
+}
+
+/**
+ * Splits pattern at its top level alternation and collects the literal runs each alternative
+ * needs. Anything not understood (classes, groups, escapes of letters with their arguments) only
+ * ends a run, so the runs may miss literals of a match but never hold one it does not need.
+ */
+bool regularExpressionLiterals(const QString &pattern, QList<QStringList> *alternatives)
+{
+    // inline options can switch on case folding or free spacing
+    if (pattern.contains(QLatin1String("(?")))
+        return false;
+
+    QStringList runs;
+    QString run;
+    const auto endRun = [&runs, &run]() {
+        if (!run.isEmpty())
+            runs << run;
+        run.clear();
+    };
+
+    for (int i = 0; i < pattern.size(); ++i) {
+        const auto c = pattern.at(i);
+        switch (c.unicode()) {
+        case '|':
+            endRun();
+            *alternatives << runs;
+            runs.clear();
+            break;
+        case '\\': {
+            if (++i == pattern.size())
+                return false;
+            const auto escaped = pattern.at(i);
+            if (escaped == QLatin1Char('Q')) {
+                auto end = pattern.indexOf(QLatin1String("\\E"), i + 1);
+                if (end == -1)
+                    end = pattern.size();
+                run += pattern.mid(i + 1, end - i - 1);
+                i = end + 1;
+            } else if (escaped.isLetterOrNumber()) {
+                endRun();
+                i = skipEscape(pattern, i);
+                if (i == -1)
+                    return false;
+            } else {
+                run += escaped;
+            }
+            break;
+        }
+        case '[':
+            endRun();
+            i = skipClass(pattern, i);
+            if (i == -1)
+                return false;
+            break;
+        case '(':
+            endRun();
+            i = skipGroup(pattern, i);
+            if (i == -1)
+                return false;
+            break;
+        case ')':
+            return false;
+        case '*':
+        case '?':
+            chopLastCharacter(run);
+            endRun();
+            break;
+        case '{': {
+            const auto end = pattern.indexOf(QLatin1Char('}'), i);
+            const auto bounds = end == -1 ? QString{} : pattern.mid(i + 1, end - i - 1);
+            bool ok{false};
+            const auto minimum = bounds.section(QLatin1Char(','), 0, 0).toInt(&ok);
+            if (!ok) {
+                // not a quantifier, a plain brace
+                run += c;
+                break;
+            }
+            if (!minimum)
+                chopLastCharacter(run);
+            endRun();
+            i = end;
+            break;
+        }
+        case '+':
+        case '.':
+        case '^':
+        case '$':
+            endRun();
+            break;
+        default:
+            run += c;
+        }
+    }
+
+    endRun();
+    *alternatives << runs;
+    return true;
+}
+
+QList<qint32> decodePosting(const QByteArray &ids)
+{
+    QList<qint32> result;
+    qint32 id{-1};
+    quint32 delta{0};
+    int shift{0};
+    for (const auto byte : ids) {
+        delta |= quint32(static_cast<uchar>(byte) & 0x7f) << shift;
+        if (static_cast<uchar>(byte) & 0x80) {
+            shift += 7;
+            continue;
+        }
+        id += static_cast<qint32>(delta);
+        result << id;
+        delta = 0;
+        shift = 0;
+    }
+    return result;
+}
+
+void appendVarint(QByteArray &buffer, quint32 value)
+{
+    while (value >= 0x80) {
+        buffer.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer.append(static_cast<char>(value));
+}
+
+}
+
+TrigramIndex::Query TrigramIndex::Query::fromText(const QString &text, Qt::CaseSensitivity cs)
+{
+    return fromLiterals({QStringList{text}}, cs);
+}
+
+TrigramIndex::Query TrigramIndex::Query::fromRegularExpression(const QString &pattern, Qt::CaseSensitivity cs)
+{
+    QList<QStringList> alternatives;
+    if (!regularExpressionLiterals(pattern, &alternatives))
+        return {};
+    return fromLiterals(alternatives, cs);
+}
+
+TrigramIndex::Query TrigramIndex::Query::fromLiterals(const QList<QStringList> &alternatives, Qt::CaseSensitivity cs)
+{
+    Query query;
+    for (const auto &literals : alternatives) {
+        QList<quint32> trigrams;
+        for (const auto &literal : literals)
+            trigrams << literalTrigrams(literal, cs);
+        if (trigrams.isEmpty())
+            return {};
+
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+        query.mAlternatives << trigrams;
+    }
+    return query;
+}
+
+bool TrigramIndex::Query::matchesAll() const
+{
+    return mAlternatives.isEmpty();
+}
+
+const QList<QList<quint32>> &TrigramIndex::Query::alternatives() const
+{
+    return mAlternatives;
+}
+
+TrigramIndex::TrigramIndex(Manager *manager)
+    : QObject{manager}
+    , mManager{manager}
+{
+    mUpdateTimer.setSingleShot(true);
+    mUpdateTimer.setInterval(updateDelay);
+    connect(&mUpdateTimer, &QTimer::timeout, this, &TrigramIndex::update);
+}
+
+TrigramIndex::~TrigramIndex()
+{
+    cancel();
+}
+
+QString TrigramIndex::path() const
+{
+    return QString::fromUtf8(git_repository_path(mManager->repoPtr())) + QStringLiteral("kommit/trigrams.idx");
+}
+
+void TrigramIndex::update()
+{
+    if (!mManager->isValid())
+        return;
+
+    if (!mFollowing) {
+        mFollowing = true;
+        // the commits cache only reports changes when it is read on this thread, refs moving is
+        // what brings new commits no matter who loads them
+        connect(mManager->watcher(), &RepositoryWatcher::refsChanged, this, [this]() {
+            mUpdateTimer.start();
+        });
+        connect(mManager->watcher(), &RepositoryWatcher::headMoved, this, [this]() {
+            mUpdateTimer.start();
+        });
+    }
+
+    if (isUpdating()) {
+        mUpdatePending = true;
+        return;
+    }
+
+    QList<Oid> commits;
+    const auto allCommits = mManager->commits()->allCommits();
+    commits.reserve(allCommits.size());
+    for (const auto &commit : allCommits)
+        commits << commit->oid();
+
+    const auto updateId = ++mUpdateId;
+    mRunningJobs = 1;
+    mJobs << mManager->runAsync([this, commits, updateId](Manager *git) {
+        load();
+
+        QList<Oid> missing;
+        {
+            QReadLocker locker{&mLock};
+            for (const auto &commit : commits)
+                if (!mCommits.contains(commit))
+                    missing << commit;
+        }
+
+        // unchanged subtrees are not read again, so this costs about one tree per commit
+        HistoryBlobs history;
+        for (const auto &commit : std::as_const(missing)) {
+            if (mCanceled)
+                break;
+            history.addPlace(git, commit.toString());
+        }
+
+        QList<Oid> blobs;
+        {
+            const auto allBlobs = history.blobs();
+            QReadLocker locker{&mLock};
+            for (auto i = allBlobs.constBegin(); i != allBlobs.constEnd(); ++i)
+                if (!mBlobIds.contains(i.key()))
+                    blobs << i.key();
+        }
+
+        QMetaObject::invokeMethod(
+            this,
+            [this, updateId, missing, blobs]() {
+                indexBlobs(updateId, missing, blobs);
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void TrigramIndex::indexBlobs(int updateId, const QList<Oid> &commits, const QList<Oid> &blobs)
+{
+    if (updateId != mUpdateId)
+        return;
+
+    mJobs.erase(std::remove_if(mJobs.begin(),
+                               mJobs.end(),
+                               [](const QFuture<void> &job) {
+                                   return job.isFinished();
+                               }),
+                mJobs.end());
+
+    mPendingCommits = commits;
+    mIndexed = 0;
+    mTotal = blobs.size();
+
+    // blobs are dealt out round robin, neighbouring blobs of a tree tend to be of the same size
+    const auto started = mManager->runParallel(static_cast<int>(blobs.size()), [this, blobs, updateId](Manager *git, int job, int jobs) {
+        indexShare(git, Manager::jobShare(blobs, job, jobs));
+        QMetaObject::invokeMethod(
+            this,
+            [this, updateId]() {
+                jobFinished(updateId);
+            },
+            Qt::QueuedConnection);
+    });
+    mRunningJobs = started.size();
+    mJobs << started;
+}
+
+void TrigramIndex::indexShare(Manager *git, const QList<Oid> &blobs)
+{
+    // one bit per possible trigram, collecting the distinct trigrams of a blob takes no sorting
+    std::vector<bool> seen(trigramMask + 1);
+    QList<IndexedBlob> batch;
+
+    for (const auto &oid : blobs) {
+        if (mCanceled)
+            break;
+
+        git_blob *blob{nullptr};
+        if (git_blob_lookup(&blob, git->repoPtr(), oid.oidPtr()))
+            continue;
+
+        // binary blobs get no trigrams, a content search never matches them
+        IndexedBlob indexed{oid, {}};
+        if (!git_blob_is_binary(blob)) {
+            const auto data = static_cast<const uchar *>(git_blob_rawcontent(blob));
+            const auto size = static_cast<qint64>(git_blob_rawsize(blob));
+
+            quint32 trigram{0};
+            for (qint64 i = 0; i < size; ++i) {
+                trigram = (trigram << 8 | foldByte(data[i])) & trigramMask;
+                if (i < 2 || seen[trigram])
+                    continue;
+                seen[trigram] = true;
+                indexed.trigrams << trigram;
+            }
+            for (const auto t : std::as_const(indexed.trigrams))
+                seen[t] = false;
+        }
+        git_blob_free(blob);
+
+        batch << indexed;
+        if (batch.size() >= mergeBatch) {
+            merge(batch);
+            batch.clear();
+        }
+    }
+
+    merge(batch);
+}
+
+void TrigramIndex::merge(const QList<IndexedBlob> &blobs)
+{
+    if (blobs.isEmpty())
+        return;
+
+    {
+        QWriteLocker locker{&mLock};
+        for (const auto &blob : blobs) {
+            if (mBlobIds.contains(blob.blob))
+                continue;
+
+            // ids only grow, so every posting stays sorted
+            const auto id = static_cast<qint32>(mBlobs.size());
+            mBlobs << blob.blob;
+            mBlobIds.insert(blob.blob, id);
+            for (const auto trigram : blob.trigrams) {
+                auto &posting = mPostings[trigram];
+                appendVarint(posting.ids, static_cast<quint32>(id - posting.last));
+                posting.last = id;
+            }
+        }
+    }
+
+    mIndexed += blobs.size();
+    if ((mUnsaved += blobs.size()) >= saveInterval) {
+        mUnsaved = 0;
+        save();
+    }
+
+    QMetaObject::invokeMethod(
+        this,
+        [this]() {
+            Q_EMIT progress(mIndexed, mTotal);
+        },
+        Qt::QueuedConnection);
+}
+
+void TrigramIndex::jobFinished(int updateId)
+{
+    if (updateId != mUpdateId || --mRunningJobs)
+        return;
+
+    {
+        QWriteLocker locker{&mLock};
+        for (const auto &commit : std::as_const(mPendingCommits))
+            mCommits.insert(commit);
+    }
+    mPendingCommits.clear();
+    mJobs.clear();
+    mUnsaved = 0;
+    save();
+
+    Q_EMIT updated();
+
+    if (mUpdatePending) {
+        mUpdatePending = false;
+        update();
+    }
+}
+
+void TrigramIndex::cancel()
+{
+    mCanceled = true;
+    for (auto &job : mJobs)
+        job.waitForFinished();
+    mJobs.clear();
+    mCanceled = false;
+
+    if (mRunningJobs) {
+        // the commits of the update are not marked, the next one walks them again and skips the indexed blobs
+        ++mUpdateId;
+        mRunningJobs = 0;
+        mPendingCommits.clear();
+        save();
+    }
+    mUpdatePending = false;
+}
+
+void TrigramIndex::reset()
+{
+    cancel();
+    mUpdateTimer.stop();
+
+    if (mFollowing) {
+        disconnect(mManager->watcher(), nullptr, this, nullptr);
+        mFollowing = false;
+    }
+
+    QWriteLocker locker{&mLock};
+    mBlobs.clear();
+    mBlobIds.clear();
+    mPostings.clear();
+    mCommits.clear();
+    mLoaded = false;
+}
+
+bool TrigramIndex::isUpdating() const
+{
+    return mRunningJobs > 0;
+}
+
+int TrigramIndex::blobCount() const
+{
+    QReadLocker locker{&mLock};
+    return mBlobs.size();
+}
+
+TrigramIndex::BlobFilter TrigramIndex::filter(const Query &query) const
+{
+    if (query.matchesAll())
+        return [](const Oid &) {
+            return true;
+        };
+
+    QReadLocker locker{&mLock};
+
+    QSet<qint32> candidates;
+    for (const auto &trigrams : query.alternatives()) {
+        QList<const Posting *> postings;
+        for (const auto trigram : trigrams) {
+            auto it = mPostings.constFind(trigram);
+            if (it == mPostings.cend()) {
+                // no blob indexed so far has it
+                postings.clear();
+                break;
+            }
+            postings << &*it;
+        }
+        if (postings.isEmpty())
+            continue;
+
+        // starting with the rarest trigram keeps the intersection small
+        std::sort(postings.begin(), postings.end(), [](const Posting *l, const Posting *r) {
+            return l->ids.size() < r->ids.size();
+        });
+
+        auto ids = decodePosting(postings.first()->ids);
+        for (int i = 1; i < postings.size() && !ids.isEmpty(); ++i) {
+            const auto other = decodePosting(postings.at(i)->ids);
+            QList<qint32> both;
+            std::set_intersection(ids.cbegin(), ids.cend(), other.cbegin(), other.cend(), std::back_inserter(both));
+            ids = both;
+        }
+        for (const auto id : std::as_const(ids))
+            candidates.insert(id);
+    }
+
+    const auto blobIds = mBlobIds;
+    return [blobIds, candidates](const Oid &blob) {
+        auto it = blobIds.constFind(blob);
+        return it == blobIds.cend() || candidates.contains(*it);
+    };
+}
+
+void TrigramIndex::load()
+{
+    QWriteLocker locker{&mLock};
+    if (mLoaded)
+        return;
+    mLoaded = true;
+
+    QFile file{path()};
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    const auto size = file.size();
+    auto data = file.map(0, size);
+    if (!data)
+        return;
+
+    if (!parse(data, size)) {
+        mBlobs.clear();
+        mBlobIds.clear();
+        mPostings.clear();
+        mCommits.clear();
+    }
+    file.unmap(data);
+}
+
+bool TrigramIndex::parse(const uchar *data, qint64 size)
+{
+    Reader reader{data, size};
+
+    IndexHeader header;
+    if (!reader.read(&header) || std::memcmp(header.magic, indexMagic, sizeof(indexMagic)) || header.version != indexVersion)
+        return false;
+
+    auto commits = reader.take(qint64(header.commitCount) * rawOidSize);
+    auto blobs = reader.take(qint64(header.blobCount) * rawOidSize);
+    auto records = reader.take(qint64(header.trigramCount) * sizeof(PostingRecord));
+    if (!commits || !blobs || !records)
+        return false;
+
+    mCommits.reserve(header.commitCount);
+    for (quint32 i = 0; i < header.commitCount; ++i)
+        mCommits.insert(readOid(commits + i * rawOidSize));
+
+    mBlobs.reserve(header.blobCount);
+    mBlobIds.reserve(header.blobCount);
+    for (quint32 i = 0; i < header.blobCount; ++i) {
+        const auto blob = readOid(blobs + i * rawOidSize);
+        mBlobIds.insert(blob, static_cast<qint32>(mBlobs.size()));
+        mBlobs << blob;
+    }
+
+    mPostings.reserve(header.trigramCount);
+    for (quint32 i = 0; i < header.trigramCount; ++i) {
+        PostingRecord record;
+        std::memcpy(&record, records + i * sizeof(PostingRecord), sizeof(PostingRecord));
+
+        auto ids = reader.take(record.size);
+        if (!ids || record.last < 0 || quint32(record.last) >= header.blobCount)
+            return false;
+        mPostings.insert(record.trigram, Posting{QByteArray{reinterpret_cast<const char *>(ids), static_cast<int>(record.size)}, record.last});
+    }
+
+    return true;
+}
+
+bool TrigramIndex::save()
+{
+    // jobs reaching the save interval together write one after the other
+    QMutexLocker saveLocker{&mSaveMutex};
+    QReadLocker locker{&mLock};
+
+    if (!mLoaded)
+        return false;
+
+    const auto filePath = path();
+    if (!QDir{}.mkpath(QFileInfo{filePath}.absolutePath()))
+        return false;
+
+    IndexHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, indexMagic, sizeof(indexMagic));
+    header.version = indexVersion;
+    header.commitCount = static_cast<quint32>(mCommits.size());
+    header.blobCount = static_cast<quint32>(mBlobs.size());
+    header.trigramCount = static_cast<quint32>(mPostings.size());
+
+    QByteArray head;
+    appendValue(head, header);
+    for (const auto &commit : mCommits)
+        appendOid(head, commit);
+    for (const auto &blob : mBlobs)
+        appendOid(head, blob);
+
+    QByteArray records;
+    records.reserve(mPostings.size() * sizeof(PostingRecord));
+    for (auto i = mPostings.constBegin(); i != mPostings.constEnd(); ++i) {
+        PostingRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.trigram = i.key();
+        record.last = i.value().last;
+        record.size = static_cast<quint32>(i.value().ids.size());
+        appendValue(records, record);
+    }
+
+    QSaveFile file{filePath};
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.write(head);
+    file.write(records);
+    for (const auto &posting : mPostings)
+        file.write(posting.ids);
+
+    return file.commit();
+}
+
+}
+
+#include "moc_trigramindex.cpp"
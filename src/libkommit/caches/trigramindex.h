@@ -0,0 +1,137 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "entities/oid.h"
+#include "libkommit_export.h"
+
+#include <QByteArray>
+#include <QFuture>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+#include <atomic>
+#include <functional>
+
+namespace Git
+{
+
+class Manager;
+
+/**
+ * Sidecar file in <gitdir>/kommit/ mapping the trigrams of blob contents to the blobs that have
+ * them, so a content search over the whole history only reads the blobs that can match.
+ *
+ * Trigrams are taken over the raw bytes with ASCII letters folded to lower case, so one index
+ * serves case sensitive and insensitive searches; candidates still have to be verified.
+ * update() indexes the blobs of the commits not covered yet on the worker pool and follows new
+ * commits from then on, whenever the repository watcher sees refs move. What is done is saved every few thousand blobs, so an interrupted build
+ * goes on where it stopped. Lookups may be made from any thread, also while an update runs: a
+ * blob the index has not seen yet is always a candidate. Lives in the thread of its manager.
+ */
+class LIBKOMMIT_EXPORT TrigramIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Trigrams a match has to have: all of those of at least one alternative
+    class LIBKOMMIT_EXPORT Query
+    {
+    public:
+        Q_REQUIRED_RESULT static Query fromText(const QString &text, Qt::CaseSensitivity cs);
+        // Trigrams of the literal parts every match of pattern has to contain
+        Q_REQUIRED_RESULT static Query fromRegularExpression(const QString &pattern, Qt::CaseSensitivity cs);
+
+        // True if the query cannot rule out any blob
+        Q_REQUIRED_RESULT bool matchesAll() const;
+        Q_REQUIRED_RESULT const QList<QList<quint32>> &alternatives() const;
+
+    private:
+        // an alternative without trigrams matches everything, so the whole query does
+        static Query fromLiterals(const QList<QStringList> &alternatives, Qt::CaseSensitivity cs);
+
+        QList<QList<quint32>> mAlternatives;
+    };
+
+    using BlobFilter = std::function<bool(const Oid &blob)>;
+
+    explicit TrigramIndex(Manager *manager);
+    ~TrigramIndex() override;
+
+    Q_REQUIRED_RESULT QString path() const;
+
+    // Indexes the blobs of the commits not indexed yet in the background, then keeps up with new ones
+    void update();
+    // Stops a running update and saves what was indexed so far
+    void cancel();
+    // Drops the index from memory and stops following new commits, the next update() loads it again
+    void reset();
+
+    Q_REQUIRED_RESULT bool isUpdating() const;
+    Q_REQUIRED_RESULT int blobCount() const;
+
+    // Whether a blob may match query, as of now
+    Q_REQUIRED_RESULT BlobFilter filter(const Query &query) const;
+
+Q_SIGNALS:
+    void progress(int indexed, int total);
+    void updated();
+
+private:
+    // ids of the blobs that have a trigram, as deltas to the previous id in base 128
+    struct Posting {
+        QByteArray ids;
+        qint32 last{-1};
+    };
+
+    struct IndexedBlob {
+        Oid blob;
+        QList<quint32> trigrams;
+    };
+
+    void load();
+    bool parse(const uchar *data, qint64 size);
+    bool save();
+    void indexBlobs(int updateId, const QList<Oid> &commits, const QList<Oid> &blobs);
+    void indexShare(Manager *git, const QList<Oid> &blobs);
+    void merge(const QList<IndexedBlob> &blobs);
+    void jobFinished(int updateId);
+
+    Manager *const mManager;
+
+    // guards the index itself, shared by the lookups and the update jobs
+    mutable QReadWriteLock mLock;
+    QList<Oid> mBlobs;
+    QHash<Oid, qint32> mBlobIds;
+    QHash<quint32, Posting> mPostings;
+    QSet<Oid> mCommits;
+    bool mLoaded{false};
+
+    QMutex mSaveMutex;
+    std::atomic_int mUnsaved{0};
+    std::atomic_int mIndexed{0};
+    std::atomic_bool mCanceled{false};
+
+    QList<QFuture<void>> mJobs;
+    // commits whose blobs the running update indexes, marked done once all of them are
+    QList<Oid> mPendingCommits;
+    QTimer mUpdateTimer;
+    int mTotal{0};
+    int mRunningJobs{0};
+    // queued results of an update that was canceled are dropped
+    int mUpdateId{0};
+    bool mFollowing{false};
+    bool mUpdatePending{false};
+};
+
+}
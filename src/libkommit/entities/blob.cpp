@@ -0,0 +1,59 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "blob.h"
+#include "oid.h"
+
+#include <git2/blob.h>
+
+namespace Git
+{
+
+Blob::Blob(git_blob *blob)
+    : mBlob{blob}
+{
+}
+
+Blob::~Blob()
+{
+    git_blob_free(mBlob);
+}
+
+QByteArray Blob::data() const
+{
+    return QByteArray::fromRawData(static_cast<const char *>(git_blob_rawcontent(mBlob)), static_cast<int>(git_blob_rawsize(mBlob)));
+}
+
+qint64 Blob::size() const
+{
+    return static_cast<qint64>(git_blob_rawsize(mBlob));
+}
+
+bool Blob::isBinary() const
+{
+    return git_blob_is_binary(mBlob);
+}
+
+QString Blob::text() const
+{
+    if (!mTextDecoded) {
+        mText = QString::fromUtf8(static_cast<const char *>(git_blob_rawcontent(mBlob)), static_cast<int>(git_blob_rawsize(mBlob)));
+        mTextDecoded = true;
+    }
+    return mText;
+}
+
+Oid Blob::oid() const
+{
+    return Oid{git_blob_id(mBlob)};
+}
+
+git_blob *Blob::gitBlob() const
+{
+    return mBlob;
+}
+
+}
@@ -0,0 +1,42 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "interfaces.h"
+#include "libkommit_export.h"
+
+#include <QByteArray>
+#include <QString>
+
+#include <git2/types.h>
+
+namespace Git
+{
+
+class LIBKOMMIT_EXPORT Blob : public IOid
+{
+public:
+    explicit Blob(git_blob *blob);
+    ~Blob() override;
+
+    // The content in libgit2's buffer without a copy, valid for as long as this blob lives
+    Q_REQUIRED_RESULT QByteArray data() const;
+    Q_REQUIRED_RESULT qint64 size() const;
+    Q_REQUIRED_RESULT bool isBinary() const;
+    // Content decoded as UTF-8, decoded once and shared
+    Q_REQUIRED_RESULT QString text() const;
+
+    Oid oid() const override;
+    Q_REQUIRED_RESULT git_blob *gitBlob() const;
+
+private:
+    git_blob *const mBlob;
+    mutable QString mText;
+    mutable bool mTextDecoded{false};
+};
+
+}
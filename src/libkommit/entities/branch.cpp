@@ -125,17 +125,17 @@ QSharedPointer<Commit> Branch::commit()
     Q_D(Branch);
 
     if (d->commit.isNull()) {
-        git_commit *commit;
         git_object *obj;
 
         auto repo = git_reference_owner(d->branch);
         BEGIN
         STEP git_revparse_single(&obj, repo, toConstChars(d->refName));
-        STEP git_commit_lookup(&commit, repo, git_object_id(obj));
         END;
 
-        if (IS_OK)
-            d->commit = Manager::owner(repo)->commits()->findByPtr(commit);
+        if (IS_OK) {
+            d->commit = Manager::owner(repo)->commits()->findByOid(git_object_id(obj));
+            git_object_free(obj);
+        }
     }
 
     return d->commit;
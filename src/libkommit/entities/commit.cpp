@@ -6,179 +6,233 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "commit.h"
 #include "branch.h"
+#include "commit_p.h"
 #include "gitmanager.h"
 #include "note.h"
 #include "oid.h"
 
 #include <QTimeZone>
 
+#include "caches/stringpool.h"
 #include "tree.h"
 #include "types.h"
+
+#include <algorithm>
+#include <cstdlib>
+
 #include <git2/commit.h>
 #include <git2/errors.h>
 #include <git2/notes.h>
+#include <git2/oid.h>
 #include <git2/revparse.h>
 #include <git2/signature.h>
 
 namespace Git
 {
 
-class CommitPrivate
+namespace
 {
-    Commit *q_ptr;
-    Q_DECLARE_PUBLIC(Commit)
-public:
-    CommitPrivate(Commit *parent, git_commit *commit);
 
-    git_commit *const gitCommitPtr;
-    QSharedPointer<Signature> author;
-    QSharedPointer<Signature> committer;
-    QList<QSharedPointer<Reference>> references;
-    QSharedPointer<Branch> branch;
-    QSharedPointer<Note> note;
-    Commit::CommitType type;
-    QStringList parentHashes;
-    QStringList children;
-};
+quint32 internIdentity(StringPool *pool, const git_signature *signature)
+{
+    // git does not allow NUL inside names or emails, so it is a safe separator
+    QByteArray identity{signature->name};
+    identity.append('\0');
+    identity.append(signature->email);
+    return pool->intern(identity);
+}
+
+}
+
+CommitExtra::~CommitExtra()
+{
+    git_commit_free(commit);
+}
 
 Commit::Commit(git_commit *commit)
-    : d_ptr{new CommitPrivate{this, commit}}
+    : d_ptr{new CommitPrivate{commit}}
 {
-    Q_D(Commit);
-    auto id = git_commit_id(commit);
-    mCommitHash = git_oid_tostr_s(id);
+    git_commit_free(commit);
+}
 
-    auto parentCount = git_commit_parentcount(commit);
-    for (unsigned int i = 0; i < parentCount; ++i) {
-        auto pid = git_commit_parent_id(commit, i);
-        d->parentHashes << convertToString(pid, 20);
-    }
+Commit::Commit(CommitPrivate *d)
+    : d_ptr{d}
+{
 }
 
 Commit::~Commit()
 {
     Q_D(Commit);
-    git_commit_free(d->gitCommitPtr);
     delete d;
 }
 
 QSharedPointer<Branch> Commit::branch() const
 {
     Q_D(const Commit);
-    return d->branch;
+    return d->extraData ? d->extraData->branch : QSharedPointer<Branch>{};
 }
 
-const QStringList &Commit::children() const
+QStringList Commit::children() const
 {
     Q_D(const Commit);
-    return d->children;
+    QStringList list;
+    list.reserve(d->childCount);
+    for (quint32 i = 0; i < d->childCount; ++i)
+        list << d->links[d->parentCount + i].toString();
+    return list;
 }
 
-const QString &Commit::commitShortHash() const
+QList<Oid> Commit::childOids() const
 {
-    return mCommitShortHash;
+    Q_D(const Commit);
+    auto begin = d->links + d->parentCount;
+    return QList<Oid>(begin, begin + d->childCount);
+}
+
+QString Commit::commitShortHash() const
+{
+    Q_D(const Commit);
+    return d->id.toShortString();
 }
 
 QList<QSharedPointer<Reference>> Commit::references() const
 {
     Q_D(const Commit);
-    return d->references;
+    return d->extraData ? d->extraData->references : QList<QSharedPointer<Reference>>{};
 }
 
 QSharedPointer<Tree> Commit::tree() const
 {
     Q_D(const Commit);
+    auto commit = d->lookup();
+    if (!commit)
+        return nullptr;
+
     git_tree *tree;
-    if (git_commit_tree(&tree, d->gitCommitPtr))
+    auto r = git_commit_tree(&tree, commit);
+    git_commit_free(commit);
+    if (r)
         return nullptr;
     return QSharedPointer<Tree>{new Tree{tree}};
 }
 
 QString Commit::treeTitle() const
 {
-    return message();
+    return subject();
 }
 
 git_commit *Commit::gitCommit() const
 {
     Q_D(const Commit);
-    return d->gitCommitPtr;
+    auto extra = const_cast<CommitPrivate *>(d)->extra();
+    if (!extra->commit)
+        extra->commit = d->lookup();
+    return extra->commit;
 }
 
 QSharedPointer<Note> Commit::note()
 {
     Q_D(Commit);
 
-    if (d->note.isNull()) {
+    auto extra = d->extra();
+    if (extra->note.isNull()) {
         git_note *note;
 
-        if (!git_note_read(&note, git_commit_owner(d->gitCommitPtr), NULL, git_commit_id(d->gitCommitPtr)))
-            d->note = QSharedPointer<Note>{new Note{note}};
+        if (!git_note_read(&note, d->repo, NULL, d->id.oidPtr()))
+            extra->note = QSharedPointer<Note>{new Note{note}};
     }
-    return d->note;
+    return extra->note;
 }
 
 QDateTime Commit::commitTime() const
 {
     Q_D(const Commit);
-    auto time = git_commit_time(d->gitCommitPtr);
-    auto timeOffset = git_commit_time_offset(d->gitCommitPtr);
-
-    return QDateTime::fromSecsSinceEpoch(time, QTimeZone{timeOffset});
+    return QDateTime::fromSecsSinceEpoch(d->commitTime, QTimeZone{d->commitTimeOffset * 60});
 }
 
 QSharedPointer<Signature> Commit::author()
 {
     Q_D(Commit);
-    if (d->author.isNull()) {
-        auto sign = git_commit_author(d->gitCommitPtr);
-        d->author.reset(new Signature{sign});
-    }
-    return d->author;
+    auto extra = d->extra();
+    if (extra->author.isNull())
+        extra->author = d->signature(d->author, d->commitTime + d->authorTimeDelta, d->authorTimeOffset);
+    return extra->author;
 }
 
 QSharedPointer<Signature> Commit::committer()
 {
     Q_D(Commit);
-    if (d->committer.isNull()) {
-        auto committer = git_commit_committer(d->gitCommitPtr);
-        d->committer.reset(new Signature{committer});
-    }
-    return d->committer;
+    auto extra = d->extra();
+    if (extra->committer.isNull())
+        extra->committer = d->signature(d->committer, d->commitTime, d->commitTimeOffset);
+    return extra->committer;
+}
+
+QString Commit::subject() const
+{
+    Q_D(const Commit);
+    return QString::fromUtf8(d->pool->value(d->subject));
 }
 
 QString Commit::message() const
 {
     Q_D(const Commit);
-    return QString{git_commit_message(d->gitCommitPtr)}.remove(QLatin1Char('\n'));
+    auto commit = d->lookup();
+    if (!commit)
+        return {};
+
+    auto message = QString::fromUtf8(git_commit_message(commit)).remove(QLatin1Char('\n'));
+    git_commit_free(commit);
+    return message;
 }
 
 QString Commit::body() const
 {
     Q_D(const Commit);
-    return QString{git_commit_body(d->gitCommitPtr)}.remove(QLatin1Char('\n'));
+    auto commit = d->lookup();
+    if (!commit)
+        return {};
+
+    auto body = QString{git_commit_body(commit)}.remove(QLatin1Char('\n'));
+    git_commit_free(commit);
+    return body;
 }
 
-const QString &Commit::commitHash() const
+QString Commit::commitHash() const
 {
-    return mCommitHash;
+    Q_D(const Commit);
+    return d->id.toString();
 }
 
-const QStringList &Commit::parents() const
+QStringList Commit::parents() const
 {
     Q_D(const Commit);
-    return d->parentHashes;
+    QStringList list;
+    list.reserve(d->parentCount);
+    for (quint16 i = 0; i < d->parentCount; ++i)
+        list << d->links[i].toString();
+    return list;
 }
+
+QList<Oid> Commit::parentOids() const
+{
+    Q_D(const Commit);
+    return QList<Oid>(d->links, d->links + d->parentCount);
+}
+
 bool Commit::createNote(const QString &message)
 {
     Q_D(Commit);
+    auto commit = d->lookup();
+    if (!commit)
+        return false;
+
     git_oid oid;
-    auto repo = git_commit_owner(d->gitCommitPtr);
-    auto commitOid = git_commit_id(d->gitCommitPtr);
-    auto author = git_commit_author(d->gitCommitPtr);
-    auto committer = git_commit_committer(d->gitCommitPtr);
+    auto author = git_commit_author(commit);
+    auto committer = git_commit_committer(commit);
 
-    auto r = git_note_create(&oid, repo, NULL, author, committer, commitOid, message.toUtf8().data(), 1);
+    auto r = git_note_create(&oid, d->repo, NULL, author, committer, d->id.oidPtr(), message.toUtf8().data(), 1);
+    git_commit_free(commit);
     if (r) {
         const git_error *lg2err;
         if ((lg2err = git_error_last()) != NULL && lg2err->message != NULL) {
@@ -189,33 +243,133 @@ bool Commit::createNote(const QString &message)
     return !r;
 }
 
-QSharedPointer<Oid> Commit::oid() const
+Oid Commit::oid() const
 {
     Q_D(const Commit);
-    return QSharedPointer<Oid>{new Oid{git_commit_id(d->gitCommitPtr)}};
+    return d->id;
+}
+
+int Commit::parentCount() const
+{
+    Q_D(const Commit);
+    return d->parentCount;
+}
+
+const Oid &Commit::parentOid(int index) const
+{
+    Q_D(const Commit);
+    return d->links[index];
+}
+
+qint64 Commit::memoryUsage() const
+{
+    Q_D(const Commit);
+    qint64 size = sizeof(CommitPrivate) + (d->parentCount + d->childCount) * sizeof(Oid);
+    if (d->extraData)
+        size += sizeof(CommitExtra);
+    return size;
 }
 
 void Commit::clearChildren()
 {
     Q_D(Commit);
-    d->children.clear();
+    d->childCount = 0;
 }
 
 void Commit::setReferences(QList<QSharedPointer<Reference>> refs)
 {
     Q_D(Commit);
-    d->references = refs;
+    if (refs.isEmpty() && !d->extraData)
+        return;
+    d->extra()->references = refs;
 }
 
-void Commit::addChild(const QString &childHash)
+void Commit::addChild(const Oid &childOid)
 {
     Q_D(Commit);
-    d->children << childHash;
+    auto links = static_cast<Oid *>(std::realloc(d->links, (d->parentCount + d->childCount + 1) * sizeof(Oid)));
+    if (!links)
+        return;
+
+    d->links = links;
+    d->links[d->parentCount + d->childCount] = childOid;
+    ++d->childCount;
+}
+
+CommitPrivate::CommitPrivate(git_commit *commit)
+    : repo{git_commit_owner(commit)}
+    , pool{StringPool::of(repo)}
+    , commitTime{git_commit_time(commit)}
+    , id{git_commit_id(commit)}
+    , commitTimeOffset{static_cast<qint16>(git_commit_time_offset(commit))}
+    , parentCount{static_cast<quint16>(git_commit_parentcount(commit))}
+{
+    if (parentCount) {
+        links = static_cast<Oid *>(std::malloc(parentCount * sizeof(Oid)));
+        for (quint16 i = 0; i < parentCount; ++i)
+            links[i] = Oid{git_commit_parent_id(commit, i)};
+    }
+
+    auto authorSign = git_commit_author(commit);
+    auto committerSign = git_commit_committer(commit);
+    authorTimeDelta = static_cast<qint32>(authorSign->when.time - commitTime);
+    authorTimeOffset = static_cast<qint16>(authorSign->when.offset);
+    author = internIdentity(pool.data(), authorSign);
+    committer = internIdentity(pool.data(), committerSign);
+
+    const char *summary = git_commit_summary(commit);
+    if (!summary)
+        summary = "";
+    subject = pool->intern(summary, static_cast<int>(qstrlen(summary)));
+}
+
+CommitPrivate::CommitPrivate(git_repository *repo, const Oid &id, StringPool *pool)
+    : repo{repo}
+    , pool{pool}
+    , id{id}
+{
+}
+
+CommitPrivate::~CommitPrivate()
+{
+    std::free(links);
+    delete extraData;
+}
+
+git_commit *CommitPrivate::lookup() const
+{
+    git_commit *commit;
+    if (git_commit_lookup(&commit, repo, id.oidPtr()))
+        return nullptr;
+    return commit;
+}
+
+void CommitPrivate::setParents(const Oid *parents, int count)
+{
+    std::free(links);
+    links = nullptr;
+    childCount = 0;
+    parentCount = static_cast<quint16>(count);
+
+    if (count) {
+        links = static_cast<Oid *>(std::malloc(count * sizeof(Oid)));
+        std::copy(parents, parents + count, links);
+    }
+}
+
+CommitExtra *CommitPrivate::extra()
+{
+    if (!extraData)
+        extraData = new CommitExtra;
+    return extraData;
 }
 
-CommitPrivate::CommitPrivate(Commit *parent, git_commit *commit)
-    : q_ptr{parent}
-    , gitCommitPtr{commit}
+QSharedPointer<Signature> CommitPrivate::signature(quint32 identity, qint64 time, int offset) const
 {
+    const auto data = pool->value(identity);
+    const auto separator = data.indexOf('\0');
+    auto name = QString::fromUtf8(data.left(separator));
+    auto email = QString::fromUtf8(data.mid(separator + 1));
+    return QSharedPointer<Signature>{new Signature{name, email, QDateTime::fromSecsSinceEpoch(time, QTimeZone{offset * 60})}};
 }
 }
@@ -8,6 +8,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "interfaces.h"
 #include "libkommit_export.h"
+#include "oid.h"
 #include "reference.h"
 #include "signature.h"
 
@@ -30,18 +31,25 @@ class LIBKOMMIT_EXPORT Commit : public ITree, public IOid
 public:
     enum CommitType { NormalCommit, InitialCommit, ForkCommit, MergeCommit };
 
+    // Takes ownership of commit. Only a compact record is kept, the full object is looked up again
+    // when the message, body, tree or note is requested.
     explicit Commit(git_commit *commit);
     ~Commit();
 
     Q_REQUIRED_RESULT QSharedPointer<Signature> author();
     Q_REQUIRED_RESULT QSharedPointer<Signature> committer();
+    // First line of the message, kept in memory
+    Q_REQUIRED_RESULT QString subject() const;
+    // The whole message without line breaks
     Q_REQUIRED_RESULT QString message() const;
     Q_REQUIRED_RESULT QString body() const;
-    Q_REQUIRED_RESULT const QString &commitHash() const;
-    Q_REQUIRED_RESULT const QStringList &parents() const;
+    Q_REQUIRED_RESULT QString commitHash() const;
+    Q_REQUIRED_RESULT QStringList parents() const;
+    Q_REQUIRED_RESULT QList<Oid> parentOids() const;
     Q_REQUIRED_RESULT QSharedPointer<Branch> branch() const;
-    Q_REQUIRED_RESULT const QStringList &children() const;
-    Q_REQUIRED_RESULT const QString &commitShortHash() const;
+    Q_REQUIRED_RESULT QStringList children() const;
+    Q_REQUIRED_RESULT QList<Oid> childOids() const;
+    Q_REQUIRED_RESULT QString commitShortHash() const;
     Q_REQUIRED_RESULT QDateTime commitTime() const;
 
     Q_REQUIRED_RESULT QList<QSharedPointer<Reference>> references() const;
@@ -53,21 +61,25 @@ public:
 
     Q_REQUIRED_RESULT QSharedPointer<Note> note();
     bool createNote(const QString &message);
-    QSharedPointer<Oid> oid() const override;
+    Oid oid() const override;
 
 private:
+    explicit Commit(CommitPrivate *d);
+
     CommitPrivate *d_ptr;
     Q_DECLARE_PRIVATE(Commit);
 
-    QString mCommitHash;
-    QString mCommitShortHash;
+    int parentCount() const;
+    const Oid &parentOid(int index) const;
+    qint64 memoryUsage() const;
 
     void clearChildren();
     void setReferences(QList<QSharedPointer<Reference>> refs);
-    void addChild(const QString &childHash);
+    void addChild(const Oid &childOid);
 
     friend class LogList;
     friend class Manager;
     friend class CommitsCache;
+    friend class CommitIndex;
 };
 }
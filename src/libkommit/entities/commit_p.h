@@ -0,0 +1,68 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "caches/stringpool.h"
+#include "commit.h"
+#include "oid.h"
+
+#include <git2/types.h>
+
+namespace Git
+{
+
+class Note;
+class Branch;
+class Reference;
+class Signature;
+
+// Rarely needed data, only allocated once something asks for it
+struct CommitExtra {
+    ~CommitExtra();
+
+    git_commit *commit{nullptr};
+    QSharedPointer<Signature> author;
+    QSharedPointer<Signature> committer;
+    QSharedPointer<Note> note;
+    QSharedPointer<Branch> branch;
+    QList<QSharedPointer<Reference>> references;
+};
+
+class CommitPrivate
+{
+public:
+    explicit CommitPrivate(git_commit *commit);
+    CommitPrivate(git_repository *repo, const Oid &id, StringPool *pool);
+    ~CommitPrivate();
+
+    Q_REQUIRED_RESULT git_commit *lookup() const;
+    CommitExtra *extra();
+    QSharedPointer<Signature> signature(quint32 identity, qint64 time, int offset) const;
+    void setParents(const Oid *parents, int count);
+
+    git_repository *repo;
+    // holds subject, author and committer
+    StringPoolPointer pool;
+    CommitExtra *extraData{nullptr};
+    // parents followed by children
+    Oid *links{nullptr};
+    qint64 commitTime{0};
+    Oid id;
+    qint32 authorTimeDelta{0};
+    qint16 commitTimeOffset{0};
+    qint16 authorTimeOffset{0};
+    // offsets into pool
+    quint32 subject{0};
+    quint32 author{0};
+    quint32 committer{0};
+    quint32 childCount{0};
+    quint16 parentCount{0};
+};
+
+static_assert(sizeof(CommitPrivate) <= 88, "CommitPrivate is kept for every commit in the history, keep it small");
+
+}
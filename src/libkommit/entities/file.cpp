@@ -6,6 +6,8 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "entities/file.h"
 #include "../gitmanager.h"
+#include "caches/blobscache.h"
+#include "entities/blob.h"
 #include "gitglobal_p.h"
 
 #include <QFile>
@@ -131,17 +133,13 @@ bool File::save(const QString &path) const
     QFile f{path};
     if (!f.open(QIODevice::WriteOnly))
         return false;
-    if (mStorage == Entry) {
-        git_blob *blob;
-        BEGIN
-        STEP git_blob_lookup(&blob, mRepo, git_tree_entry_id(mEntry));
-
-        if (IS_ERROR)
+    if (mStorage == Entry || mStorage == Git) {
+        const auto blob = this->blob();
+        if (!blob)
             return false;
-        f.write((char *)git_blob_rawcontent(blob), git_blob_rawsize(blob));
+        f.write(blob->data());
     } else {
-        const auto buffer = content(); // mGit->runGit({QStringLiteral("show"), mPlace + QLatin1Char(':') + mFilePath});
-        f.write(buffer.toUtf8());
+        f.write(content().toUtf8());
     }
     f.close();
     return true;
@@ -174,45 +172,34 @@ QString File::content() const
         return f.readAll();
     }
     case Git:
-    case Entry:
-        return stringContent(); // mGit->fileContent(mPlace, mFilePath); // mGit->runGit({QStringLiteral("show"), mPlace + QLatin1Char(':') + mFilePath});
+    case Entry: {
+        const auto blob = this->blob();
+        return blob ? blob->text() : QString{};
+    }
     }
 
     return {};
 }
 
-QString File::stringContent() const
+QSharedPointer<Blob> File::blob() const
 {
-    git_object *placeObject{nullptr};
-    git_commit *commit{nullptr};
-    git_tree *tree{nullptr};
-    git_tree_entry *entry{nullptr};
-    git_blob *blob{nullptr};
-
-    BEGIN
-    if (mEntry) {
-        STEP git_blob_lookup(&blob, mRepo, git_tree_entry_id(mEntry));
-    } else {
-        STEP git_revparse_single(&placeObject, mGit->repoPtr(), toConstChars(mPlace));
-        STEP git_commit_lookup(&commit, mGit->repoPtr(), git_object_id(placeObject));
-        STEP git_commit_tree(&tree, commit);
+    switch (mStorage) {
+    case Git:
+        return mGit->blobs()->find(mPlace, mFilePath);
+    case Entry: {
+        if (auto manager = Manager::owner(mRepo))
+            return manager->blobs()->findByOid(git_tree_entry_id(mEntry));
 
-        STEP git_tree_entry_bypath(&entry, tree, toConstChars(mFilePath));
-        STEP git_blob_lookup(&blob, mGit->repoPtr(), git_tree_entry_id(entry));
+        git_blob *blob{nullptr};
+        if (git_blob_lookup(&blob, mRepo, git_tree_entry_id(mEntry)))
+            return {};
+        return QSharedPointer<Blob>{new Blob{blob}};
     }
-
-    if (IS_ERROR)
-        return {};
-
-    QString ch = (char *)git_blob_rawcontent(blob);
-
-    git_object_free(placeObject);
-    git_commit_free(commit);
-    git_blob_free(blob);
-    git_tree_entry_free(entry);
-    git_tree_free(tree);
-
-    return ch;
+    case Local:
+    case InValid:
+        break;
+    }
+    return {};
 }
 
 } // namespace Git
@@ -7,6 +7,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
 
 #include "libkommit_export.h"
+#include <QSharedPointer>
 #include <QString>
 
 #include <git2/types.h>
@@ -15,6 +16,7 @@ namespace Git
 {
 
 class Manager;
+class Blob;
 class LIBKOMMIT_EXPORT File
 {
 public:
@@ -33,6 +35,8 @@ public:
     Q_REQUIRED_RESULT QString saveAsTemp() const;
 
     Q_REQUIRED_RESULT QString content() const;
+    // Shared with every other view of the same content, null for local files
+    Q_REQUIRED_RESULT QSharedPointer<Blob> blob() const;
     Q_REQUIRED_RESULT const QString &place() const;
     void setPlace(const QString &newPlace);
     Q_REQUIRED_RESULT QString fileName() const;
@@ -51,8 +55,6 @@ private:
     Manager *mGit = nullptr;
 
     StorageType mStorage;
-
-    QString stringContent() const;
 };
 
 } // namespace Git
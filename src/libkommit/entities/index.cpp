@@ -6,14 +6,132 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "entities/index.h"
 
+#include "gitmanager.h"
 #include "types.h"
 
+#include <git2/blob.h>
+#include <git2/config.h>
 #include <git2/index.h>
+#include <git2/repository.h>
 #include <git2/tree.h>
 
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+
+#include <atomic>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
 namespace Git
 {
 
+namespace
+{
+
+struct StagedFile {
+    QByteArray path;
+    git_index_entry entry{};
+    bool executable{false};
+    bool hashed{false};
+};
+
+QByteArray indexPath(const QString &path)
+{
+    return path.startsWith(QLatin1Char('/')) ? path.mid(1).toUtf8() : path.toUtf8();
+}
+
+// Fills the stat data of a regular file, so the next status does not hash it again
+bool readStat(const QString &path, StagedFile &file)
+{
+#ifdef Q_OS_UNIX
+    struct stat st;
+    if (::lstat(QFile::encodeName(path).constData(), &st) || !S_ISREG(st.st_mode))
+        return false;
+
+    file.entry.ctime.seconds = static_cast<int32_t>(st.st_ctime);
+    file.entry.mtime.seconds = static_cast<int32_t>(st.st_mtime);
+#if defined(Q_OS_LINUX)
+    file.entry.ctime.nanoseconds = static_cast<uint32_t>(st.st_ctim.tv_nsec);
+    file.entry.mtime.nanoseconds = static_cast<uint32_t>(st.st_mtim.tv_nsec);
+#elif defined(Q_OS_DARWIN)
+    file.entry.ctime.nanoseconds = static_cast<uint32_t>(st.st_ctimespec.tv_nsec);
+    file.entry.mtime.nanoseconds = static_cast<uint32_t>(st.st_mtimespec.tv_nsec);
+#endif
+    file.entry.dev = static_cast<uint32_t>(st.st_dev);
+    file.entry.ino = static_cast<uint32_t>(st.st_ino);
+    file.entry.uid = static_cast<uint32_t>(st.st_uid);
+    file.entry.gid = static_cast<uint32_t>(st.st_gid);
+    file.entry.file_size = static_cast<uint32_t>(st.st_size);
+    file.executable = st.st_mode & S_IXUSR;
+#else
+    const QFileInfo info{path};
+    if (!info.isFile() || info.isSymLink())
+        return false;
+
+    const auto ctime = info.metadataChangeTime().toMSecsSinceEpoch();
+    const auto mtime = info.lastModified().toMSecsSinceEpoch();
+    file.entry.ctime.seconds = static_cast<int32_t>(ctime / 1000);
+    file.entry.ctime.nanoseconds = static_cast<uint32_t>(ctime % 1000 * 1000000);
+    file.entry.mtime.seconds = static_cast<int32_t>(mtime / 1000);
+    file.entry.mtime.nanoseconds = static_cast<uint32_t>(mtime % 1000 * 1000000);
+    file.entry.file_size = static_cast<uint32_t>(info.size());
+    file.executable = info.isExecutable();
+#endif
+    return true;
+}
+
+bool isConflicted(git_index *index, const QByteArray &path)
+{
+    for (int stage = 1; stage <= 3; ++stage)
+        if (git_index_get_bypath(index, path.constData(), stage))
+            return true;
+    return false;
+}
+
+bool trustsFileMode(git_repository *repo)
+{
+    git_config *config{nullptr};
+    int trust{1};
+    if (!git_repository_config_snapshot(&config, repo)) {
+        if (git_config_get_bool(&trust, config, "core.filemode"))
+            trust = 1;
+        git_config_free(config);
+    }
+    return trust;
+}
+
+// Writes the blobs of the files, spread over the worker handles of the repository's manager
+void hashFiles(git_repository *repo, QList<StagedFile> &files)
+{
+    const auto data = files.data();
+    const auto count = static_cast<int>(files.size());
+    std::atomic_int next{0};
+
+    const auto hash = [data, count, &next](git_repository *repo) {
+        for (int i = next++; i < count; i = next++)
+            data[i].hashed = !git_blob_create_from_workdir(&data[i].entry.id, repo, data[i].path.constData());
+    };
+
+    const auto manager = Manager::owner(repo);
+    if (!manager || count < 2) {
+        hash(repo);
+        return;
+    }
+
+    auto jobs = manager->runParallel(count, [&hash](Manager *git, int, int) {
+        hash(git->repoPtr());
+    });
+    for (auto &job : jobs)
+        job.waitForFinished();
+}
+
+}
+
 Index::Index(git_index *index)
     : ptr{index}
 {
@@ -39,6 +157,81 @@ bool Index::removeAll() const
     return !git_index_remove_all(ptr, &arr, NULL, NULL);
 }
 
+bool Index::begin()
+{
+    return !git_index_read(ptr, false);
+}
+
+bool Index::addPaths(const QStringList &paths) const
+{
+    const auto repo = git_index_owner(ptr);
+    if (!repo || git_repository_is_bare(repo))
+        return false;
+
+    const QDir workdir{QString::fromUtf8(git_repository_workdir(repo))};
+    QList<StagedFile> files;
+    QList<QByteArray> others;
+
+    // regular files are hashed in parallel, links, submodules and conflicts are left to libgit2
+    for (const auto &path : paths) {
+        StagedFile file;
+        file.path = indexPath(path);
+        if (isConflicted(ptr, file.path) || !readStat(workdir.filePath(QString::fromUtf8(file.path)), file))
+            others << file.path;
+        else
+            files << file;
+    }
+
+    hashFiles(repo, files);
+
+    const auto trustMode = trustsFileMode(repo);
+    bool ok{true};
+    for (auto &file : files) {
+        if (!file.hashed) {
+            ok = false;
+            continue;
+        }
+
+        const auto existing = git_index_get_bypath(ptr, file.path.constData(), 0);
+        if (trustMode || !existing)
+            file.entry.mode = trustMode && file.executable ? GIT_FILEMODE_BLOB_EXECUTABLE : GIT_FILEMODE_BLOB;
+        else
+            file.entry.mode = existing->mode == GIT_FILEMODE_BLOB_EXECUTABLE ? GIT_FILEMODE_BLOB_EXECUTABLE : GIT_FILEMODE_BLOB;
+        file.entry.path = file.path.constData();
+
+        if (git_index_add(ptr, &file.entry))
+            ok = false;
+    }
+
+    for (const auto &path : std::as_const(others)) {
+        const QFileInfo info{workdir.filePath(QString::fromUtf8(path))};
+        if (info.exists() || info.isSymLink())
+            ok &= !git_index_add_bypath(ptr, path.constData());
+        else
+            ok &= !git_index_remove_bypath(ptr, path.constData());
+    }
+
+    return ok;
+}
+
+bool Index::removePaths(const QStringList &paths) const
+{
+    bool ok{true};
+    for (const auto &path : paths)
+        ok &= !git_index_remove_bypath(ptr, indexPath(path).constData());
+    return ok;
+}
+
+bool Index::commit()
+{
+    return write();
+}
+
+bool Index::rollback()
+{
+    return !git_index_read(ptr, true);
+}
+
 bool Index::write()
 {
     return !git_index_write(ptr);
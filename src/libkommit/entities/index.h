@@ -9,6 +9,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include <git2/types.h>
 
 #include <QString>
+#include <QStringList>
 
 #include "entities/tree.h"
 #include "libkommit_export.h"
@@ -16,6 +17,11 @@ SPDX-License-Identifier: GPL-3.0-or-later
 namespace Git
 {
 
+/**
+ * Changes to the index stay in memory until write() or commit(). Staging many files goes best
+ * as one transaction: begin(), then addPaths() and removePaths() as often as needed, then commit()
+ * writes the index file once.
+ */
 class LIBKOMMIT_EXPORT Index
 {
 public:
@@ -25,6 +31,16 @@ public:
     bool removeByPath(const QString &path) const;
     bool removeAll() const;
 
+    // Reloads the index if it changed on disk since it was read
+    bool begin();
+    // Stages the work tree state of paths, the files are hashed on the worker pool of the
+    // repository's manager. A path that is gone from the work tree is removed.
+    bool addPaths(const QStringList &paths) const;
+    bool removePaths(const QStringList &paths) const;
+    bool commit();
+    // Drops the changes made since the index was last read or written
+    bool rollback();
+
     bool write();
     QSharedPointer<Tree> tree() const;
 
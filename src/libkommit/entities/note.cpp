@@ -38,8 +38,8 @@ QString Note::message() const
     return mMesage;
 }
 
-QSharedPointer<Oid> Note::oid() const
+Oid Note::oid() const
 {
-    return QSharedPointer<Oid>{new Oid{git_note_id(mNote)}};
+    return Oid{git_note_id(mNote)};
 }
 }
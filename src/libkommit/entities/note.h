@@ -27,7 +27,7 @@ public:
     Q_REQUIRED_RESULT QSharedPointer<Signature> author() const;
     Q_REQUIRED_RESULT QSharedPointer<Signature> committer() const;
     Q_REQUIRED_RESULT QString message() const;
-    QSharedPointer<Oid> oid() const override;
+    Oid oid() const override;
 
 private:
     git_note *const mNote;
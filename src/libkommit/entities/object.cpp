@@ -31,9 +31,9 @@ Object::Type Object::type() const
     return static_cast<Type>(git_object_type(mGitObjectPtr));
 }
 
-QSharedPointer<Oid> Object::id() const
+Oid Object::id() const
 {
-    return QSharedPointer<Oid>{new Oid{git_object_id(mGitObjectPtr)}};
+    return Oid{git_object_id(mGitObjectPtr)};
 }
 
 QSharedPointer<Note> Object::toNote() const
@@ -6,6 +6,8 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #pragma once
 
+#include "oid.h"
+
 #include <git2/types.h>
 
 #include <QSharedPointer>
@@ -15,7 +17,6 @@ namespace Git
 
 class Note;
 class Tag;
-class Oid;
 class Tree;
 class Commit;
 
@@ -37,7 +38,7 @@ public:
 
     [[nodiscard]] Type type() const;
 
-    QSharedPointer<Oid> id() const;
+    Oid id() const;
     Q_REQUIRED_RESULT QSharedPointer<Note> toNote() const;
     Q_REQUIRED_RESULT QSharedPointer<Tag> toTag() const;
     Q_REQUIRED_RESULT QSharedPointer<Tree> toTree() const;
@@ -15,28 +15,64 @@ namespace Git
 {
 
 Oid::Oid(const git_oid *oid)
-    : mOidPtr{oid}
 {
+    if (oid)
+        git_oid_cpy(&mOid, oid);
+}
+
+Oid::Oid(const git_oid &oid)
+    : mOid{oid}
+{
+}
+
+Oid Oid::fromString(const QString &hash)
+{
+    Oid oid;
+    if (hash.isEmpty() || hash.size() > GIT_OID_SHA1_HEXSIZE)
+        return oid;
+
+    const auto str = hash.toLatin1();
+    if (git_oid_fromstrn(&oid.mOid, str.constData(), str.size()))
+        return Oid{};
+    return oid;
 }
 
 QString Oid::toString() const
 {
     char str[GIT_OID_SHA1_HEXSIZE + 1];
-    if (git_oid_fmt(str, mOidPtr))
-        return {};
-    str[GIT_OID_SHA1_HEXSIZE] = '\0';
+    git_oid_tostr(str, sizeof(str), &mOid);
+    return QString::fromLatin1(str);
+}
 
-    return QString{str};
+QString Oid::toShortString(int length) const
+{
+    char str[GIT_OID_SHA1_HEXSIZE + 1];
+    git_oid_tostr(str, qBound(1, length, GIT_OID_SHA1_HEXSIZE) + 1, &mOid);
+    return QString::fromLatin1(str);
 }
 
 bool Oid::isNull() const
 {
-    return git_oid_is_zero(mOidPtr);
+    return git_oid_is_zero(&mOid);
+}
+
+bool Oid::startsWith(const Oid &prefix, int length) const
+{
+    return !git_oid_ncmp(&mOid, &prefix.mOid, length);
+}
+
+bool Oid::startsWith(const QString &prefix) const
+{
+    if (prefix.isEmpty())
+        return true;
+
+    auto prefixOid = fromString(prefix);
+    return !prefixOid.isNull() && startsWith(prefixOid, prefix.size());
 }
 
-const git_oid *Oid::oidPtr() const
+int Oid::compare(const Oid &other) const
 {
-    return mOidPtr;
+    return git_oid_cmp(&mOid, &other.mOid);
 }
 }
 
@@ -8,27 +8,107 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <git2/oid.h>
 
+#include <QMetaType>
 #include <QString>
 
+#include <cstring>
+#include <functional>
+
 #include "libkommit_export.h"
 
 namespace Git
 {
 
+namespace Impl
+{
+
+inline size_t oidHash(const git_oid *oid)
+{
+    // object ids are cryptographic hashes, so any slice of them is already well distributed
+    size_t h;
+    std::memcpy(&h, oid->id, sizeof(h));
+    return h;
+}
+
+}
+
+/**
+ * Object id held by value.
+ *
+ * Same size as git_oid and trivially copyable, so it can be used as a hash key or stored in bulk
+ * without allocating. Use toString() only for display.
+ */
 class LIBKOMMIT_EXPORT Oid
 {
 public:
+    Oid() = default;
     explicit Oid(const git_oid *oid);
+    explicit Oid(const git_oid &oid);
+
+    // Accepts full hashes as well as prefixes, returns a null oid for invalid input
+    Q_REQUIRED_RESULT static Oid fromString(const QString &hash);
 
     Q_REQUIRED_RESULT QString toString() const;
+    Q_REQUIRED_RESULT QString toShortString(int length = 7) const;
     Q_REQUIRED_RESULT bool isNull() const;
 
+    Q_REQUIRED_RESULT bool startsWith(const Oid &prefix, int length) const;
+    Q_REQUIRED_RESULT bool startsWith(const QString &prefix) const;
+
+    Q_REQUIRED_RESULT int compare(const Oid &other) const;
+    Q_REQUIRED_RESULT size_t hash() const;
+
     Q_REQUIRED_RESULT const git_oid *oidPtr() const;
 
 private:
-    const git_oid *mOidPtr;
+    git_oid mOid{};
+};
+
+inline bool operator==(const Oid &l, const Oid &r)
+{
+    return git_oid_equal(l.oidPtr(), r.oidPtr());
+}
+
+inline bool operator!=(const Oid &l, const Oid &r)
+{
+    return !git_oid_equal(l.oidPtr(), r.oidPtr());
+}
+
+inline bool operator<(const Oid &l, const Oid &r)
+{
+    return l.compare(r) < 0;
+}
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+inline uint qHash(const Oid &oid, uint seed = 0)
+#else
+inline size_t qHash(const Oid &oid, size_t seed = 0)
+#endif
+{
+    return static_cast<decltype(seed)>(oid.hash()) ^ seed;
+}
+
+inline size_t Oid::hash() const
+{
+    return Impl::oidHash(&mOid);
+}
+
+inline const git_oid *Oid::oidPtr() const
+{
+    return &mOid;
+}
+
 };
 
+Q_DECLARE_TYPEINFO(Git::Oid, Q_PRIMITIVE_TYPE);
+Q_DECLARE_METATYPE(Git::Oid)
+
+template<>
+struct std::hash<Git::Oid> {
+    size_t operator()(const Git::Oid &oid) const noexcept
+    {
+        return oid.hash();
+    }
 };
 
 bool operator==(const Git::Oid &oid, const QString &hash);
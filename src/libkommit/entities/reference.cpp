@@ -76,10 +76,9 @@ Reference::Type Reference::type() const
     return static_cast<Type>(git_reference_type(ptr));
 }
 
-QSharedPointer<Oid> Reference::target() const
+Oid Reference::target() const
 {
-    auto oid = git_reference_target(ptr);
-    return QSharedPointer<Oid>{new Oid{oid}};
+    return Oid{git_reference_target(ptr)};
 }
 
 QSharedPointer<Object> Reference::peel(Object::Type type) const
@@ -21,7 +21,6 @@ class Note;
 class Branch;
 class Tag;
 class Remote;
-class Oid;
 
 class LIBKOMMIT_EXPORT Reference
 {
@@ -39,7 +38,7 @@ public:
     Q_REQUIRED_RESULT QString name() const;
     Q_REQUIRED_RESULT QString shorthand() const;
     Q_REQUIRED_RESULT Type type() const;
-    [[nodiscard]] QSharedPointer<Oid> target() const;
+    [[nodiscard]] Oid target() const;
 
     QSharedPointer<Object> peel(Object::Type type) const;
 
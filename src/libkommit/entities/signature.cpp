@@ -30,6 +30,13 @@ Signature::Signature(const git_signature *signature)
     mTime = QDateTime::fromSecsSinceEpoch(signature->when.time, timeZone);
 }
 
+Signature::Signature(const QString &name, const QString &email, const QDateTime &time)
+    : mName{name}
+    , mEmail{email}
+    , mTime{time}
+{
+}
+
 Signature::~Signature()
 {
     git_signature_free(mSignature);
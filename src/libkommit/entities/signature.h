@@ -21,6 +21,7 @@ class LIBKOMMIT_EXPORT Signature
 public:
     explicit Signature(git_signature *signature);
     explicit Signature(const git_signature *signature);
+    Signature(const QString &name, const QString &email, const QDateTime &time);
     ~Signature();
 
     Q_REQUIRED_RESULT QString name() const;
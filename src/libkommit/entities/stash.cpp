@@ -74,10 +74,10 @@ size_t Stash::index() const
     return d->index;
 }
 
-QSharedPointer<Oid> Stash::oid() const
+Oid Stash::oid() const
 {
     Q_D(const Stash);
-    return QSharedPointer<Oid>{new Oid{&d->stash_id}};
+    return Oid{d->stash_id};
 }
 
 StashPrivate::StashPrivate(Stash *parent)
@@ -30,7 +30,7 @@ public:
     Q_REQUIRED_RESULT const QString &message() const;
     Q_REQUIRED_RESULT QSharedPointer<Commit> commit();
     Q_REQUIRED_RESULT size_t index() const;
-    Q_REQUIRED_RESULT QSharedPointer<Oid> oid() const override;
+    Q_REQUIRED_RESULT Oid oid() const override;
 
 private:
     StashPrivate *d_ptr;
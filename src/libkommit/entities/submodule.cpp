@@ -168,25 +168,25 @@ bool Submodule::hasModifiedFiles() const
     RETURN_COND(GIT_SUBMODULE_STATUS_IS_WD_DIRTY(status), false);
 }
 
-QSharedPointer<Oid> Submodule::headId()
+Oid Submodule::headId()
 {
     Q_D(Submodule);
     auto submodule = d->find();
-    return QSharedPointer<Oid>{new Oid{git_submodule_head_id(submodule.get())}};
+    return Oid{git_submodule_head_id(submodule.get())};
 }
 
-QSharedPointer<Oid> Submodule::indexId()
+Oid Submodule::indexId()
 {
     Q_D(Submodule);
     auto submodule = d->find();
-    return QSharedPointer<Oid>{new Oid{git_submodule_index_id(submodule.get())}};
+    return Oid{git_submodule_index_id(submodule.get())};
 }
 
-QSharedPointer<Oid> Submodule::workingDirectoryId()
+Oid Submodule::workingDirectoryId()
 {
     Q_D(Submodule);
     auto submodule = d->find();
-    return QSharedPointer<Oid>{new Oid{git_submodule_wd_id(submodule.get())}};
+    return Oid{git_submodule_wd_id(submodule.get())};
 }
 
 bool Submodule::sync() const
@@ -7,6 +7,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
 
 #include "libkommit_export.h"
+#include "oid.h"
 
 #include <git2/submodule.h>
 #include <git2/types.h>
@@ -21,7 +22,6 @@ class FetchOptions;
 
 class FetchObserver;
 
-class Oid;
 class Manager;
 class SubmodulePrivate;
 class LIBKOMMIT_EXPORT Submodule
@@ -63,9 +63,9 @@ public:
 
     Q_REQUIRED_RESULT bool hasModifiedFiles() const;
 
-    Q_REQUIRED_RESULT QSharedPointer<Oid> headId();
-    Q_REQUIRED_RESULT QSharedPointer<Oid> indexId();
-    Q_REQUIRED_RESULT QSharedPointer<Oid> workingDirectoryId();
+    Q_REQUIRED_RESULT Oid headId();
+    Q_REQUIRED_RESULT Oid indexId();
+    Q_REQUIRED_RESULT Oid workingDirectoryId();
 
     void setUrl(const QString &newUrl);
     bool sync() const;
@@ -6,6 +6,8 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "tag.h"
 
+#include "caches/commitscache.h"
+#include "gitmanager.h"
 #include "oid.h"
 
 #include <git2/commit.h>
@@ -78,12 +80,8 @@ QSharedPointer<Commit> Tag::commit() const
     if (type != GIT_OBJECT_COMMIT)
         return {};
 
-    git_commit *commit;
-    auto id = git_tag_target_id(mTagPtr);
-    if (git_commit_lookup(&commit, git_tag_owner(mTagPtr), id))
-        return {};
-
-    return QSharedPointer<Commit>(new Commit{commit});
+    auto manager = Manager::owner(git_tag_owner(mTagPtr));
+    return manager->commits()->findByOid(git_tag_target_id(mTagPtr));
 }
 
 Tag::TagType Tag::tagType() const
@@ -91,9 +89,12 @@ Tag::TagType Tag::tagType() const
     return mTagType;
 }
 
-QSharedPointer<Oid> Tag::oid() const
+Oid Tag::oid() const
 {
-    return QSharedPointer<Oid>(new Oid{git_tag_id(mTagPtr)});
+    if (mTagType == TagType::LightTag)
+        return mLightTagCommit->oid();
+
+    return Oid{git_tag_id(mTagPtr)};
 }
 
 git_tag *Tag::tagPtr() const
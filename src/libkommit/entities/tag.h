@@ -41,7 +41,7 @@ public:
     QSharedPointer<Commit> commit() const;
 
     Q_REQUIRED_RESULT TagType tagType() const;
-    QSharedPointer<Oid> oid() const override;
+    Oid oid() const override;
 
     Q_REQUIRED_RESULT git_tag *tagPtr() const;
 
@@ -5,20 +5,105 @@ SPDX-License-Identifier: GPL-3.0-or-later
 */
 
 #include "tree.h"
+#include "caches/treescache.h"
 #include "gitglobal_p.h"
+#include "gitmanager.h"
 #include "oid.h"
 #include "qdebug.h"
+#include "treewalker.h"
 #include "types.h"
 
+#include <git2/blob.h>
 #include <git2/commit.h>
 #include <git2/tree.h>
 
 #include <QDir>
 #include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QPointer>
+#include <QWaitCondition>
+
+#include <atomic>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
 
 namespace Git
 {
 
+namespace
+{
+
+QString directoryPath(const QString &path)
+{
+    qsizetype begin{0};
+    auto end = path.size();
+    while (begin < end && path.at(begin) == QLatin1Char('/'))
+        ++begin;
+    while (end > begin && path.at(end - 1) == QLatin1Char('/'))
+        --end;
+    return path.mid(begin, end - begin);
+}
+
+// A blob and the files of an extraction that get its content
+struct ExtractedBlob {
+    Oid blob;
+    bool executable;
+    QStringList paths;
+};
+
+bool writeFile(const QString &path, const char *data, qint64 size, bool executable)
+{
+    QFile file{path};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    const auto ok = file.write(data, size) == size;
+    if (executable)
+        file.setPermissions(file.permissions() | QFileDevice::ExeOwner | QFileDevice::ExeGroup | QFileDevice::ExeOther);
+    return ok;
+}
+
+// A hard link where the file system has them, else a copy, which clones the data where it can
+bool linkFile(const QString &existing, const QString &path)
+{
+    QFile::remove(path);
+#ifdef Q_OS_UNIX
+    if (!::link(QFile::encodeName(existing).constData(), QFile::encodeName(path).constData()))
+        return true;
+#endif
+    return QFile::copy(existing, path);
+}
+
+bool writeBlob(git_repository *repo, const ExtractedBlob &blob, bool linkDuplicates)
+{
+    git_blob *gitBlob{nullptr};
+    if (git_blob_lookup(&gitBlob, repo, blob.blob.oidPtr()))
+        return false;
+
+    const auto data = static_cast<const char *>(git_blob_rawcontent(gitBlob));
+    const auto size = static_cast<qint64>(git_blob_rawsize(gitBlob));
+
+    bool ok{true};
+    bool firstWritten{false};
+    for (const auto &path : blob.paths) {
+        if (linkDuplicates && firstWritten && linkFile(blob.paths.first(), path))
+            continue;
+
+        const auto fileWritten = writeFile(path, data, size, blob.executable);
+        if (path == blob.paths.first())
+            firstWritten = fileWritten;
+        ok = ok && fileWritten;
+    }
+
+    git_blob_free(gitBlob);
+    return ok;
+}
+
+}
+
 class TreePrivate
 {
 public:
@@ -26,20 +111,23 @@ public:
     Tree *q_ptr;
     Q_DECLARE_PUBLIC(Tree);
 
-    QList<Tree::Entry *> entries;
-    QMultiMap<QString, Tree::Entry> treeData;
-
     git_tree *gitTreePtr{nullptr};
+    // subtrees come from its trees cache, there is none for a repository opened without a manager
+    QPointer<Manager> manager;
 
-    void initTree();
+    // the entries of this level only, listed on first use
+    mutable bool listed{false};
+    mutable QList<Tree::Entry> level;
+    mutable QHash<QString, Oid> subtrees;
+
+    void list() const;
+    QSharedPointer<Tree> lookup(const Oid &oid) const;
     void browseNestedEntities(Tree::EntryType type, const QString &path, QStringList &list) const;
 };
 
 Tree::Tree(git_tree *tree)
     : d_ptr{new TreePrivate{this, tree}}
 {
-    Q_D(Tree);
-    d->initTree();
 }
 
 Tree::~Tree()
@@ -53,7 +141,21 @@ Tree::~Tree()
 QList<Tree::Entry> Tree::entries(const QString &path) const
 {
     Q_D(const Tree);
-    return d->treeData.values(path);
+
+    const auto directory = directoryPath(path);
+    if (directory.isEmpty()) {
+        d->list();
+        return d->level;
+    }
+
+    const auto tree = subtree(directory);
+    if (!tree)
+        return {};
+
+    auto entries = tree->entries(QString{});
+    for (auto &entry : entries)
+        entry.path = directory;
+    return entries;
 }
 
 QStringList Tree::entries(const QString &path, EntryType filter) const
@@ -77,6 +179,27 @@ QStringList Tree::entries(EntryType filter) const
     return list;
 }
 
+QSharedPointer<Tree> Tree::subtree(const QString &path) const
+{
+    Q_D(const Tree);
+
+    const auto directory = directoryPath(path);
+    if (directory.isEmpty())
+        return {};
+
+    // one level at a time, only the directories on the way are listed
+    const auto slash = directory.indexOf(QLatin1Char('/'));
+    d->list();
+    auto it = d->subtrees.constFind(slash == -1 ? directory : directory.left(slash));
+    if (it == d->subtrees.cend())
+        return {};
+
+    auto tree = d->lookup(*it);
+    if (!tree || slash == -1)
+        return tree;
+    return tree->subtree(directory.mid(slash + 1));
+}
+
 QSharedPointer<File> Tree::file(const QString &path)
 {
     Q_D(Tree);
@@ -102,86 +225,132 @@ git_tree *Tree::gitTree() const
 
 bool Tree::extract(const QString &destinationFolder, const QString &prefix)
 {
-    Q_D(Tree);
-    struct wrapper {
-        QString destinationFolder;
-        QString prefix;
-        Tree *tree = nullptr;
-    };
-
-    auto cb = [](const char *root, const git_tree_entry *entry, void *payload) -> int {
-        auto type = git_tree_entry_type(entry);
-
-        if (type != GIT_OBJECT_BLOB)
-            return 0;
-
-        auto w = reinterpret_cast<wrapper *>(payload);
-        QString path{root};
-        // if (path.endsWith("/"))
-        // path = path.mid(0, path.lastIndexOf("/"));
-
-        if (!path.endsWith(QLatin1Char('/')))
-            path = path.append(QLatin1Char('/'));
-        if (!path.startsWith(QLatin1Char('/')))
-            path = path.prepend(QLatin1Char('/'));
-
-        QString name{git_tree_entry_name(entry)};
-
-        if (path.startsWith(w->prefix)) {
-            qDebug() << "Path=" << path;
-            auto newFilePath = w->destinationFolder + QLatin1Char('/') + path.mid(w->prefix.size()) + QLatin1Char('/') + name;
-            QFileInfo fi{newFilePath};
-            QDir d;
-            d.mkpath(fi.absolutePath());
-            QSharedPointer<File> file;
+    return extract(destinationFolder, prefix, ExtractOptions{});
+}
 
-            file = w->tree->file(path + name);
+bool Tree::extract(const QString &destinationFolder, const QString &prefix, const ExtractOptions &options)
+{
+    Q_D(Tree);
 
-            if (file.isNull()) {
-                qDebug() << "File is null" << path << name;
-                return 1;
+    if (!d->gitTreePtr || !QDir{}.mkpath(destinationFolder))
+        return false;
+
+    // one walk finds the directories to create and the blobs to write, each blob is read once
+    const auto directory = directoryPath(prefix);
+    const QDir root{destinationFolder};
+    QList<ExtractedBlob> blobs;
+    QHash<QPair<Oid, int>, int> blobIndex;
+    int total{0};
+
+    const auto walked = TreeWalker{d->gitTreePtr}.walk(
+        [&](const TreeWalker::Entry &entry) {
+            auto path = directory.isEmpty() ? entry.path() : entry.path().mid(directory.size() + 1);
+            if (path.isEmpty())
+                path = entry.name();
+
+            // parents come first, so every directory is a single mkdir
+            if (entry.isDir()) {
+                root.mkdir(path);
+                return TreeWalker::Action::Continue;
+            }
+            if (!entry.isFile())
+                return TreeWalker::Action::Continue;
+
+            const auto key = qMakePair(entry.oid(), static_cast<int>(entry.mode()));
+            auto it = blobIndex.constFind(key);
+            if (it == blobIndex.cend()) {
+                it = blobIndex.insert(key, static_cast<int>(blobs.size()));
+                blobs << ExtractedBlob{key.first, entry.mode() == GIT_FILEMODE_BLOB_EXECUTABLE, {}};
             }
-            return file->save(newFilePath) ? 0 : 1;
+            blobs[*it].paths << root.filePath(path);
+            ++total;
+            return TreeWalker::Action::Continue;
+        },
+        directory);
+    if (!walked)
+        return false;
+
+    std::atomic_int next{0};
+    std::atomic_int written{0};
+    std::atomic_bool failed{false};
+    std::atomic_bool canceled{false};
+
+    const auto writeBlobs = [&](git_repository *repo) {
+        for (int i = next++; i < blobs.size() && !canceled; i = next++) {
+            if (!writeBlob(repo, blobs.at(i), options.linkDuplicates))
+                failed = true;
+            written += blobs.at(i).paths.size();
         }
-
-        return 0;
     };
 
-    wrapper w;
-    w.destinationFolder = destinationFolder;
-    w.tree = this;
-    if (!prefix.startsWith(QLatin1Char('/')))
-        w.prefix = QLatin1Char('/') + prefix;
-    else
-        w.prefix = prefix;
+    // a repository opened without a manager has no worker handles, it is written from here
+    if (!d->manager) {
+        writeBlobs(git_tree_owner(d->gitTreePtr));
+        if (options.progress)
+            options.progress(written, total);
+        return !failed;
+    }
+
+    QMutex mutex;
+    QWaitCondition finished;
+    int running{0};
+
+    // the jobs count down under the lock, so they wait until they are all counted
+    QMutexLocker locker(&mutex);
+    auto jobs = d->manager->runParallel(static_cast<int>(blobs.size()), [&](Manager *git, int, int) {
+        writeBlobs(git->repoPtr());
+
+        QMutexLocker jobLocker(&mutex);
+        if (!--running)
+            finished.wakeAll();
+    });
+    running = jobs.size();
+
+    while (running) {
+        finished.wait(&mutex, 100);
+        if (!options.progress)
+            continue;
+
+        // the callback may run an event loop, the jobs must not wait for it
+        locker.unlock();
+        if (!options.progress(written, total))
+            canceled = true;
+        locker.relock();
+    }
+    locker.unlock();
+    for (auto &job : jobs)
+        job.waitForFinished();
 
-    return !git_tree_walk(d->gitTreePtr, GIT_TREEWALK_PRE, cb, &w);
+    if (options.progress)
+        options.progress(written, total);
+    return !failed && !canceled;
 }
 
-QSharedPointer<Oid> Tree::oid() const
+Oid Tree::oid() const
 {
     Q_D(const Tree);
-    return QSharedPointer<Oid>{new Oid{git_tree_id(d->gitTreePtr)}};
+    return Oid{git_tree_id(d->gitTreePtr)};
 }
 
-void TreePrivate::initTree()
+void TreePrivate::list() const
 {
-    auto cb = [](const char *root, const git_tree_entry *entry, void *payload) -> int {
-        auto w = reinterpret_cast<TreePrivate *>(payload);
-        QString path{root};
-        QString name{git_tree_entry_name(entry)};
+    if (listed || !gitTreePtr)
+        return;
+    listed = true;
 
-        if (path.endsWith(QLatin1Char('/')))
-            path = path.mid(0, path.length() - 1);
+    const auto count = git_tree_entrycount(gitTreePtr);
+    level.reserve(static_cast<int>(count));
+    for (size_t i = 0; i < count; ++i) {
+        const auto entry = git_tree_entry_byindex(gitTreePtr, i);
+        const auto name = QString::fromUtf8(git_tree_entry_name(entry));
 
-        auto type = git_tree_entry_type(entry);
-        switch (type) {
+        switch (git_tree_entry_type(entry)) {
         case GIT_OBJECT_BLOB:
-            w->treeData.insert(path, Tree::Entry{name, Tree::EntryType::File});
-            w->entries.append(new Tree::Entry{name, Tree::EntryType::File, path});
+            level << Tree::Entry{name, Tree::EntryType::File, {}};
             break;
         case GIT_OBJECT_TREE:
-            w->treeData.insert(path, Tree::Entry{name, Tree::EntryType::Dir});
+            level << Tree::Entry{name, Tree::EntryType::Dir, {}};
+            subtrees.insert(name, Oid{git_tree_entry_id(entry)});
             break;
         case GIT_OBJECT_COMMIT:
         case GIT_OBJECT_ANY:
@@ -191,10 +360,18 @@ void TreePrivate::initTree()
         case GIT_OBJECT_REF_DELTA:
             break;
         }
-        return 0;
-    };
+    }
+}
+
+QSharedPointer<Tree> TreePrivate::lookup(const Oid &oid) const
+{
+    if (manager)
+        return manager->trees()->findByOid(oid);
 
-    git_tree_walk(gitTreePtr, GIT_TREEWALK_PRE, cb, this);
+    git_tree *tree{nullptr};
+    if (git_tree_lookup(&tree, git_tree_owner(gitTreePtr), oid.oidPtr()))
+        return {};
+    return QSharedPointer<Tree>{new Tree{tree}};
 }
 
 void TreePrivate::browseNestedEntities(Tree::EntryType type, const QString &path, QStringList &list) const
@@ -221,6 +398,7 @@ void TreePrivate::browseNestedEntities(Tree::EntryType type, const QString &path
 TreePrivate::TreePrivate(Tree *parent, git_tree *tree)
     : q_ptr{parent}
     , gitTreePtr{tree}
+    , manager{tree ? Manager::owner(git_tree_owner(tree)) : nullptr}
 {
 }
 }
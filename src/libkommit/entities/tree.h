@@ -17,6 +17,8 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include <QMultiMap>
 #include <QString>
 
+#include <functional>
+
 namespace Git
 {
 
@@ -32,17 +34,30 @@ public:
         QString path;
     };
 
+    struct ExtractOptions {
+        // identical files after the first are hard links to it, or copies where there are none
+        bool linkDuplicates{false};
+        // called on the calling thread now and then, extraction stops when it returns false
+        std::function<bool(int written, int total)> progress;
+    };
+
     explicit Tree(git_tree *tree);
     ~Tree();
 
     Q_REQUIRED_RESULT QList<Entry> entries(const QString &path) const;
     Q_REQUIRED_RESULT QStringList entries(const QString &path, EntryType filter) const;
+    // Every entry below this tree; this lists all of its directories
     Q_REQUIRED_RESULT QStringList entries(EntryType filter) const;
+    // Directory at path below this tree, shared with the other trees that have the same directory
+    Q_REQUIRED_RESULT QSharedPointer<Tree> subtree(const QString &path) const;
     QSharedPointer<File> file(const QString &path);
 
     Q_REQUIRED_RESULT git_tree *gitTree() const;
+    // Writes the files below prefix into destinationFolder, in parallel on the worker pool of the
+    // repository's manager. Each blob is read once for all the files that have it.
     Q_REQUIRED_RESULT bool extract(const QString &destinationFolder, const QString &prefix = {});
-    QSharedPointer<Oid> oid() const override;
+    Q_REQUIRED_RESULT bool extract(const QString &destinationFolder, const QString &prefix, const ExtractOptions &options);
+    Oid oid() const override;
 
 private:
     TreePrivate *d_ptr;
@@ -0,0 +1,155 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "treewalker.h"
+
+#include <git2/blob.h>
+#include <git2/odb.h>
+#include <git2/repository.h>
+#include <git2/tree.h>
+
+#include <utility>
+
+namespace Git
+{
+
+TreeWalker::Entry::Entry(git_repository *repo, const git_tree_entry *entry, QString path)
+    : mRepo{repo}
+    , mEntry{entry}
+    , mPath{std::move(path)}
+{
+}
+
+const QString &TreeWalker::Entry::path() const
+{
+    return mPath;
+}
+
+QString TreeWalker::Entry::name() const
+{
+    return QString::fromUtf8(git_tree_entry_name(mEntry));
+}
+
+git_filemode_t TreeWalker::Entry::mode() const
+{
+    return git_tree_entry_filemode(mEntry);
+}
+
+Oid TreeWalker::Entry::oid() const
+{
+    return Oid{git_tree_entry_id(mEntry)};
+}
+
+bool TreeWalker::Entry::isDir() const
+{
+    return git_tree_entry_type(mEntry) == GIT_OBJECT_TREE;
+}
+
+bool TreeWalker::Entry::isFile() const
+{
+    return git_tree_entry_type(mEntry) == GIT_OBJECT_BLOB;
+}
+
+bool TreeWalker::Entry::isSubmodule() const
+{
+    return git_tree_entry_type(mEntry) == GIT_OBJECT_COMMIT;
+}
+
+qint64 TreeWalker::Entry::size() const
+{
+    if (!isFile())
+        return -1;
+
+    git_odb *odb{nullptr};
+    if (git_repository_odb(&odb, mRepo))
+        return -1;
+
+    size_t length;
+    git_object_t type;
+    const auto err = git_odb_read_header(&length, &type, odb, git_tree_entry_id(mEntry));
+    git_odb_free(odb);
+
+    return err ? -1 : static_cast<qint64>(length);
+}
+
+QByteArray TreeWalker::Entry::content() const
+{
+    git_blob *blob{nullptr};
+    if (!isFile() || git_blob_lookup(&blob, mRepo, git_tree_entry_id(mEntry)))
+        return {};
+
+    QByteArray data{static_cast<const char *>(git_blob_rawcontent(blob)), static_cast<int>(git_blob_rawsize(blob))};
+    git_blob_free(blob);
+    return data;
+}
+
+TreeWalker::TreeWalker(git_tree *tree)
+    : mTree{tree}
+{
+}
+
+bool TreeWalker::walk(const Visitor &visitor, const QString &prefix) const
+{
+    if (!mTree)
+        return false;
+
+    auto path = prefix;
+    while (path.startsWith(QLatin1Char('/')))
+        path.remove(0, 1);
+    while (path.endsWith(QLatin1Char('/')))
+        path.chop(1);
+
+    if (path.isEmpty())
+        return walkTree(mTree, {}, visitor);
+
+    git_tree_entry *entry{nullptr};
+    if (git_tree_entry_bypath(&entry, mTree, path.toUtf8().constData()))
+        return true;
+
+    const auto repo = git_tree_owner(mTree);
+    bool ok{true};
+    if (git_tree_entry_type(entry) == GIT_OBJECT_TREE) {
+        git_tree *subtree{nullptr};
+        ok = !git_tree_lookup(&subtree, repo, git_tree_entry_id(entry));
+        if (ok)
+            ok = walkTree(subtree, path + QLatin1Char('/'), visitor);
+        git_tree_free(subtree);
+    } else {
+        ok = visitor(Entry{repo, entry, path}) != Action::Stop;
+    }
+
+    git_tree_entry_free(entry);
+    return ok;
+}
+
+bool TreeWalker::walkTree(git_tree *tree, const QString &base, const Visitor &visitor) const
+{
+    const auto repo = git_tree_owner(tree);
+    const auto count = git_tree_entrycount(tree);
+
+    for (size_t i = 0; i < count; ++i) {
+        const auto treeEntry = git_tree_entry_byindex(tree, i);
+        const Entry entry{repo, treeEntry, base + QString::fromUtf8(git_tree_entry_name(treeEntry))};
+
+        const auto action = visitor(entry);
+        if (action == Action::Stop)
+            return false;
+        if (action == Action::SkipChildren || !entry.isDir())
+            continue;
+
+        git_tree *subtree{nullptr};
+        if (git_tree_lookup(&subtree, repo, git_tree_entry_id(treeEntry)))
+            return false;
+
+        const auto ok = walkTree(subtree, entry.path() + QLatin1Char('/'), visitor);
+        git_tree_free(subtree);
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+}
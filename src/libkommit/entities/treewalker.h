@@ -0,0 +1,80 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "libkommit_export.h"
+#include "oid.h"
+
+#include <git2/types.h>
+
+#include <QByteArray>
+#include <QString>
+
+#include <functional>
+
+namespace Git
+{
+
+/**
+ * Streams the entries of a tree depth first, in tree order, without collecting them.
+ *
+ * The visitor decides for every directory whether to descend into it, and a path prefix limits
+ * the walk to one subtree without reading the trees beside it. Blob sizes and contents are only
+ * read when asked for.
+ */
+class LIBKOMMIT_EXPORT TreeWalker
+{
+public:
+    enum class Action {
+        Continue,
+        SkipChildren,
+        Stop,
+    };
+
+    // Only valid inside the visitor call it was passed to
+    class LIBKOMMIT_EXPORT Entry
+    {
+    public:
+        // relative to the walked tree, without a leading slash
+        Q_REQUIRED_RESULT const QString &path() const;
+        Q_REQUIRED_RESULT QString name() const;
+        Q_REQUIRED_RESULT git_filemode_t mode() const;
+        Q_REQUIRED_RESULT Oid oid() const;
+
+        Q_REQUIRED_RESULT bool isDir() const;
+        Q_REQUIRED_RESULT bool isFile() const;
+        Q_REQUIRED_RESULT bool isSubmodule() const;
+
+        // Size of a blob from the object header, -1 for anything else
+        Q_REQUIRED_RESULT qint64 size() const;
+        Q_REQUIRED_RESULT QByteArray content() const;
+
+    private:
+        Entry(git_repository *repo, const git_tree_entry *entry, QString path);
+
+        git_repository *const mRepo;
+        const git_tree_entry *const mEntry;
+        const QString mPath;
+
+        friend class TreeWalker;
+    };
+
+    using Visitor = std::function<Action(const Entry &entry)>;
+
+    // The tree is not owned and must outlive the walker
+    explicit TreeWalker(git_tree *tree);
+
+    // Returns false if the visitor stopped the walk or a tree could not be read
+    bool walk(const Visitor &visitor, const QString &prefix = {}) const;
+
+private:
+    bool walkTree(git_tree *tree, const QString &base, const Visitor &visitor) const;
+
+    git_tree *const mTree;
+};
+
+}
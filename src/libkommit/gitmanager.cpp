@@ -4,50 +4,199 @@
 #include "gitmanager.h"
 
 #include "abstractreference.h"
+#include "blame_p.h"
 #include "blamedata.h"
+#include "buffer.h"
 #include "caches/abstractcache.h"
+#include "caches/blamecache.h"
+#include "caches/blobscache.h"
 #include "caches/branchescache.h"
+#include "caches/commitgraph.h"
 #include "caches/commitscache.h"
 #include "caches/notescache.h"
 #include "caches/referencecache.h"
 #include "caches/remotescache.h"
 #include "caches/stashescache.h"
+#include "caches/stringpool.h"
 #include "caches/submodulescache.h"
 #include "caches/tagscache.h"
+#include "caches/treescache.h"
+#include "caches/trigramindex.h"
 #include "commands/abstractcommand.h"
+#include "entities/blob.h"
 #include "entities/branch.h"
 #include "entities/commit.h"
 #include "entities/index.h"
 #include "entities/note.h"
+#include "entities/oid.h"
 #include "entities/submodule.h"
 #include "entities/tree.h"
 #include "entities/treediff.h"
 #include "filestatus.h"
 #include "gitglobal_p.h"
+#include "grep.h"
+#include "grep_p.h"
+#include "history_p.h"
+#include "linehistory.h"
+#include "linehistory_p.h"
+#include "managerpool.h"
+#include "pickaxe.h"
+#include "pickaxe_p.h"
 #include "observers/cloneobserver.h"
 #include "observers/fetchobserver.h"
 #include "observers/pushobserver.h"
+#include "repositorywatcher.h"
 #include "types.h"
+#include "workingtreestatus.h"
 
 #include "libkommit_debug.h"
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QMutex>
 #include <QProcess>
+#include <QRegularExpression>
+#include <QtConcurrent>
+#include <QSet>
+#include <QThread>
+#include <QVarLengthArray>
 
 #include <git2.h>
 #include <git2/branch.h>
 #include <git2/diff.h>
 #include <git2/errors.h>
 #include <git2/refs.h>
+#include <git2/refspec.h>
 #include <git2/repository.h>
 #include <git2/stash.h>
 #include <git2/submodule.h>
 #include <git2/tag.h>
 
+#include <algorithm>
+#include <queue>
+#include <utility>
+#include <vector>
+
 #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
 
 namespace Git
 {
 
+namespace
+{
+
+// libgit2 1.8 changed the constness of git_commit_create's parents argument
+#if LIBGIT2_VER_MAJOR > 1 || (LIBGIT2_VER_MAJOR == 1 && LIBGIT2_VER_MINOR >= 8)
+using CommitParents = git_commit *const *;
+#else
+using CommitParents = const git_commit **;
+#endif
+
+// Tree of any revision that peels to one (commits, tags, trees), nullptr if there is none
+git_tree *revisionTree(git_repository *repo, const QString &revision)
+{
+    git_object *object{nullptr};
+    git_object *tree{nullptr};
+
+    BEGIN
+    STEP git_revparse_single(&object, repo, revision.toUtf8().constData());
+    STEP git_object_peel(&tree, object, GIT_OBJECT_TREE);
+    PRINT_ERROR;
+
+    git_object_free(object);
+    return IS_OK ? reinterpret_cast<git_tree *>(tree) : nullptr;
+}
+
+// git commit runs hooks and signs commits, libgit2 does neither
+bool commitNeedsGit(git_repository *repo)
+{
+    git_config *config{nullptr};
+    if (git_repository_config_snapshot(&config, repo))
+        return true;
+
+    int sign{0};
+    const auto signs = !git_config_get_bool(&sign, config, "commit.gpgsign") && sign;
+
+    QString hooksPath;
+    Buf path;
+    if (!git_config_get_path(&path, config, "core.hooksPath"))
+        hooksPath = QDir{QString::fromUtf8(git_repository_workdir(repo))}.absoluteFilePath(path.toString());
+    else
+        hooksPath = QString::fromUtf8(git_repository_commondir(repo)) + QStringLiteral("hooks");
+    git_config_free(config);
+
+    if (signs)
+        return true;
+
+    const QDir hooks{hooksPath};
+    for (const auto hook : {"pre-commit", "prepare-commit-msg", "commit-msg", "post-commit"})
+        if (QFileInfo{hooks.filePath(QLatin1String{hook})}.isExecutable())
+            return true;
+    return false;
+}
+
+// Branch on the remote that a local branch tracks, mapped back from its remote tracking branch
+// through the fetch refspecs. Empty if it does not track one on that remote.
+QByteArray upstreamMergeRef(git_repository *repo, git_remote *remote, const char *branchRef)
+{
+    Buf upstream;
+    if (git_branch_upstream_name(&upstream, repo, branchRef))
+        return {};
+
+    const auto trackingRef = upstream.toString().toUtf8();
+    const auto count = git_remote_refspec_count(remote);
+    for (size_t i = 0; i < count; ++i) {
+        const auto spec = git_remote_get_refspec(remote, i);
+        if (git_refspec_direction(spec) != GIT_DIRECTION_FETCH || !git_refspec_dst_matches(spec, trackingRef.constData()))
+            continue;
+
+        Buf merge;
+        if (!git_refspec_rtransform(&merge, spec, trackingRef.constData()))
+            return merge.toString().toUtf8();
+    }
+    return {};
+}
+
+FileStatus::Status deltaStatus(git_delta_t status)
+{
+    switch (status) {
+    case GIT_DELTA_UNMODIFIED:
+        return FileStatus::Unmodified;
+    case GIT_DELTA_ADDED:
+        return FileStatus::Added;
+    case GIT_DELTA_DELETED:
+        return FileStatus::Removed;
+    case GIT_DELTA_MODIFIED:
+        return FileStatus::Modified;
+    case GIT_DELTA_RENAMED:
+        return FileStatus::Renamed;
+    case GIT_DELTA_COPIED:
+        return FileStatus::Copied;
+    case GIT_DELTA_IGNORED:
+        return FileStatus::Ignored;
+    case GIT_DELTA_UNTRACKED:
+        return FileStatus::Untracked;
+    default:
+        return FileStatus::Unknown;
+    }
+}
+
+QList<FileStatus> diffFileStatuses(git_diff *diff)
+{
+    QList<FileStatus> files;
+    const auto count = git_diff_num_deltas(diff);
+    files.reserve(static_cast<int>(count));
+
+    for (size_t i = 0; i < count; ++i) {
+        auto delta = git_diff_get_delta(diff, i);
+        const auto path = delta->status == GIT_DELTA_DELETED ? delta->old_file.path : delta->new_file.path;
+        files << FileStatus{QString::fromUtf8(path), deltaStatus(delta->status)};
+    }
+    return files;
+}
+
+}
+
 class ManagerPrivate
 {
     Manager *q_ptr;
@@ -73,16 +222,34 @@ public:
     SubmodulesCache *submodulesCache;
     StashesCache *stashesCache;
     ReferenceCache *referenceCache;
+    BlobsCache *blobsCache;
+    TreesCache *treesCache;
+    StringPoolPointer stringPool{new StringPool};
+    // refreshed on access, the file changes outside of our control
+    mutable CommitGraph commitGraph;
+    // created on the first runAsync call
+    mutable QSharedPointer<ManagerPool> workerPool;
+    // created on the first workingTreeStatus call
+    mutable WorkingTreeStatus *workingTreeStatus{nullptr};
+    // created on the first watcher call
+    mutable RepositoryWatcher *watcher{nullptr};
+    // created on the first trigramIndex call
+    mutable TrigramIndex *trigramIndex{nullptr};
 
     void changeRepo(git_repository *repo);
     void resetCaches();
+    void refsChanged(const QStringList &names);
+    void headMoved();
 
     void freeRepo();
 
     void checkError();
     static QHash<git_repository *, Manager *> managerMap;
+    // worker handles are opened and closed on other threads
+    static QMutex managerMapMutex;
 };
 QHash<git_repository *, Manager *> ManagerPrivate::managerMap;
+QMutex ManagerPrivate::managerMapMutex;
 
 const QString &Manager::path() const
 {
@@ -103,15 +270,6 @@ bool Manager::open(const QString &newPath)
 
     END;
 
-    d->commitsCache->clear();
-    d->branchesCache->clear();
-    d->tagsCache->clear();
-    d->remotesCache->clear();
-    d->notesCache->clear();
-    d->submodulesCache->clear();
-    d->stashesCache->clear();
-    d->referenceCache->clear();
-
     d->isValid = IS_OK;
 
     if (IS_ERROR) {
@@ -142,33 +300,89 @@ QSharedPointer<Reference> Manager::head() const
 
 QMap<QString, ChangeStatus> Manager::changedFiles(const QString &hash) const
 {
+    Q_D(const Manager);
+
     QMap<QString, ChangeStatus> statuses;
-    auto buffer = QString(runGit({QStringLiteral("show"), QStringLiteral("--name-status"), hash})).split(QLatin1Char('\n'));
 
-    for (auto &line : buffer) {
-        if (!line.trimmed().size())
-            continue;
+    git_object *object{nullptr};
+    git_commit *commit{nullptr};
+    git_commit *parent{nullptr};
+    git_tree *tree{nullptr};
+    git_tree *parentTree{nullptr};
+    git_diff *diff{nullptr};
 
-        const auto parts = line.split(QLatin1Char('\t'));
-        if (parts.size() != 2)
-            continue;
+    BEGIN
+    STEP git_revparse_single(&object, d->repo, hash.toLatin1().constData());
+    STEP git_object_peel(reinterpret_cast<git_object **>(&commit), object, GIT_OBJECT_COMMIT);
+    STEP git_commit_tree(&tree, commit);
 
-        const auto partFirst{parts.first()};
-        if (partFirst == QLatin1Char('A'))
-            statuses.insert(parts.at(1), ChangeStatus::Added);
-        else if (partFirst == QLatin1Char('M'))
-            statuses.insert(parts.at(1), ChangeStatus::Modified);
-        else if (partFirst == QLatin1Char('D'))
-            statuses.insert(parts.at(1), ChangeStatus::Removed);
-        else
-            qCDebug(KOMMITLIB_LOG) << "Unknown file status" << partFirst;
+    // root commits are compared against an empty tree, merges against their first parent
+    if (IS_OK && git_commit_parentcount(commit)) {
+        STEP git_commit_parent(&parent, commit, 0);
+        STEP git_commit_tree(&parentTree, parent);
     }
+    STEP git_diff_tree_to_tree(&diff, d->repo, parentTree, tree, nullptr);
+
+    if (IS_OK) {
+        const auto count = git_diff_num_deltas(diff);
+        for (size_t i = 0; i < count; ++i) {
+            auto delta = git_diff_get_delta(diff, i);
+            switch (delta->status) {
+            case GIT_DELTA_ADDED:
+                statuses.insert(QString::fromUtf8(delta->new_file.path), ChangeStatus::Added);
+                break;
+            case GIT_DELTA_MODIFIED:
+                statuses.insert(QString::fromUtf8(delta->new_file.path), ChangeStatus::Modified);
+                break;
+            case GIT_DELTA_DELETED:
+                statuses.insert(QString::fromUtf8(delta->old_file.path), ChangeStatus::Removed);
+                break;
+            default:
+                qCDebug(KOMMITLIB_LOG) << "Unknown file status" << delta->status;
+                break;
+            }
+        }
+    }
+
+    PRINT_ERROR;
+
+    git_diff_free(diff);
+    git_tree_free(parentTree);
+    git_tree_free(tree);
+    git_commit_free(parent);
+    git_commit_free(commit);
+    git_object_free(object);
+
     return statuses;
 }
 
 QStringList Manager::ignoredFiles() const
 {
-    return readAllNonEmptyOutput({QStringLiteral("check-ignore"), QStringLiteral("*")});
+    Q_D(const Manager);
+
+    QStringList files;
+
+    git_status_list *list{nullptr};
+    git_status_options opts = GIT_STATUS_OPTIONS_INIT;
+    opts.show = GIT_STATUS_SHOW_WORKDIR_ONLY;
+    // ignored directories are reported once instead of file by file
+    opts.flags = GIT_STATUS_OPT_INCLUDE_IGNORED | GIT_STATUS_OPT_EXCLUDE_SUBMODULES;
+
+    BEGIN
+    STEP git_status_list_new(&list, d->repo, &opts);
+
+    PRINT_ERROR;
+    RETURN_IF_ERR(files);
+
+    const auto count = git_status_list_entrycount(list);
+    for (size_t i = 0; i < count; ++i) {
+        auto entry = git_status_byindex(list, i);
+        if (entry->status & GIT_STATUS_IGNORED)
+            files << QString::fromUtf8(entry->index_to_workdir->old_file.path);
+    }
+
+    git_status_list_free(list);
+    return files;
 }
 
 QList<FileStatus> Manager::repoFilesStatus() const
@@ -263,41 +477,181 @@ QPair<int, int> Manager::uniqueCommitsOnBranches(const QString &branch1, const Q
         return qMakePair(0, 0);
     auto id1 = git_reference_target(ref1);
     auto id2 = git_reference_target(ref2);
-    STEP git_graph_ahead_behind(&ahead, &behind, d->repo, id1, id2);
 
-    if (IS_ERROR)
-        return qMakePair(0, 0);
+    QPair<int, int> result{0, 0};
+    auto graph = commitGraph();
+    quint32 position1;
+    quint32 position2;
+    if (graph->isValid() && graph->find(Oid{id1}, &position1) && graph->find(Oid{id2}, &position2)) {
+        result = graph->aheadBehind(position1, position2);
+    } else {
+        STEP git_graph_ahead_behind(&ahead, &behind, d->repo, id1, id2);
+        if (IS_OK)
+            result = qMakePair(static_cast<int>(ahead), static_cast<int>(behind));
+    }
+
+    git_reference_free(ref1);
+    git_reference_free(ref2);
     PRINT_ERROR;
 
-    return qMakePair(ahead, behind);
+    return result;
 }
 
 QStringList Manager::fileLog(const QString &fileName) const
 {
-    return readAllNonEmptyOutput({QStringLiteral("log"), QStringLiteral("--format=format:%H"), QStringLiteral("--"), fileName});
+    QStringList hashes;
+    fileLog(fileName, [&hashes](const Oid &commit, const QString &) {
+        hashes << commit.toString();
+        return true;
+    });
+    return hashes;
+}
+
+void Manager::fileLog(const QString &fileName, const std::function<bool(const Oid &, const QString &)> &callback, bool followRenames) const
+{
+    Q_D(const Manager);
+
+    git_oid head;
+    if (!d->repo || git_reference_name_to_id(&head, d->repo, "HEAD"))
+        return;
+
+    struct Pending {
+        Oid id;
+        HistoryCommit commit;
+        QByteArray path;
+
+        bool operator<(const Pending &other) const
+        {
+            return commit.time < other.commit.time;
+        }
+    };
+
+    auto graph = commitGraph();
+    std::priority_queue<Pending> queue;
+    QSet<Oid> seen;
+
+    QHash<QByteArray, CommitGraph::PathKeys> pathKeys;
+    const auto unchangedByFilter = [&](const HistoryCommit &commit, const QByteArray &path) {
+        if (!commit.inGraph || !graph->hasChangedPaths())
+            return false;
+
+        auto keys = pathKeys.constFind(path);
+        if (keys == pathKeys.cend())
+            keys = pathKeys.insert(path, graph->pathKeys(path));
+        return graph->pathChanged(commit.graphPosition, *keys) == CommitGraph::PathChange::Unchanged;
+    };
+
+    const auto enqueue = [&](const Oid &id, const HistoryCommit &commit, const QByteArray &path) {
+        if (seen.contains(id))
+            return;
+        seen.insert(id);
+        queue.push(Pending{id, commit, path});
+    };
+
+    HistoryCommit headCommit;
+    if (!readHistoryCommit(d->repo, graph, Oid{&head}, &headCommit))
+        return;
+    auto path = fileName.toUtf8();
+    while (path.startsWith('/'))
+        path.remove(0, 1);
+    enqueue(Oid{&head}, headCommit, path);
+
+    QVarLengthArray<HistoryCommit, 2> parents;
+    while (!queue.empty()) {
+        const auto current = queue.top();
+        queue.pop();
+
+        const auto components = current.path.split('/');
+
+        parents.clear();
+        for (const auto &parentId : current.commit.parents) {
+            HistoryCommit parent;
+            if (readHistoryCommit(d->repo, graph, parentId, &parent))
+                parents.append(parent);
+            else
+                parents.append(HistoryCommit{});
+        }
+
+        // same simplification as git log: a commit that left the file as one of its parents had
+        // it is skipped, and only that parent is followed. The changed-path filter answers this
+        // for the first parent without reading any tree.
+        int sameParent{-1};
+        if (!parents.isEmpty() && unchangedByFilter(current.commit, current.path))
+            sameParent = 0;
+        for (int i = 0; sameParent == -1 && i < parents.size(); ++i)
+            if (!pathDiffers(d->repo, current.commit.tree, parents.at(i).tree, components))
+                sameParent = i;
+        if (sameParent != -1) {
+            enqueue(current.commit.parents.at(sameParent), parents.at(sameParent), current.path);
+            continue;
+        }
+
+        auto parentPath = current.path;
+        if (followRenames && parents.size() == 1 && !pathDiffers(d->repo, Oid{}, parents.first().tree, components)) {
+            const auto renamed = renamedFrom(d->repo, parents.first().tree, current.commit.tree, current.path);
+            if (!renamed.isEmpty())
+                parentPath = renamed;
+        }
+
+        // a root commit is part of the history only when it has the file
+        if ((!parents.isEmpty() || pathDiffers(d->repo, current.commit.tree, Oid{}, components))
+            && !callback(current.id, QString::fromUtf8(current.path)))
+            return;
+
+        for (int i = 0; i < parents.size(); ++i)
+            enqueue(current.commit.parents.at(i), parents.at(i), parentPath);
+    }
 }
 
 QString Manager::diff(const QString &from, const QString &to) const
 {
-    return runGit({QStringLiteral("diff"), from, to});
+    Q_D(const Manager);
+
+    auto fromTree = revisionTree(d->repo, from);
+    auto toTree = revisionTree(d->repo, to);
+    git_diff *diff{nullptr};
+    Buf buf;
+
+    if (!fromTree || !toTree) {
+        git_tree_free(fromTree);
+        git_tree_free(toTree);
+        return {};
+    }
+
+    BEGIN
+    STEP git_diff_tree_to_tree(&diff, d->repo, fromTree, toTree, nullptr);
+    STEP git_diff_to_buf(&buf, diff, GIT_DIFF_FORMAT_PATCH);
+
+    PRINT_ERROR;
+
+    git_diff_free(diff);
+    git_tree_free(fromTree);
+    git_tree_free(toTree);
+
+    return IS_OK ? buf.toString() : QString{};
 }
 
 QList<FileStatus> Manager::diffBranch(const QString &from) const
 {
-    const QStringList buffer = QString(runGit({QStringLiteral("diff"), from, QStringLiteral("--name-status")})).split(QLatin1Char('\n'));
+    Q_D(const Manager);
+
+    auto tree = revisionTree(d->repo, from);
+    if (!tree)
+        return {};
+
+    git_diff *diff{nullptr};
+
+    BEGIN
+    STEP git_diff_tree_to_workdir_with_index(&diff, d->repo, tree, nullptr);
+
+    PRINT_ERROR;
+
     QList<FileStatus> files;
-    for (const auto &item : buffer) {
-        if (!item.trimmed().size())
-            continue;
-        const auto parts = item.split(QStringLiteral("\t"));
-        if (parts.size() != 2)
-            continue;
+    if (IS_OK)
+        files = diffFileStatuses(diff);
 
-        FileStatus fs;
-        fs.setStatus(parts.at(0));
-        fs.setName(parts.at(1));
-        files.append(fs);
-    }
+    git_diff_free(diff);
+    git_tree_free(tree);
     return files;
 }
 
@@ -338,55 +692,9 @@ QList<FileStatus> Manager::diffBranches(const QString &from, const QString &to)
 
     git_commit_free(fromCommit);
 
-    git_diff_stats *stats;
-    git_diff_get_stats(&stats, diff);
-    auto n = git_diff_stats_files_changed(stats);
-    QList<FileStatus> files2;
-
-    for (size_t i = 0; i < n; ++i) {
-        auto delta = git_diff_get_delta(diff, i);
-        FileStatus fs;
-        fs.mName = delta->new_file.path;
-
-        switch (delta->status) {
-        case GIT_DELTA_UNMODIFIED:
-            fs.mStatus = FileStatus::Unmodified;
-            break;
-        case GIT_DELTA_ADDED:
-            fs.mStatus = FileStatus::Added;
-            break;
-        case GIT_DELTA_DELETED:
-            fs.mStatus = FileStatus::Removed;
-            break;
-        case GIT_DELTA_MODIFIED:
-            fs.mStatus = FileStatus::Modified;
-            break;
-        case GIT_DELTA_RENAMED:
-            fs.mStatus = FileStatus::Renamed;
-            break;
-        case GIT_DELTA_COPIED:
-            fs.mStatus = FileStatus::Copied;
-            break;
-        case GIT_DELTA_IGNORED:
-            fs.mStatus = FileStatus::Ignored;
-            break;
-        case GIT_DELTA_UNTRACKED:
-            fs.mStatus = FileStatus::Untracked;
-            break;
-        case GIT_DELTA_TYPECHANGE:
-            fs.mStatus = FileStatus::Unknown;
-            break;
-        case GIT_DELTA_UNREADABLE:
-            fs.mStatus = FileStatus::Unknown;
-            break;
-        case GIT_DELTA_CONFLICTED:
-            fs.mStatus = FileStatus::Unknown;
-            break;
-        }
-        files2 << fs;
-    }
-
-    return files2;
+    auto files = diffFileStatuses(diff);
+    git_diff_free(diff);
+    return files;
 }
 
 QList<FileStatus> Manager::diff(AbstractReference *from, AbstractReference *to) const
@@ -406,55 +714,9 @@ QList<FileStatus> Manager::diff(AbstractReference *from, AbstractReference *to)
         return {};
     }
 
-    git_diff_stats *stats;
-    git_diff_get_stats(&stats, diff);
-    auto n = git_diff_stats_files_changed(stats);
-    QList<FileStatus> files2;
-
-    for (size_t i = 0; i < n; ++i) {
-        auto delta = git_diff_get_delta(diff, i);
-        FileStatus fs;
-        fs.mName = delta->new_file.path;
-
-        switch (delta->status) {
-        case GIT_DELTA_UNMODIFIED:
-            fs.mStatus = FileStatus::Unmodified;
-            break;
-        case GIT_DELTA_ADDED:
-            fs.mStatus = FileStatus::Added;
-            break;
-        case GIT_DELTA_DELETED:
-            fs.mStatus = FileStatus::Removed;
-            break;
-        case GIT_DELTA_MODIFIED:
-            fs.mStatus = FileStatus::Modified;
-            break;
-        case GIT_DELTA_RENAMED:
-            fs.mStatus = FileStatus::Renamed;
-            break;
-        case GIT_DELTA_COPIED:
-            fs.mStatus = FileStatus::Copied;
-            break;
-        case GIT_DELTA_IGNORED:
-            fs.mStatus = FileStatus::Ignored;
-            break;
-        case GIT_DELTA_UNTRACKED:
-            fs.mStatus = FileStatus::Untracked;
-            break;
-        case GIT_DELTA_TYPECHANGE:
-            fs.mStatus = FileStatus::Unknown;
-            break;
-        case GIT_DELTA_UNREADABLE:
-            fs.mStatus = FileStatus::Unknown;
-            break;
-        case GIT_DELTA_CONFLICTED:
-            fs.mStatus = FileStatus::Unknown;
-            break;
-        }
-        files2 << fs;
-    }
-
-    return files2;
+    auto files = diffFileStatuses(diff);
+    git_diff_free(diff);
+    return files;
 }
 
 void Manager::forEachCommits(std::function<void(QSharedPointer<Commit>)> callback, const QString &branchName) const
@@ -688,21 +950,6 @@ void Manager::forEachConfig(std::function<void(QString, QString)> calback)
     git_config_free(cfg);
 }
 
-QStringList Manager::readAllNonEmptyOutput(const QStringList &cmd) const
-{
-    QStringList list;
-    const auto out = runGit(cmd).split(QLatin1Char('\n'));
-
-    for (const auto &line : out) {
-        const auto b = line.trimmed();
-        if (b.isEmpty())
-            continue;
-
-        list.append(b.trimmed());
-    }
-    return list;
-}
-
 Manager::Manager()
     : QObject()
     , d_ptr{new ManagerPrivate{this}}
@@ -735,8 +982,9 @@ Manager *Manager::instance()
 Manager::~Manager()
 {
     Q_D(Manager);
-    if (d->repo)
-        git_repository_free(d->repo);
+    if (d->trigramIndex)
+        d->trigramIndex->reset();
+    d->freeRepo();
     delete d;
 }
 
@@ -833,128 +1081,212 @@ QString Manager::runGit(const QStringList &args) const
     return QString::fromUtf8(out); // + err;
 }
 
+QFuture<void> Manager::runAsync(std::function<void(Manager *)> fn) const
+{
+    auto pool = workerPool();
+    return QtConcurrent::run([pool, fn]() {
+        auto manager = pool->acquire();
+        fn(manager.data());
+    });
+}
+
+QList<QFuture<void>> Manager::runParallel(int count, std::function<void(Manager *, int, int)> fn) const
+{
+    const auto jobs = qBound(1, QThread::idealThreadCount(), qMax(1, count));
+
+    QList<QFuture<void>> futures;
+    futures.reserve(jobs);
+    for (int job = 0; job < jobs; ++job)
+        futures << runAsync([fn, job, jobs](Manager *manager) {
+            fn(manager, job, jobs);
+        });
+    return futures;
+}
+
+QSharedPointer<ManagerPool> Manager::workerPool() const
+{
+    Q_D(const Manager);
+
+    if (!d->workerPool)
+        d->workerPool.reset(new ManagerPool{d->path});
+    return d->workerPool;
+}
+
+void Manager::resetReferenceCaches()
+{
+    Q_D(Manager);
+
+    d->branchesCache->clear();
+    d->tagsCache->clear();
+    d->remotesCache->clear();
+    d->notesCache->clear();
+    d->submodulesCache->clear();
+    d->stashesCache->clear();
+    d->referenceCache->clear();
+}
+
 QStringList Manager::ls(const QString &place) const
+{
+    QStringList files;
+
+    // files and submodules, like ls-tree -r
+    walkTree(place, [&files](const TreeWalker::Entry &entry) {
+        if (!entry.isDir())
+            files << entry.path();
+        return TreeWalker::Action::Continue;
+    });
+    return files;
+}
+
+QSharedPointer<Tree> Manager::tree(const QString &place) const
 {
     Q_D(const Manager);
 
-    struct wrapper {
-        QStringList files;
-    };
+    auto tree = revisionTree(d->repo, place);
+    if (!tree)
+        return {};
+    return d->treesCache->findByPtr(tree);
+}
 
-    auto cb = [](const char *root, const git_tree_entry *entry, void *payload) -> int {
-        auto w = reinterpret_cast<wrapper *>(payload);
-        qDebug() << QString{root} << QString{git_tree_entry_name(entry)};
-        w->files << QString{root} + QString{git_tree_entry_name(entry)};
-        return 0;
-    };
-    git_tree *tree;
-    git_object *placeObject{nullptr};
-    git_commit *commit{nullptr};
+bool Manager::walkTree(const QString &place, const TreeWalker::Visitor &visitor, const QString &prefix) const
+{
+    Q_D(const Manager);
 
-    BEGIN
-    STEP git_revparse_single(&placeObject, d->repo, place.toLatin1().constData());
-    STEP git_commit_lookup(&commit, d->repo, git_object_id(placeObject));
-    STEP git_commit_tree(&tree, commit);
+    auto tree = revisionTree(d->repo, place);
+    if (!tree)
+        return false;
 
-    wrapper w;
-    STEP git_tree_walk(tree, GIT_TREEWALK_PRE, cb, &w);
-
-    auto buffer = readAllNonEmptyOutput({QStringLiteral("ls-tree"), QStringLiteral("--name-only"), QStringLiteral("-r"), place});
-    QMutableListIterator<QString> it(buffer);
-    while (it.hasNext()) {
-        auto s = it.next();
-        if (s.startsWith(QLatin1String("\"")) && s.endsWith(QLatin1String("\"")))
-            it.setValue(s.mid(1, s.length() - 2));
-    }
-    return buffer;
+    const auto ok = TreeWalker{tree}.walk(visitor, prefix);
+    git_tree_free(tree);
+    return ok;
 }
 
 QString Manager::fileContent(const QString &place, const QString &fileName) const
 {
     Q_D(const Manager);
 
-    git_object *placeObject{nullptr};
-    git_commit *commit{nullptr};
-    git_tree *tree{nullptr};
+    auto blob = d->blobsCache->find(place, fileName);
+    return blob ? blob->text() : QString{};
+}
+
+void Manager::saveFile(const QString &place, const QString &fileName, const QString &localFile) const
+{
+    Q_D(const Manager);
+
+    auto tree = revisionTree(d->repo, place);
+    if (!tree)
+        return;
+
     git_tree_entry *entry{nullptr};
     git_blob *blob{nullptr};
 
     BEGIN
-    STEP git_revparse_single(&placeObject, d->repo, place.toLatin1().constData());
-    STEP git_commit_lookup(&commit, d->repo, git_object_id(placeObject));
-    STEP git_commit_tree(&tree, commit);
-
-    STEP git_tree_entry_bypath(&entry, tree, fileName.toLocal8Bit().constData());
+    STEP git_tree_entry_bypath(&entry, tree, fileName.toUtf8().constData());
     STEP git_blob_lookup(&blob, d->repo, git_tree_entry_id(entry));
 
     PRINT_ERROR;
 
-    if (IS_ERROR)
-        return {};
-
-    QString ch = (char *)git_blob_rawcontent(blob);
+    if (IS_OK) {
+        QFile f{localFile};
+        if (f.open(QIODevice::WriteOnly))
+            f.write(static_cast<const char *>(git_blob_rawcontent(blob)), static_cast<qint64>(git_blob_rawsize(blob)));
+    }
 
-    git_object_free(placeObject);
-    git_commit_free(commit);
     git_blob_free(blob);
     git_tree_entry_free(entry);
     git_tree_free(tree);
-
-    //    auto ch2 = runGit({QStringLiteral("show"), place + QLatin1Char(':') + fileName});
-    //    auto eq = ch == ch2;
-    return ch;
 }
 
-void Manager::saveFile(const QString &place, const QString &fileName, const QString &localFile) const
+BlameData Manager::blame(QSharedPointer<File> file)
 {
-    auto buffer = runGit({QStringLiteral("show"), place + QLatin1Char(':') + fileName});
-    QFile f{localFile};
-    if (!f.open(QIODevice::WriteOnly))
-        return;
-    f.write(buffer.toUtf8());
-    f.close();
+    BlameOptions options;
+    if (!file->place().isEmpty())
+        options.revision = file->place();
+
+    QList<BlameHunk> hunks;
+    blame(
+        file->fileName(),
+        [&hunks](const BlameHunk &hunk) {
+            hunks << hunk;
+            return true;
+        },
+        options);
+
+    std::sort(hunks.begin(), hunks.end(), [](const BlameHunk &l, const BlameHunk &r) {
+        return l.finalStartLineNumber < r.finalStartLineNumber;
+    });
+
+    const auto lines = file->content().split(QLatin1Char('\n'));
+
+    BlameData b;
+    b.reserve(hunks.size());
+    for (const auto &hunk : std::as_const(hunks))
+        b.append(blameDataRow(hunk, lines));
+    return b;
 }
 
-BlameData Manager::blame(QSharedPointer<File> file)
+bool Manager::blame(const QString &fileName, const std::function<bool(const BlameHunk &)> &callback, const BlameOptions &options) const
 {
-    Q_D(Manager);
+    Q_D(const Manager);
 
-    git_blame *blame;
-    git_blame_options options;
+    if (!d->repo)
+        return false;
+    return blameFile(d->repo, commitGraph(), fileName, callback, options);
+}
 
-    BEGIN
-    STEP git_blame_options_init(&options, GIT_BLAME_OPTIONS_VERSION);
-    STEP git_blame_file(&blame, d->repo, file->fileName().toUtf8().data(), &options);
-    END;
+BlameDataRow Manager::blameDataRow(const BlameHunk &hunk, const QStringList &lines) const
+{
+    Q_D(const Manager);
 
-    PRINT_ERROR;
-    RETURN_IF_ERR({});
+    auto commit = d->commitsCache->findByOid(hunk.commitId);
+    auto signature = commit ? commit->author() : QSharedPointer<Signature>{};
 
-    BlameData b;
+    return BlameDataRow{hunk.commitId,
+                        lines.mid(hunk.finalStartLineNumber - 1, hunk.lineCount).join(QLatin1Char('\n')),
+                        hunk.originPath,
+                        commit,
+                        commit,
+                        signature,
+                        signature,
+                        static_cast<size_t>(hunk.finalStartLineNumber),
+                        static_cast<size_t>(hunk.originStartLineNumber)};
+}
 
-    auto lines = file->content().split(QLatin1Char('\n'));
+bool Manager::lineHistory(const QString &fileName,
+                          const QList<LineRange> &ranges,
+                          const std::function<bool(const LineHistoryEntry &)> &callback,
+                          const QString &revision) const
+{
+    Q_D(const Manager);
 
-    auto count = git_blame_get_hunk_count(blame);
-    for (size_t i = 0; i < count; ++i) {
-        auto hunk = git_blame_get_hunk_byindex(blame, i);
+    if (!d->repo)
+        return false;
+    return fileLineHistory(d->repo, commitGraph(), fileName, ranges, callback, revision);
+}
 
-        BlameDataRow row{convertToString(&hunk->final_commit_id, 20),
-                         lines.mid(hunk->final_start_line_number, hunk->lines_in_hunk).join(QLatin1Char('\n')),
-                         QString{hunk->orig_path},
+bool Manager::pickaxe(const QList<Oid> &commits, const PickaxeOptions &options, const std::function<bool(const PickaxeMatch &)> &callback) const
+{
+    Q_D(const Manager);
 
-                         d->commitsCache->findByOid(&hunk->final_commit_id),
-                         d->commitsCache->findByOid(&hunk->orig_commit_id),
+    if (!d->repo)
+        return false;
+    return commitsPickaxe(d->repo, commitGraph(), blobs(), commits, options, callback);
+}
 
-                         QSharedPointer<Signature>{new Signature{hunk->orig_signature}},
-                         QSharedPointer<Signature>{new Signature{hunk->final_signature}},
+QStringList Manager::workingTreeFiles(const QStringList &paths, bool untracked) const
+{
+    Q_D(const Manager);
 
-                         hunk->final_start_line_number,
-                         hunk->orig_start_line_number};
-        b.append(row);
-    }
-    git_blame_free(blame);
+    if (!d->repo)
+        return {};
+    return listWorkingTreeFiles(d->repo, paths, untracked);
+}
 
-    return b;
+bool Manager::grep(const QStringList &files, const GrepOptions &options, const std::function<bool(const GrepMatch &)> &callback) const
+{
+    Q_D(const Manager);
+
+    return grepFiles(d->path, files, options, callback);
 }
 
 bool Manager::revertFile(const QString &filePath) const
@@ -979,6 +1311,50 @@ bool Manager::revertFile(const QString &filePath) const
 }
 
 QMap<QString, ChangeStatus> Manager::changedFiles() const
+{
+    return changedFilesIn({});
+}
+
+RepositoryWatcher *Manager::watcher() const
+{
+    Q_D(const Manager);
+
+    if (!d->watcher) {
+        d->watcher = new RepositoryWatcher{const_cast<Manager *>(this)};
+
+        // connected before anyone else can, so receivers always see fresh caches
+        connect(d->watcher, &RepositoryWatcher::refsChanged, this, [this](const QStringList &names) {
+            d_ptr->refsChanged(names);
+        });
+        connect(d->watcher, &RepositoryWatcher::headMoved, this, [this]() {
+            d_ptr->headMoved();
+        });
+        connect(d->watcher, &RepositoryWatcher::stashChanged, this, [this]() {
+            d_ptr->stashesCache->clear();
+        });
+    }
+    return d->watcher;
+}
+
+WorkingTreeStatus *Manager::workingTreeStatus() const
+{
+    Q_D(const Manager);
+
+    if (!d->workingTreeStatus)
+        d->workingTreeStatus = new WorkingTreeStatus{const_cast<Manager *>(this)};
+    return d->workingTreeStatus;
+}
+
+TrigramIndex *Manager::trigramIndex() const
+{
+    Q_D(const Manager);
+
+    if (!d->trigramIndex)
+        d->trigramIndex = new TrigramIndex{const_cast<Manager *>(this)};
+    return d->trigramIndex;
+}
+
+QMap<QString, ChangeStatus> Manager::changedFilesIn(const QStringList &directories) const
 {
     Q_D(const Manager);
 
@@ -1019,55 +1395,189 @@ QMap<QString, ChangeStatus> Manager::changedFiles() const
    GIT_STATUS_OPT_UPDATE_INDEX | GIT_STATUS_OPT_INCLUDE_UNREADABLE | GIT_STATUS_OPT_INCLUDE_UNREADABLE_AS_UNTRACKED*/
         ;
 
+    // literal directory paths, libgit2 matches everything below them and only iterates those subtrees
+    QList<QByteArray> paths;
+    std::vector<char *> pathPointers;
+    if (!directories.contains(QString{})) {
+        for (const auto &directory : directories) {
+            paths << directory.toUtf8();
+            pathPointers.push_back(paths.last().data());
+        }
+    }
+    opts.pathspec = git_strarray{pathPointers.data(), pathPointers.size()};
+    if (!pathPointers.empty())
+        opts.flags |= GIT_STATUS_OPT_DISABLE_PATHSPEC_MATCH;
+
     git_status_foreach_ext(d->repo, &opts, cb, &w);
 
     //    git_status_foreach(_repo, cb, &w);
     return w.files;
 }
 
-void Manager::commit(const QString &message)
+bool Manager::commit(const QString &message)
 {
-    runGit({QStringLiteral("commit"), QStringLiteral("-m"), message});
-    Q_EMIT reloadRequired();
-}
+    Q_D(Manager);
 
-void Manager::push(PushObserver *observer) const
-{
-    git_push_options opts = GIT_PUSH_OPTIONS_INIT;
-    if (observer) {
-        opts.callbacks.pack_progress = &PushCallbacks::git_helper_packbuilder_progress;
-        opts.callbacks.push_transfer_progress = &PushCallbacks::git_helper_push_transfer_progress_cb;
-        opts.callbacks.credentials = &PushCallbacks::git_helper_credential_acquire_cb;
-        opts.callbacks.certificate_check = &PushCallbacks::git_helper_transport_certificate_check_cb;
-        opts.callbacks.payload = observer;
+    if (!d->repo)
+        return false;
+
+    if (commitNeedsGit(d->repo)) {
+        QProcess p;
+        p.setProgram(QStringLiteral("git"));
+        p.setArguments({QStringLiteral("commit"), QStringLiteral("-m"), message});
+        p.setWorkingDirectory(d->path);
+        p.start();
+        p.waitForFinished(-1);
+        const auto ok = p.exitStatus() == QProcess::NormalExit && !p.exitCode();
+        if (!ok)
+            qCWarning(KOMMITLIB_LOG).noquote() << p.readAllStandardError() << p.readAllStandardOutput();
+
+        Q_EMIT reloadRequired();
+        return ok;
+    }
+
+    git_index *index{nullptr};
+    git_tree *tree{nullptr};
+    git_signature *signature{nullptr};
+    git_oid treeId;
+    git_oid headId;
+    git_oid commitId;
+    Buf cleanMessage;
+    std::vector<git_commit *> parents;
+
+    BEGIN
+    STEP git_repository_index(&index, d->repo);
+    // pick up changes other tools made to the index file
+    STEP git_index_read(index, false);
+    STEP git_index_write_tree(&treeId, index);
+    STEP git_tree_lookup(&tree, d->repo, &treeId);
+    STEP git_signature_default(&signature, d->repo);
+    // git commit -m cleans up whitespace only, lines starting with # are kept
+    STEP git_message_prettify(&cleanMessage, message.toUtf8().constData(), 0, '#');
+
+    // no HEAD commit yet means this is the initial commit
+    if (IS_OK && !git_reference_name_to_id(&headId, d->repo, "HEAD")) {
+        git_commit *head{nullptr};
+        STEP git_commit_lookup(&head, d->repo, &headId);
+        if (IS_OK)
+            parents.push_back(head);
+    }
+
+    // concluding a merge records the merged commits as further parents
+    if (IS_OK && git_repository_state(d->repo) == GIT_REPOSITORY_STATE_MERGE) {
+        auto cb = [](const git_oid *oid, void *payload) -> int {
+            auto w = reinterpret_cast<std::pair<git_repository *, std::vector<git_commit *> *> *>(payload);
+            git_commit *commit{nullptr};
+            auto err = git_commit_lookup(&commit, w->first, oid);
+            if (!err)
+                w->second->push_back(commit);
+            return err;
+        };
+        auto payload = std::make_pair(d->repo, &parents);
+        STEP git_repository_mergehead_foreach(d->repo, cb, &payload);
+    }
+
+    // like git commit, refuse to record a commit that changes nothing
+    if (IS_OK) {
+        const auto unchanged = parents.size() == 1 ? git_oid_equal(&treeId, git_commit_tree_id(parents.front())) : parents.empty() && !git_tree_entrycount(tree);
+        if (unchanged) {
+            git_error_set_str(GIT_ERROR_INVALID, "nothing to commit");
+            STEP GIT_EUNCHANGED;
+        }
     }
 
-    //    git_remote_lookup()
-    runGit({QStringLiteral("push"), QStringLiteral("origin"), QStringLiteral("master")});
+    STEP git_commit_create(&commitId,
+                           d->repo,
+                           "HEAD",
+                           signature,
+                           signature,
+                           nullptr,
+                           cleanMessage.toString().toUtf8().constData(),
+                           tree,
+                           parents.size(),
+                           const_cast<CommitParents>(parents.data()));
+
+    if (IS_OK)
+        git_repository_state_cleanup(d->repo);
+
+    PRINT_ERROR;
+
+    for (auto parent : parents)
+        git_commit_free(parent);
+    git_signature_free(signature);
+    git_tree_free(tree);
+    git_index_free(index);
+
+    Q_EMIT reloadRequired();
+    return IS_OK;
 }
 
-void Manager::addFile(const QString &file) const
+void Manager::push(PushObserver *observer) const
 {
     Q_D(const Manager);
 
-    git_index *index{nullptr};
-    git_tree *tree{nullptr};
-    git_oid oid;
+    // without an observer to ask for credentials, git and its credential helpers and ssh agent do it
+    if (!observer) {
+        Q_UNUSED(runGit({QStringLiteral("push")}))
+        return;
+    }
+
+    git_push_options opts = GIT_PUSH_OPTIONS_INIT;
+    opts.callbacks.pack_progress = &PushCallbacks::git_helper_packbuilder_progress;
+    opts.callbacks.push_transfer_progress = &PushCallbacks::git_helper_push_transfer_progress_cb;
+    opts.callbacks.credentials = &PushCallbacks::git_helper_credential_acquire_cb;
+    opts.callbacks.certificate_check = &PushCallbacks::git_helper_transport_certificate_check_cb;
+    opts.callbacks.payload = observer;
+
+    // there is no branch to push while detached
+    if (git_repository_head_detached(d->repo))
+        return;
+
+    git_reference *head{nullptr};
+    git_remote *remote{nullptr};
+    Buf remoteName;
 
     BEGIN
-    STEP git_repository_index(&index, d->repo);
-    if (file.startsWith(QLatin1Char('/')))
-        STEP git_index_add_bypath(index, toConstChars(file.mid(1)));
+    STEP git_repository_head(&head, d->repo);
+
+    // the current branch goes to the remote it tracks, origin if it doesn't track any
+    if (IS_OK && !git_branch_upstream_remote(&remoteName, d->repo, git_reference_name(head)))
+        STEP git_remote_lookup(&remote, d->repo, remoteName.toString().toUtf8().constData());
     else
-        STEP git_index_add_bypath(index, toConstChars(file));
-    STEP git_index_write_tree_to(&oid, index, d->repo);
-    STEP git_tree_lookup(&tree, d->repo, &oid);
-    STEP git_index_write(index);
+        STEP git_remote_lookup(&remote, d->repo, "origin");
+
+    if (IS_OK) {
+        auto destination = upstreamMergeRef(d->repo, remote, git_reference_name(head));
+        if (destination.isEmpty())
+            destination = git_reference_name(head);
+        auto refspec = QByteArray{git_reference_name(head)} + ':' + destination;
+        char *refspecs[] = {refspec.data()};
+        git_strarray specs{refspecs, 1};
+
+        STEP git_remote_push(remote, &specs, &opts);
+    }
 
     PRINT_ERROR;
 
-    git_tree_free(tree);
-    git_index_free(index);
+    git_remote_free(remote);
+    git_reference_free(head);
+}
+
+void Manager::addFile(const QString &file) const
+{
+    Q_UNUSED(addFiles({file}))
+}
+
+bool Manager::addFiles(const QStringList &files) const
+{
+    auto index = this->index();
+    if (!index)
+        return false;
+
+    const auto ok = index->begin() && index->addPaths(files) && index->commit();
+    if (!ok)
+        qCWarning(KOMMITLIB_LOG) << "Unable to stage files:" << errorMessage();
+    return ok;
 }
 
 bool Manager::removeFile(const QString &file, bool cached) const
@@ -1142,9 +1652,21 @@ git_repository *Manager::repoPtr() const
 
 Manager *Manager::owner(git_repository *repo)
 {
+    QMutexLocker locker(&ManagerPrivate::managerMapMutex);
     return ManagerPrivate::managerMap.value(repo, nullptr);
 }
 
+CommitGraph *Manager::commitGraph() const
+{
+    Q_D(const Manager);
+
+    if (d->repo)
+        d->commitGraph.refresh(QString::fromUtf8(git_repository_commondir(d->repo)) + QStringLiteral("objects/info/"));
+    else
+        d->commitGraph.clear();
+    return &d->commitGraph;
+}
+
 CommitsCache *Manager::commits() const
 {
     Q_D(const Manager);
@@ -1187,6 +1709,24 @@ StashesCache *Manager::stashes() const
     return d->stashesCache;
 }
 
+BlobsCache *Manager::blobs() const
+{
+    Q_D(const Manager);
+    return d->blobsCache;
+}
+
+TreesCache *Manager::trees() const
+{
+    Q_D(const Manager);
+    return d->treesCache;
+}
+
+StringPool *Manager::stringPool() const
+{
+    Q_D(const Manager);
+    return d->stringPool.data();
+}
+
 ReferenceCache *Manager::references() const
 {
     Q_D(const Manager);
@@ -1214,6 +1754,8 @@ ManagerPrivate::ManagerPrivate(Manager *parent)
     , submodulesCache{new SubmodulesCache{parent}}
     , stashesCache{new StashesCache(parent)}
     , referenceCache{new ReferenceCache{parent}}
+    , blobsCache{new BlobsCache{parent}}
+    , treesCache{new TreesCache{parent}}
 {
 }
 
@@ -1221,17 +1763,30 @@ void ManagerPrivate::changeRepo(git_repository *repo)
 {
     Q_Q(Manager);
 
+    // running index jobs still save into the old git dir
+    if (trigramIndex)
+        trigramIndex->reset();
+
+    // entities in the caches hold objects of the old repository
+    resetCaches();
     freeRepo();
 
     if (repo) {
         this->repo = repo;
-        managerMap.insert(repo, q);
+        {
+            QMutexLocker locker(&managerMapMutex);
+            managerMap.insert(repo, q);
+        }
         path = git_repository_workdir(repo);
     }
 
     isValid = repo;
+    workerPool.reset();
 
-    resetCaches();
+    if (watcher)
+        watcher->reset();
+    if (workingTreeStatus)
+        workingTreeStatus->reset();
 }
 
 void ManagerPrivate::resetCaches()
@@ -1241,12 +1796,41 @@ void ManagerPrivate::resetCaches()
     tagsCache->clear();
     remotesCache->clear();
     notesCache->clear();
+    submodulesCache->clear();
+    stashesCache->clear();
+    referenceCache->clear();
+    blobsCache->clear();
+    treesCache->clear();
+    // commits that outlive the reset keep the old pool
+    stringPool.reset(new StringPool);
+}
+
+void ManagerPrivate::refsChanged(const QStringList &names)
+{
+    referenceCache->clear();
+
+    if (RepositoryWatcher::containsRefsUnder(names, QStringLiteral("refs/heads/")) || RepositoryWatcher::containsRefsUnder(names, QStringLiteral("refs/remotes/")))
+        branchesCache->clear();
+    if (RepositoryWatcher::containsRefsUnder(names, QStringLiteral("refs/tags/")))
+        tagsCache->clear();
+    if (RepositoryWatcher::containsRefsUnder(names, QStringLiteral("refs/notes/")))
+        notesCache->clear();
+}
+
+void ManagerPrivate::headMoved()
+{
+    // the current branch is part of the branch list
+    branchesCache->clear();
+    referenceCache->clear();
 }
 
 void ManagerPrivate::freeRepo()
 {
     if (repo) {
-        managerMap.remove(repo);
+        {
+            QMutexLocker locker(&managerMapMutex);
+            managerMap.remove(repo);
+        }
         git_repository_free(repo);
         repo = nullptr;
     }
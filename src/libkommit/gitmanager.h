@@ -3,16 +3,20 @@
 
 #pragma once
 
+#include "entities/treewalker.h"
 #include "libkommit_export.h"
 
 #include "types.h"
 
+#include <QFuture>
 #include <QObject>
 #include <QSharedPointer>
 #include <QString>
 
 #include <git2.h>
 
+#include <functional>
+
 namespace Git
 {
 
@@ -32,6 +36,10 @@ class Note;
 class ManagerPrivate;
 class Commit;
 class CommitsCache;
+class BlobsCache;
+class TreesCache;
+class StringPool;
+class CommitGraph;
 class BranchesCache;
 class TagsCache;
 class RemotesCache;
@@ -41,10 +49,33 @@ class StashesCache;
 class ReferenceCache;
 class AbstractCommand;
 class BlameData;
+struct BlameDataRow;
+struct BlameHunk;
+struct BlameOptions;
+struct LineRange;
+struct LineHistoryEntry;
+struct PickaxeOptions;
+struct PickaxeMatch;
+struct GrepOptions;
+struct GrepMatch;
 class FileStatus;
+class Oid;
 class File;
 class TreeDiff;
-
+class ManagerPool;
+class WorkingTreeStatus;
+class RepositoryWatcher;
+class TrigramIndex;
+
+/**
+ * A repository handle and the caches of the objects read through it.
+ *
+ * A manager and everything it hands out must only be used by one thread at a time, in practice
+ * the thread it lives in. Work for other threads goes through runAsync(), which gives each job a
+ * handle of its own from a pool opened on the same repository, so any number of jobs can run in
+ * parallel. Entities created by a job belong to the job's handle: return ids, paths and other
+ * plain values and look them up again here.
+ */
 class LIBKOMMIT_EXPORT Manager : public QObject
 {
     Q_OBJECT
@@ -69,11 +100,31 @@ public:
     // run
     QString run(const AbstractCommand &cmd) const;
     QString runGit(const QStringList &args) const;
+    // Runs fn on the global thread pool with a repository handle that only this job uses
+    QFuture<void> runAsync(std::function<void(Manager *manager)> fn) const;
+    // Splits work on count items into as many runAsync() jobs as there are cores, one at least and
+    // count at most. fn gets the number of its job and the number of jobs to pick its share.
+    QList<QFuture<void>> runParallel(int count, std::function<void(Manager *manager, int job, int jobs)> fn) const;
+    // What job takes of items when they are dealt out round robin
+    template<class T>
+    static QList<T> jobShare(const QList<T> &items, int job, int jobs)
+    {
+        QList<T> share;
+        share.reserve(items.size() / jobs + 1);
+        for (auto i = job; i < items.size(); i += jobs)
+            share << items.at(i);
+        return share;
+    }
+    Q_REQUIRED_RESULT QSharedPointer<ManagerPool> workerPool() const;
 
     // common actions
     bool init(const QString &path);
     bool clone(const QString &url, const QString &localPath, CloneObserver *observer = nullptr);
-    void commit(const QString &message);
+    // Commits the index to HEAD the way `git commit -m` does; git itself is run when hooks or
+    // commit signing are configured. Fails if the commit would not change anything.
+    bool commit(const QString &message);
+    // Pushes the current branch to the branch it tracks. Without an observer to ask for
+    // credentials git itself is run, so its credential helpers and push.default apply.
     void push(PushObserver *observer = nullptr) const;
     bool open(const QString &newPath);
     QSharedPointer<Reference> head() const;
@@ -99,16 +150,54 @@ public:
 
     // files
     void addFile(const QString &file) const;
+    // Stages files in one index transaction, the index is written once
+    bool addFiles(const QStringList &files) const;
     Q_REQUIRED_RESULT QStringList ls(const QString &place) const;
+    // Tree place (a commit, branch, tag or tree) points to, its directories are listed on demand
+    Q_REQUIRED_RESULT QSharedPointer<Tree> tree(const QString &place) const;
+    // Streams the entries of the tree place (a commit, branch, tag or tree) points to
+    bool walkTree(const QString &place, const TreeWalker::Visitor &visitor, const QString &prefix = {}) const;
     Q_REQUIRED_RESULT QString fileContent(const QString &place, const QString &fileName) const;
     void saveFile(const QString &place, const QString &fileName, const QString &localFile) const;
     bool revertFile(const QString &filePath) const;
     bool removeFile(const QString &file, bool cached) const;
     Q_REQUIRED_RESULT QStringList fileLog(const QString &fileName) const;
+    // Commits that changed fileName, newest first, as `git log [--follow] -- fileName` lists them.
+    // Stops when callback returns false; path is the name of the file in that commit.
+    void fileLog(const QString &fileName, const std::function<bool(const Oid &commit, const QString &path)> &callback, bool followRenames = false) const;
     BlameData blame(QSharedPointer<File> file);
+    // Puts every line of fileName on the commit that last changed it and hands out each hunk as
+    // soon as it is known, newest commits first. Merges are followed into all parents. Stops when
+    // callback returns false; returns false if it was stopped or the file could not be read.
+    bool blame(const QString &fileName, const std::function<bool(const BlameHunk &hunk)> &callback, const BlameOptions &options) const;
+    // Row for a hunk with its commit from this manager, lines are those of the blamed version
+    Q_REQUIRED_RESULT BlameDataRow blameDataRow(const BlameHunk &hunk, const QStringList &lines) const;
+    // Commits that changed the given lines of fileName as of revision, newest first, like
+    // `git log -L`. The lines are followed back through every diff and rename. Stops when callback
+    // returns false; returns false if it was stopped or the file could not be read.
+    bool lineHistory(const QString &fileName,
+                     const QList<LineRange> &ranges,
+                     const std::function<bool(const LineHistoryEntry &entry)> &callback,
+                     const QString &revision = QStringLiteral("HEAD")) const;
+    // Those of commits whose diff to their first parent changes options.text, in the given order.
+    // Only files with different blob ids are read. Stops when callback returns false; returns
+    // false if it was stopped or the options are invalid.
+    bool pickaxe(const QList<Oid> &commits, const PickaxeOptions &options, const std::function<bool(const PickaxeMatch &match)> &callback) const;
+    // Files of the work tree below paths (relative, "" is the root) as git grep picks them: those
+    // in the index and, with untracked, the new files .gitignore does not exclude. Submodules and
+    // symbolic links are left out.
+    Q_REQUIRED_RESULT QStringList workingTreeFiles(const QStringList &paths, bool untracked = false) const;
+    // Lines of the given work tree files that match options.text, in order. Binary files are
+    // skipped like git does. Stops when callback returns false; returns false if it was stopped or
+    // the options are invalid.
+    bool grep(const QStringList &files, const GrepOptions &options, const std::function<bool(const GrepMatch &match)> &callback) const;
     Q_REQUIRED_RESULT QMap<QString, ChangeStatus> changedFiles() const;
     Q_REQUIRED_RESULT QMap<QString, ChangeStatus> changedFiles(const QString &hash) const;
+    // Same as changedFiles() for the files under the given directories (relative, "" is the root)
+    Q_REQUIRED_RESULT QMap<QString, ChangeStatus> changedFilesIn(const QStringList &directories) const;
     Q_REQUIRED_RESULT QStringList ignoredFiles() const;
+    // Watched status of the work tree, for the thread this manager lives in
+    Q_REQUIRED_RESULT WorkingTreeStatus *workingTreeStatus() const;
 
     Q_DECL_DEPRECATED
     Q_REQUIRED_RESULT QList<FileStatus> repoFilesStatus() const;
@@ -141,13 +230,22 @@ public:
     Q_REQUIRED_RESULT static Manager *owner(git_repository *repo);
 
     Q_REQUIRED_RESULT CommitsCache *commits() const;
+    Q_REQUIRED_RESULT CommitGraph *commitGraph() const;
     Q_REQUIRED_RESULT SubmodulesCache *submodules() const;
     Q_REQUIRED_RESULT RemotesCache *remotes() const;
     Q_REQUIRED_RESULT BranchesCache *branches() const;
     Q_REQUIRED_RESULT TagsCache *tags() const;
     Q_REQUIRED_RESULT NotesCache *notes() const;
     Q_REQUIRED_RESULT StashesCache *stashes() const;
+    Q_REQUIRED_RESULT BlobsCache *blobs() const;
+    Q_REQUIRED_RESULT TreesCache *trees() const;
+    // Subjects and identities of the commits of this repository, a new pool once the caches are reset
+    Q_REQUIRED_RESULT StringPool *stringPool() const;
     Q_REQUIRED_RESULT ReferenceCache *references() const;
+    // Change notifications of the git dir, for the thread this manager lives in
+    Q_REQUIRED_RESULT RepositoryWatcher *watcher() const;
+    // Content index of the whole history, empty until its first update()
+    Q_REQUIRED_RESULT TrigramIndex *trigramIndex() const;
 
 Q_SIGNALS:
     void pathChanged();
@@ -157,7 +255,9 @@ private:
     ManagerPrivate *d_ptr;
     Q_DECLARE_PRIVATE(Manager)
 
-    LIBKOMMIT_NO_EXPORT QStringList readAllNonEmptyOutput(const QStringList &cmd) const;
+    LIBKOMMIT_NO_EXPORT void resetReferenceCaches();
+
+    friend class ManagerPool;
 };
 
 } // namespace Git
@@ -0,0 +1,283 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "grep_p.h"
+#include "gitglobal_p.h"
+
+#include <QDir>
+#include <QFile>
+#include <QRegularExpression>
+
+#include <git2/index.h>
+#include <git2/repository.h>
+#include <git2/status.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+namespace Git
+{
+
+namespace
+{
+
+// Boyer-Moore-Horspool over raw bytes, ASCII letters are folded for case insensitive text
+class ByteMatcher
+{
+public:
+    ByteMatcher(const QByteArray &needle, bool foldCase)
+    {
+        for (int c = 0; c < 256; ++c)
+            mFold[c] = static_cast<uchar>(foldCase && c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+        for (const auto c : needle)
+            mNeedle.push_back(mFold[static_cast<uchar>(c)]);
+
+        const auto length = static_cast<std::ptrdiff_t>(mNeedle.size());
+        mSkip.fill(length);
+        for (std::ptrdiff_t i = 0; i + 1 < length; ++i)
+            mSkip[mNeedle[i]] = length - 1 - i;
+    }
+
+    const char *find(const char *begin, const char *end) const
+    {
+        const auto length = static_cast<std::ptrdiff_t>(mNeedle.size());
+        const auto last = mNeedle.back();
+        for (auto pos = begin; end - pos >= length;) {
+            const auto c = mFold[static_cast<uchar>(pos[length - 1])];
+            if (c == last && matchesAt(pos))
+                return pos;
+            pos += mSkip[c];
+        }
+        return end;
+    }
+
+private:
+    bool matchesAt(const char *pos) const
+    {
+        for (size_t i = 0; i + 1 < mNeedle.size(); ++i)
+            if (mFold[static_cast<uchar>(pos[i])] != mNeedle[i])
+                return false;
+        return true;
+    }
+
+    std::vector<uchar> mNeedle;
+    std::array<uchar, 256> mFold;
+    std::array<std::ptrdiff_t, 256> mSkip;
+};
+
+// Like git, a file with a NUL byte in its first 8000 bytes is binary
+bool isBinaryContent(const char *data, qint64 size)
+{
+    return std::memchr(data, 0, static_cast<size_t>(qMin<qint64>(size, 8000))) != nullptr;
+}
+
+QString lineText(const char *begin, const char *end)
+{
+    if (end != begin && end[-1] == '\r')
+        --end;
+    return QString::fromUtf8(begin, static_cast<int>(end - begin));
+}
+
+// Lines with a match of matcher, the file is only decoded where there is one
+bool grepBytes(const char *data, qint64 size, const ByteMatcher &matcher, const std::function<bool(int, const QString &)> &found)
+{
+    const auto end = data + size;
+    auto lineStart = data;
+    int line{1};
+
+    while (lineStart != end) {
+        const auto hit = matcher.find(lineStart, end);
+        if (hit == end)
+            break;
+
+        // memchr is vectorized by the C library, so lines without a match cost little
+        for (auto newLine = static_cast<const char *>(std::memchr(lineStart, '\n', hit - lineStart)); newLine;
+             newLine = static_cast<const char *>(std::memchr(lineStart, '\n', hit - lineStart))) {
+            ++line;
+            lineStart = newLine + 1;
+        }
+
+        auto lineEnd = static_cast<const char *>(std::memchr(hit, '\n', end - hit));
+        if (!lineEnd)
+            lineEnd = end;
+        if (!found(line, lineText(lineStart, lineEnd)))
+            return false;
+        if (lineEnd == end)
+            break;
+        ++line;
+        lineStart = lineEnd + 1;
+    }
+    return true;
+}
+
+bool grepText(const QString &text, const QRegularExpression &regex, const std::function<bool(int, const QString &)> &found)
+{
+    qsizetype lineStart{0};
+    int line{1};
+
+    while (lineStart < text.size()) {
+        const auto match = regex.match(text, lineStart);
+        if (!match.hasMatch())
+            break;
+
+        const auto hit = match.capturedStart();
+        for (auto newLine = text.indexOf(QLatin1Char('\n'), lineStart); newLine != -1 && newLine < hit; newLine = text.indexOf(QLatin1Char('\n'), lineStart)) {
+            ++line;
+            lineStart = newLine + 1;
+        }
+
+        auto lineEnd = text.indexOf(QLatin1Char('\n'), hit);
+        if (lineEnd == -1)
+            lineEnd = text.size();
+        auto length = lineEnd - lineStart;
+        if (length && text.at(lineEnd - 1) == QLatin1Char('\r'))
+            --length;
+        if (!found(line, text.mid(lineStart, length)))
+            return false;
+        ++line;
+        lineStart = lineEnd + 1;
+    }
+    return true;
+}
+
+}
+
+QStringList listWorkingTreeFiles(git_repository *repo, const QStringList &paths, bool untracked)
+{
+    QStringList files;
+    if (git_repository_is_bare(repo))
+        return files;
+
+    git_index *index{nullptr};
+
+    BEGIN
+    STEP git_repository_index(&index, repo);
+    PRINT_ERROR;
+    RETURN_IF_ERR(files);
+
+    const auto whole = paths.isEmpty() || paths.contains(QString{});
+    QList<QByteArray> prefixes;
+    if (whole)
+        prefixes << QByteArray{};
+    else
+        for (const auto &path : paths)
+            prefixes << path.toUtf8();
+
+    // the index is sorted by path, so each prefix is a run of entries
+    const auto entryCount = git_index_entrycount(index);
+    for (const auto &prefix : std::as_const(prefixes)) {
+        size_t i{0};
+        if (!prefix.isEmpty() && git_index_find_prefix(&i, index, prefix.constData()))
+            continue;
+
+        QByteArray previous;
+        for (; i < entryCount; ++i) {
+            const auto entry = git_index_get_byindex(index, i);
+            const QByteArray path{entry->path};
+            if (!path.startsWith(prefix))
+                break;
+            if (!prefix.isEmpty() && path.size() != prefix.size() && path.at(prefix.size()) != '/')
+                continue;
+
+            // a conflicted file has an entry per stage, sparse checkouts leave files out
+            if (path == previous || (entry->flags_extended & GIT_INDEX_ENTRY_SKIP_WORKTREE))
+                continue;
+            previous = path;
+            if (entry->mode == GIT_FILEMODE_COMMIT || entry->mode == GIT_FILEMODE_LINK)
+                continue;
+            files << QString::fromUtf8(path);
+        }
+    }
+    git_index_free(index);
+
+    if (!untracked)
+        return files;
+
+    // libgit2 reads the .gitignore of each directory once and does not enter ignored directories
+    git_status_list *list{nullptr};
+    git_status_options opts = GIT_STATUS_OPTIONS_INIT;
+    opts.show = GIT_STATUS_SHOW_WORKDIR_ONLY;
+    opts.flags = GIT_STATUS_OPT_INCLUDE_UNTRACKED | GIT_STATUS_OPT_RECURSE_UNTRACKED_DIRS | GIT_STATUS_OPT_EXCLUDE_SUBMODULES;
+
+    std::vector<char *> pathPointers;
+    if (!whole) {
+        for (auto &prefix : prefixes)
+            pathPointers.push_back(prefix.data());
+        opts.flags |= GIT_STATUS_OPT_DISABLE_PATHSPEC_MATCH;
+    }
+    opts.pathspec = git_strarray{pathPointers.data(), pathPointers.size()};
+
+    STEP git_status_list_new(&list, repo, &opts);
+    PRINT_ERROR;
+    RETURN_IF_ERR(files);
+
+    const auto count = git_status_list_entrycount(list);
+    for (size_t i = 0; i < count; ++i) {
+        const auto entry = git_status_byindex(list, i);
+        if ((entry->status & GIT_STATUS_WT_NEW) && entry->index_to_workdir->new_file.mode != GIT_FILEMODE_LINK)
+            files << QString::fromUtf8(entry->index_to_workdir->new_file.path);
+    }
+
+    git_status_list_free(list);
+    return files;
+}
+
+bool grepFiles(const QString &workDir, const QStringList &files, const GrepOptions &options, const std::function<bool(const GrepMatch &)> &callback)
+{
+    if (options.text.isEmpty())
+        return false;
+
+    // case insensitive matching of other than ASCII letters needs the decoded text
+    const auto ascii = std::all_of(options.text.cbegin(), options.text.cend(), [](QChar c) {
+        return c.unicode() < 0x80;
+    });
+    const auto useRegex = options.regularExpression || (options.caseSensitivity == Qt::CaseInsensitive && !ascii);
+
+    QRegularExpression::PatternOptions patternOptions{QRegularExpression::MultilineOption};
+    if (options.caseSensitivity == Qt::CaseInsensitive)
+        patternOptions |= QRegularExpression::CaseInsensitiveOption;
+    const QRegularExpression regex{options.regularExpression ? options.text : QRegularExpression::escape(options.text), patternOptions};
+    if (useRegex && !regex.isValid())
+        return false;
+
+    const ByteMatcher matcher{options.text.toUtf8(), options.caseSensitivity == Qt::CaseInsensitive};
+    const QDir root{workDir};
+
+    for (const auto &path : files) {
+        QFile file{root.filePath(path)};
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+        auto size = file.size();
+        if (!size)
+            continue;
+
+        // the mapping goes away with the file, reading is the fallback for what cannot be mapped;
+        // the file may have changed since size() so what was read is what counts
+        QByteArray buffer;
+        auto data = reinterpret_cast<const char *>(file.map(0, size));
+        if (!data) {
+            buffer = file.readAll();
+            data = buffer.constData();
+            size = buffer.size();
+            if (!size)
+                continue;
+        }
+        if (isBinaryContent(data, size))
+            continue;
+
+        const auto found = [&](int line, const QString &text) {
+            return callback(GrepMatch{path, line, text});
+        };
+        if (!(useRegex ? grepText(QString::fromUtf8(data, static_cast<int>(size)), regex, found) : grepBytes(data, size, matcher, found)))
+            return false;
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,29 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include <QString>
+
+namespace Git
+{
+
+// What Manager::grep() looks for in the lines of work tree files
+struct GrepOptions {
+    QString text;
+    bool regularExpression{false};
+    Qt::CaseSensitivity caseSensitivity{Qt::CaseSensitive};
+};
+
+// A matching line, as plain values so matches can cross threads
+struct GrepMatch {
+    QString path;
+    // 1-based
+    int line{0};
+    QString text;
+};
+
+}
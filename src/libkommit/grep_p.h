@@ -0,0 +1,25 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "grep.h"
+
+#include <QStringList>
+
+#include <git2/types.h>
+
+#include <functional>
+
+namespace Git
+{
+
+// The work tree side of Manager::workingTreeFiles() and Manager::grep(). Files are matched as raw
+// bytes where the text allows it, and only decoded around a match.
+QStringList listWorkingTreeFiles(git_repository *repo, const QStringList &paths, bool untracked);
+bool grepFiles(const QString &workDir, const QStringList &files, const GrepOptions &options, const std::function<bool(const GrepMatch &)> &callback);
+
+}
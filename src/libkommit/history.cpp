@@ -0,0 +1,207 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "history_p.h"
+#include "caches/commitgraph.h"
+#include "gitglobal_p.h"
+
+#include <git2/blob.h>
+#include <git2/commit.h>
+#include <git2/diff.h>
+#include <git2/object.h>
+#include <git2/revparse.h>
+#include <git2/tree.h>
+
+namespace Git
+{
+
+namespace
+{
+
+int collectLineDiffHunk(const git_diff_delta *, const git_diff_hunk *hunk, void *payload)
+{
+    // a side without lines has its start on the line before the hunk
+    const int newStart = hunk->new_lines ? hunk->new_start - 1 : hunk->new_start;
+    const int oldStart = hunk->old_lines ? hunk->old_start - 1 : hunk->old_start;
+    const int newEnd = newStart + hunk->new_lines;
+    const int oldEnd = oldStart + hunk->old_lines;
+
+    static_cast<QVector<LineDiffHunk> *>(payload)->append(LineDiffHunk{oldStart, oldEnd, newStart, newEnd, oldEnd - newEnd});
+    return 0;
+}
+
+}
+
+bool readHistoryCommit(git_repository *repo, CommitGraph *graph, const Oid &id, HistoryCommit *out)
+{
+    out->parents.clear();
+    out->inGraph = false;
+
+    quint32 position;
+    if (graph->isValid() && graph->find(id, &position)) {
+        QVarLengthArray<quint32, 2> parents;
+        graph->parents(position, parents);
+
+        out->inGraph = true;
+        out->graphPosition = position;
+
+        out->tree = graph->tree(position);
+        out->time = graph->commitTime(position);
+        for (const auto parent : parents)
+            out->parents.append(graph->oid(parent));
+        return true;
+    }
+
+    git_commit *commit{nullptr};
+    if (git_commit_lookup(&commit, repo, id.oidPtr()))
+        return false;
+
+    out->tree = Oid{git_commit_tree_id(commit)};
+    out->time = git_commit_time(commit);
+    for (unsigned int i = 0; i < git_commit_parentcount(commit); ++i)
+        out->parents.append(Oid{git_commit_parent_id(commit, i)});
+
+    git_commit_free(commit);
+    return true;
+}
+
+bool pathDiffers(git_repository *repo, const Oid &treeA, const Oid &treeB, const QList<QByteArray> &components)
+{
+    const auto descend = [repo](Oid &id, git_filemode_t &mode, const QByteArray &name) {
+        git_tree *tree{nullptr};
+        if (id.isNull() || mode != GIT_FILEMODE_TREE || git_tree_lookup(&tree, repo, id.oidPtr())) {
+            id = Oid{};
+            mode = GIT_FILEMODE_UNREADABLE;
+            return;
+        }
+
+        auto entry = git_tree_entry_byname(tree, name.constData());
+        id = entry ? Oid{git_tree_entry_id(entry)} : Oid{};
+        mode = entry ? git_tree_entry_filemode(entry) : GIT_FILEMODE_UNREADABLE;
+        git_tree_free(tree);
+    };
+
+    auto a = treeA;
+    auto b = treeB;
+    auto modeA = a.isNull() ? GIT_FILEMODE_UNREADABLE : GIT_FILEMODE_TREE;
+    auto modeB = b.isNull() ? GIT_FILEMODE_UNREADABLE : GIT_FILEMODE_TREE;
+
+    for (const auto &name : components) {
+        if (a == b && modeA == modeB)
+            return false;
+        descend(a, modeA, name);
+        descend(b, modeB, name);
+    }
+    return a != b || modeA != modeB;
+}
+
+QByteArray renamedFrom(git_repository *repo, const Oid &oldTree, const Oid &newTree, const QByteArray &path)
+{
+    git_tree *oldTreePtr{nullptr};
+    git_tree *newTreePtr{nullptr};
+    git_diff *diff{nullptr};
+    git_diff_find_options findOptions = GIT_DIFF_FIND_OPTIONS_INIT;
+    findOptions.flags = GIT_DIFF_FIND_RENAMES;
+
+    BEGIN
+    STEP git_tree_lookup(&oldTreePtr, repo, oldTree.oidPtr());
+    STEP git_tree_lookup(&newTreePtr, repo, newTree.oidPtr());
+    STEP git_diff_tree_to_tree(&diff, repo, oldTreePtr, newTreePtr, nullptr);
+    STEP git_diff_find_similar(diff, &findOptions);
+    PRINT_ERROR;
+
+    QByteArray oldPath;
+    if (IS_OK) {
+        const auto count = git_diff_num_deltas(diff);
+        for (size_t i = 0; i < count; ++i) {
+            auto delta = git_diff_get_delta(diff, i);
+            if (delta->status == GIT_DELTA_RENAMED && path == delta->new_file.path) {
+                oldPath = delta->old_file.path;
+                break;
+            }
+        }
+    }
+
+    git_diff_free(diff);
+    git_tree_free(newTreePtr);
+    git_tree_free(oldTreePtr);
+    return oldPath;
+}
+
+Oid blobAt(git_repository *repo, const Oid &tree, const QByteArray &path)
+{
+    git_tree *treePtr{nullptr};
+    git_tree_entry *entry{nullptr};
+    Oid id;
+
+    if (!tree.isNull() && !git_tree_lookup(&treePtr, repo, tree.oidPtr()) && !git_tree_entry_bypath(&entry, treePtr, path.constData())
+        && git_tree_entry_type(entry) == GIT_OBJECT_BLOB)
+        id = Oid{git_tree_entry_id(entry)};
+
+    git_tree_entry_free(entry);
+    git_tree_free(treePtr);
+    return id;
+}
+
+Oid revisionCommit(git_repository *repo, const QString &revision)
+{
+    git_object *object{nullptr};
+    git_object *commit{nullptr};
+
+    BEGIN
+    STEP git_revparse_single(&object, repo, revision.toUtf8().constData());
+    STEP git_object_peel(&commit, object, GIT_OBJECT_COMMIT);
+    PRINT_ERROR;
+
+    const auto id = IS_OK ? Oid{git_object_id(commit)} : Oid{};
+    git_object_free(commit);
+    git_object_free(object);
+    return id;
+}
+
+QVarLengthArray<FileParent, 2> fileParents(git_repository *repo, CommitGraph *graph, const HistoryCommit &commit, const QByteArray &path, bool followRenames)
+{
+    QVarLengthArray<FileParent, 2> parents;
+    for (const auto &parentId : commit.parents) {
+        FileParent parent{parentId, {}, path, {}};
+        if (!readHistoryCommit(repo, graph, parentId, &parent.commit))
+            parent.commit = HistoryCommit{};
+
+        parent.blob = blobAt(repo, parent.commit.tree, path);
+        if (parent.blob.isNull() && followRenames && commit.parents.size() == 1 && !parent.commit.tree.isNull()) {
+            const auto renamed = renamedFrom(repo, parent.commit.tree, commit.tree, path);
+            if (!renamed.isEmpty()) {
+                parent.path = renamed;
+                parent.blob = blobAt(repo, parent.commit.tree, renamed);
+            }
+        }
+        parents.append(parent);
+    }
+    return parents;
+}
+
+bool diffLines(git_repository *repo, const Oid &oldBlob, const Oid &newBlob, QVector<LineDiffHunk> *hunks)
+{
+    git_blob *oldBlobPtr{nullptr};
+    git_blob *newBlobPtr{nullptr};
+    git_diff_options options = GIT_DIFF_OPTIONS_INIT;
+    options.context_lines = 0;
+    options.interhunk_lines = 0;
+    // binary files have no hunks, which would leave every line unchanged
+    options.flags = GIT_DIFF_FORCE_TEXT;
+
+    BEGIN
+    STEP git_blob_lookup(&oldBlobPtr, repo, oldBlob.oidPtr());
+    STEP git_blob_lookup(&newBlobPtr, repo, newBlob.oidPtr());
+    STEP git_diff_blobs(oldBlobPtr, nullptr, newBlobPtr, nullptr, &options, nullptr, nullptr, &collectLineDiffHunk, nullptr, hunks);
+    PRINT_ERROR;
+
+    git_blob_free(newBlobPtr);
+    git_blob_free(oldBlobPtr);
+    return IS_OK;
+}
+
+}
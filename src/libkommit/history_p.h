@@ -0,0 +1,73 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "entities/oid.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVarLengthArray>
+#include <QVector>
+
+#include <git2/types.h>
+
+// Walking the history of one file, shared by the file log, blame and the line history
+namespace Git
+{
+
+class CommitGraph;
+
+// Commit fields needed to walk the history of a path, read from the commit-graph when it covers the commit
+struct HistoryCommit {
+    Oid tree;
+    qint64 time{0};
+    QVarLengthArray<Oid, 2> parents;
+    bool inGraph{false};
+    quint32 graphPosition{0};
+};
+
+// A parent of a commit in the history of one file
+struct FileParent {
+    Oid id;
+    HistoryCommit commit;
+    // name of the file in the parent, and its blob there (null if the parent does not have it)
+    QByteArray path;
+    Oid blob;
+};
+
+// Lines a diff changed, [start, end) on each side; old line numbers after them are new ones plus delta
+struct LineDiffHunk {
+    int oldStart;
+    int oldEnd;
+    int newStart;
+    int newEnd;
+    int delta;
+};
+
+bool readHistoryCommit(git_repository *repo, CommitGraph *graph, const Oid &id, HistoryCommit *out);
+
+// Whether the entry at the path differs between two trees, a null id stands for a missing tree.
+// Both trees are descended together and the walk stops at the first identical subtree, so
+// directories that did not change are never loaded.
+bool pathDiffers(git_repository *repo, const Oid &treeA, const Oid &treeB, const QList<QByteArray> &components);
+
+// Old name of a file that was renamed to path between the two trees, empty if it was not
+QByteArray renamedFrom(git_repository *repo, const Oid &oldTree, const Oid &newTree, const QByteArray &path);
+
+// Id of the blob at path in a tree, null if there is none
+Oid blobAt(git_repository *repo, const Oid &tree, const QByteArray &path);
+
+// Commit a revision peels to, null if there is none
+Oid revisionCommit(git_repository *repo, const QString &revision);
+
+QVarLengthArray<FileParent, 2> fileParents(git_repository *repo, CommitGraph *graph, const HistoryCommit &commit, const QByteArray &path, bool followRenames);
+
+// Changed lines between two blobs, without context
+bool diffLines(git_repository *repo, const Oid &oldBlob, const Oid &newBlob, QVector<LineDiffHunk> *hunks);
+
+}
@@ -0,0 +1,111 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "historyblobs.h"
+#include "gitmanager.h"
+
+#include <QSet>
+
+#include <algorithm>
+
+namespace Git
+{
+
+bool HistoryBlobs::addPlace(Manager *git, const QString &place, const Filter &filter)
+{
+    const auto placeIndex = static_cast<int>(mPlaces.size());
+    mPlaces << place;
+
+    // directories read during this walk, the top level has no node of its own
+    QHash<QString, int> directories;
+
+    const auto link = [this, placeIndex, &directories](int node, const QString &path) {
+        const auto slash = path.lastIndexOf(QLatin1Char('/'));
+        if (slash == -1)
+            mNodes[node].places << placeIndex;
+        else
+            mNodes[node].parents << directories.value(path.left(slash));
+    };
+
+    return git->walkTree(place, [&](const TreeWalker::Entry &entry) {
+        const Key key{entry.path(), entry.oid()};
+
+        if (entry.isDir()) {
+            auto it = mDirectoryNodes.constFind(key);
+            if (it != mDirectoryNodes.cend()) {
+                link(*it, entry.path());
+                return TreeWalker::Action::SkipChildren;
+            }
+
+            const auto node = static_cast<int>(mNodes.size());
+            mNodes.append(Node{});
+            mDirectoryNodes.insert(key, node);
+            directories.insert(entry.path(), node);
+            link(node, entry.path());
+            return TreeWalker::Action::Continue;
+        }
+
+        if (!entry.isFile() || (filter && !filter(entry.path())))
+            return TreeWalker::Action::Continue;
+
+        // the directory holding the file is read for the first time, so this link is new as well
+        auto it = mFileIndex.constFind(key);
+        if (it != mFileIndex.cend()) {
+            link(mFileNodes.at(*it), entry.path());
+            return TreeWalker::Action::Continue;
+        }
+
+        const auto node = static_cast<int>(mNodes.size());
+        mNodes.append(Node{});
+        mFileIndex.insert(key, static_cast<int>(mFiles.size()));
+        mFiles.append(File{entry.path(), entry.oid()});
+        mFileNodes.append(node);
+        link(node, entry.path());
+        return TreeWalker::Action::Continue;
+    });
+}
+
+const QStringList &HistoryBlobs::places() const
+{
+    return mPlaces;
+}
+
+const QList<HistoryBlobs::File> &HistoryBlobs::files() const
+{
+    return mFiles;
+}
+
+QHash<Oid, QList<int>> HistoryBlobs::blobs() const
+{
+    QHash<Oid, QList<int>> blobs;
+    for (int i = 0; i < mFiles.size(); ++i)
+        blobs[mFiles.at(i).blob] << i;
+    return blobs;
+}
+
+QList<int> HistoryBlobs::placesOf(int file) const
+{
+    QSet<int> places;
+    QSet<int> visited{mFileNodes.at(file)};
+    QList<int> pending{mFileNodes.at(file)};
+
+    while (!pending.isEmpty()) {
+        const auto &node = mNodes.at(pending.takeLast());
+        for (const auto place : node.places)
+            places.insert(place);
+        for (const auto parent : node.parents)
+            if (!visited.contains(parent)) {
+                visited.insert(parent);
+                pending << parent;
+            }
+    }
+
+    QList<int> sorted{places.cbegin(), places.cend()};
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+}
@@ -0,0 +1,71 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "entities/oid.h"
+#include "libkommit_export.h"
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+namespace Git
+{
+
+class Manager;
+
+/**
+ * The distinct (path, blob) pairs in the trees of many places (commits, branches, tags), and the
+ * places that have each of them.
+ *
+ * A directory that shows up again with the same id at the same path is not read again, so
+ * collecting a whole history costs about as much as reading the trees that changed in it. Built
+ * on one thread; once complete, the const methods may be called from any number of threads.
+ */
+class LIBKOMMIT_EXPORT HistoryBlobs
+{
+public:
+    struct File {
+        QString path;
+        Oid blob;
+    };
+
+    using Filter = std::function<bool(const QString &path)>;
+
+    // Adds the files of the tree place points to that pass filter. Returns false if the tree could not be read.
+    bool addPlace(Manager *git, const QString &place, const Filter &filter = {});
+
+    Q_REQUIRED_RESULT const QStringList &places() const;
+    Q_REQUIRED_RESULT const QList<File> &files() const;
+    // Every distinct blob with the indices of the files that have it
+    Q_REQUIRED_RESULT QHash<Oid, QList<int>> blobs() const;
+    // Indices of the places that have the file, in the order they were added
+    Q_REQUIRED_RESULT QList<int> placesOf(int file) const;
+
+private:
+    // a directory or a file at one path, reached from other directories or straight from places
+    struct Node {
+        QList<int> parents;
+        QList<int> places;
+    };
+
+    using Key = QPair<QString, Oid>;
+
+    QStringList mPlaces;
+    QList<File> mFiles;
+    QList<Node> mNodes;
+    // node of every file, by index in mFiles
+    QList<int> mFileNodes;
+    QHash<Key, int> mDirectoryNodes;
+    QHash<Key, int> mFileIndex;
+};
+
+}
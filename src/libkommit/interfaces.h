@@ -8,13 +8,13 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <QSharedPointer>
 
+#include "entities/oid.h"
 #include "libkommit_export.h"
 
 namespace Git
 {
 
 class Tree;
-class Oid;
 
 class LIBKOMMIT_EXPORT ITree
 {
@@ -34,7 +34,7 @@ class LIBKOMMIT_EXPORT IOid
 {
 public:
     virtual ~IOid();
-    virtual QSharedPointer<Oid> oid() const = 0;
+    virtual Oid oid() const = 0;
 };
 
 inline IOid::~IOid()
@@ -0,0 +1,205 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "linehistory_p.h"
+#include "history_p.h"
+
+#include <QHash>
+
+#include <algorithm>
+#include <queue>
+
+namespace Git
+{
+
+namespace
+{
+
+// Lines of a file version, zero based [start, end)
+struct LineSpan {
+    int start;
+    int end;
+};
+
+void normalizeSpans(QVector<LineSpan> &spans)
+{
+    std::sort(spans.begin(), spans.end(), [](const LineSpan &l, const LineSpan &r) {
+        return l.start < r.start;
+    });
+
+    int last{-1};
+    for (const auto &span : std::as_const(spans)) {
+        if (last != -1 && span.start <= spans.at(last).end)
+            spans[last].end = std::max(spans.at(last).end, span.end);
+        else
+            spans[++last] = span;
+    }
+    spans.resize(last + 1);
+}
+
+// Moves spans of the new version of a file to the old one. Lines a hunk replaced become the lines
+// it replaced them with, lines that were only added are dropped. Returns whether any hunk touched
+// the spans.
+bool mapSpans(const QVector<LineDiffHunk> &hunks, const QVector<LineSpan> &spans, QVector<LineSpan> *mapped)
+{
+    // first hunk that ends after the line
+    const auto hunkAfter = [&hunks](int line) {
+        return std::partition_point(hunks.cbegin(),
+                                    hunks.cend(),
+                                    [line](const LineDiffHunk &h) {
+                                        return h.newEnd <= line;
+                                    })
+            - hunks.cbegin();
+    };
+    const auto deltaBefore = [&hunks](qsizetype hunk) {
+        return hunk ? hunks.at(hunk - 1).delta : 0;
+    };
+
+    auto touched{false};
+    for (const auto &span : spans) {
+        auto first = hunkAfter(span.start);
+        const auto start = first < hunks.size() && hunks.at(first).newStart <= span.start ? hunks.at(first).oldStart : span.start + deltaBefore(first);
+
+        auto last = hunkAfter(span.end - 1);
+        const auto end = last < hunks.size() && hunks.at(last).newStart <= span.end - 1 ? hunks.at(last).oldEnd : span.end + deltaBefore(last);
+
+        // hunks that remove lines have no lines of their own, they count when they are inside
+        for (auto i = first; i < hunks.size() && hunks.at(i).newStart < span.end && !touched; ++i)
+            touched = hunks.at(i).newEnd > hunks.at(i).newStart || hunks.at(i).newStart > span.start;
+
+        if (start < end)
+            mapped->append(LineSpan{start, end});
+    }
+
+    normalizeSpans(*mapped);
+    return touched;
+}
+
+}
+
+bool fileLineHistory(git_repository *repo,
+                     CommitGraph *graph,
+                     const QString &fileName,
+                     const QList<LineRange> &ranges,
+                     const std::function<bool(const LineHistoryEntry &)> &callback,
+                     const QString &revision)
+{
+    auto path = fileName.toUtf8();
+    while (path.startsWith('/'))
+        path.remove(0, 1);
+
+    const auto start = revisionCommit(repo, revision);
+    HistoryCommit startCommit;
+    if (start.isNull() || !readHistoryCommit(repo, graph, start, &startCommit))
+        return false;
+
+    const auto startBlob = blobAt(repo, startCommit.tree, path);
+    if (startBlob.isNull())
+        return false;
+
+    QVector<LineSpan> spans;
+    for (const auto &range : ranges)
+        if (range.count > 0)
+            spans << LineSpan{std::max(0, range.start - 1), range.start - 1 + range.count};
+    normalizeSpans(spans);
+
+    using Key = QPair<Oid, QByteArray>;
+    struct Pending {
+        HistoryCommit commit;
+        Oid blob;
+        QVector<LineSpan> spans;
+    };
+    struct Queued {
+        qint64 time;
+        Key key;
+
+        bool operator<(const Queued &other) const
+        {
+            return time < other.time;
+        }
+    };
+
+    QHash<Key, Pending> pending;
+    std::priority_queue<Queued> queue;
+
+    const auto follow = [&](const Oid &id, const HistoryCommit &commit, const QByteArray &path, const Oid &blob, const QVector<LineSpan> &spans) {
+        const Key key{id, path};
+        auto it = pending.find(key);
+        if (it != pending.end()) {
+            it->spans << spans;
+            return;
+        }
+        pending.insert(key, Pending{commit, blob, spans});
+        queue.push(Queued{commit.time, key});
+    };
+
+    // both sides of a merge often reach the same pair of blobs, each pair is only diffed once
+    QHash<QPair<Oid, Oid>, QVector<LineDiffHunk>> diffs;
+    const auto diffOf = [&](const Oid &oldBlob, const Oid &newBlob) -> const QVector<LineDiffHunk> * {
+        const QPair<Oid, Oid> key{oldBlob, newBlob};
+        auto it = diffs.find(key);
+        if (it == diffs.end()) {
+            QVector<LineDiffHunk> hunks;
+            if (!diffLines(repo, oldBlob, newBlob, &hunks))
+                return nullptr;
+            it = diffs.insert(key, hunks);
+        }
+        return &it.value();
+    };
+
+    if (spans.isEmpty())
+        return true;
+    follow(start, startCommit, path, startBlob, spans);
+
+    while (!queue.empty()) {
+        const auto key = queue.top().key;
+        queue.pop();
+
+        auto current = pending.take(key);
+        normalizeSpans(current.spans);
+
+        const auto parents = fileParents(repo, graph, current.commit, key.second, true);
+
+        // same simplification as git log, a parent with the very same content gets the lines as they are
+        auto same = std::find_if(parents.cbegin(), parents.cend(), [&current](const FileParent &parent) {
+            return parent.blob == current.blob;
+        });
+        if (same != parents.cend()) {
+            follow(same->id, same->commit, same->path, same->blob, current.spans);
+            continue;
+        }
+
+        // a merge only counts when the lines differ from all sides, a root commit or a parent
+        // without the file means the lines were added here
+        auto changed{true};
+        for (const auto &parent : parents) {
+            if (parent.blob.isNull())
+                continue;
+
+            auto hunks = diffOf(parent.blob, current.blob);
+            if (!hunks)
+                continue;
+
+            QVector<LineSpan> mapped;
+            changed = mapSpans(*hunks, current.spans, &mapped) && changed;
+            if (!mapped.isEmpty())
+                follow(parent.id, parent.commit, parent.path, parent.blob, mapped);
+        }
+
+        if (!changed)
+            continue;
+
+        LineHistoryEntry entry{key.first, QString::fromUtf8(key.second), {}};
+        for (const auto &span : std::as_const(current.spans))
+            entry.ranges << LineRange{span.start + 1, span.end - span.start};
+        if (!callback(entry))
+            return false;
+    }
+
+    return true;
+}
+
+}
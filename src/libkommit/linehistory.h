@@ -0,0 +1,32 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "entities/oid.h"
+
+#include <QList>
+#include <QString>
+
+namespace Git
+{
+
+// Lines of one version of a file, start is one based
+struct LineRange {
+    int start{0};
+    int count{0};
+};
+
+// A commit that changed the followed lines, as plain values so entries can cross threads
+struct LineHistoryEntry {
+    Oid commitId;
+    // name of the file in that commit
+    QString path;
+    // where the followed lines are in that commit's version of the file
+    QList<LineRange> ranges;
+};
+
+}
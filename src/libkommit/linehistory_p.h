@@ -0,0 +1,29 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "linehistory.h"
+
+#include <git2/types.h>
+
+#include <functional>
+
+namespace Git
+{
+
+class CommitGraph;
+
+// The line history behind Manager::lineHistory(). The followed lines are moved through the diff
+// of each commit to its parents, and a commit is reported where the diffs of all parents touch them.
+bool fileLineHistory(git_repository *repo,
+                     CommitGraph *graph,
+                     const QString &fileName,
+                     const QList<LineRange> &ranges,
+                     const std::function<bool(const LineHistoryEntry &)> &callback,
+                     const QString &revision);
+
+}
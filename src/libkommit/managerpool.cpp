@@ -0,0 +1,71 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "managerpool.h"
+#include "gitmanager.h"
+
+#include <QThread>
+
+#include <utility>
+
+namespace Git
+{
+
+ManagerPool::ManagerPool(QString path, int maxIdle)
+    : mPath{std::move(path)}
+    , mMaxIdle{maxIdle > 0 ? maxIdle : QThread::idealThreadCount()}
+{
+}
+
+ManagerPool::~ManagerPool()
+{
+    qDeleteAll(mIdle);
+}
+
+const QString &ManagerPool::path() const
+{
+    return mPath;
+}
+
+QSharedPointer<Manager> ManagerPool::acquire()
+{
+    Manager *manager{nullptr};
+    {
+        QMutexLocker locker(&mMutex);
+        if (!mIdle.isEmpty())
+            manager = mIdle.takeLast();
+    }
+
+    if (!manager) {
+        manager = new Manager{mPath};
+        // handles move between the threads of a thread pool and never process events
+        manager->moveToThread(nullptr);
+    }
+
+    QWeakPointer<ManagerPool> pool = sharedFromThis();
+    return QSharedPointer<Manager>{manager, [pool](Manager *manager) {
+                                       if (auto strongPool = pool.toStrongRef())
+                                           strongPool->release(manager);
+                                       else
+                                           delete manager;
+                                   }};
+}
+
+void ManagerPool::release(Manager *manager)
+{
+    if (manager->isValid()) {
+        manager->resetReferenceCaches();
+
+        QMutexLocker locker(&mMutex);
+        if (mIdle.size() < mMaxIdle) {
+            mIdle << manager;
+            return;
+        }
+    }
+    delete manager;
+}
+
+}
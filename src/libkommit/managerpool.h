@@ -0,0 +1,49 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "libkommit_export.h"
+
+#include <QEnableSharedFromThis>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+
+namespace Git
+{
+
+class Manager;
+
+/**
+ * Repository handles for worker threads.
+ *
+ * A handle is only ever used by one thread at a time. Handles of finished jobs stay open and
+ * are handed to the next job, which also keeps their commit and blob caches warm; caches of
+ * references are dropped in between as the repository may have changed.
+ */
+class LIBKOMMIT_EXPORT ManagerPool : public QEnableSharedFromThis<ManagerPool>
+{
+public:
+    explicit ManagerPool(QString path, int maxIdle = 0);
+    ~ManagerPool();
+
+    Q_REQUIRED_RESULT const QString &path() const;
+
+    // The handle goes back to the pool when the last reference to it is dropped. Thread safe.
+    Q_REQUIRED_RESULT QSharedPointer<Manager> acquire();
+
+private:
+    void release(Manager *manager);
+
+    const QString mPath;
+    const int mMaxIdle;
+    QMutex mMutex;
+    QList<Manager *> mIdle;
+};
+
+}
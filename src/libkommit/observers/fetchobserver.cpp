@@ -27,10 +27,7 @@ int git_helper_update_tips_cb(const char *refname, const git_oid *a, const git_o
     auto bridge = reinterpret_cast<Git::FetchObserverBridge *>(data);
 
     auto ref = bridge->manager->references()->findByName(QString{refname});
-    auto oidA = QSharedPointer<Oid>{new Oid{a}};
-    auto oidB = QSharedPointer<Oid>{new Oid{b}};
-
-    Q_EMIT bridge->observer->updateRef(ref, oidA, oidB);
+    Q_EMIT bridge->observer->updateRef(ref, Oid{a}, Oid{b});
     return 0;
 }
 
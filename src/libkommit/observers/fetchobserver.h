@@ -6,6 +6,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #pragma once
 
+#include "entities/oid.h"
 #include "libkommit_export.h"
 
 #include <QObject>
@@ -19,7 +20,6 @@ namespace Git
 {
 
 class Manager;
-class Oid;
 class Reference;
 class Credential;
 
@@ -67,7 +67,7 @@ Q_SIGNALS:
     void credentialRequeted(const QString &url, Credential *cred);
     void transferProgress(const FetchTransferStat *stat);
     void packProgress(const PackProgress *p);
-    void updateRef(QSharedPointer<Reference> reference, QSharedPointer<Oid> a, QSharedPointer<Oid> b);
+    void updateRef(QSharedPointer<Reference> reference, const Git::Oid &a, const Git::Oid &b);
     void finished();
 
 private:
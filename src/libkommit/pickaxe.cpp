@@ -0,0 +1,175 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "pickaxe_p.h"
+#include "caches/blobscache.h"
+#include "entities/blob.h"
+#include "gitglobal_p.h"
+#include "history_p.h"
+
+#include <QHash>
+#include <QRegularExpression>
+
+#include <git2/diff.h>
+#include <git2/tree.h>
+
+namespace Git
+{
+
+namespace
+{
+
+// Non-overlapping occurrences, the way git log -S counts them
+int countOccurrences(const QString &text, const PickaxeOptions &options, const QRegularExpression &regex)
+{
+    int count{0};
+    if (options.regularExpression) {
+        auto matches = regex.globalMatch(text);
+        for (; matches.hasNext(); matches.next())
+            ++count;
+        return count;
+    }
+
+    for (auto i = text.indexOf(options.text, 0, options.caseSensitivity); i != -1; i = text.indexOf(options.text, i + options.text.size(), options.caseSensitivity))
+        ++count;
+    return count;
+}
+
+struct ChangedLineMatch {
+    const QRegularExpression *regex;
+    bool found{false};
+};
+
+int matchChangedLine(const git_diff_delta *, const git_diff_hunk *, const git_diff_line *line, void *payload)
+{
+    if (line->origin != GIT_DIFF_LINE_ADDITION && line->origin != GIT_DIFF_LINE_DELETION)
+        return 0;
+
+    auto match = static_cast<ChangedLineMatch *>(payload);
+    auto length = line->content_len;
+    if (length && line->content[length - 1] == '\n')
+        --length;
+    if (!QString::fromUtf8(line->content, static_cast<int>(length)).contains(*match->regex))
+        return 0;
+
+    // stops the diff, one matching line is enough
+    match->found = true;
+    return 1;
+}
+
+}
+
+bool commitsPickaxe(git_repository *repo,
+                    CommitGraph *graph,
+                    BlobsCache *blobs,
+                    const QList<Oid> &commits,
+                    const PickaxeOptions &options,
+                    const std::function<bool(const PickaxeMatch &)> &callback)
+{
+    if (options.text.isEmpty())
+        return false;
+
+    const auto useRegex = options.regularExpression || options.mode == PickaxeOptions::Mode::ChangedLines;
+    const QRegularExpression regex{options.text,
+                                   options.caseSensitivity == Qt::CaseSensitive ? QRegularExpression::NoPatternOption
+                                                                                : QRegularExpression::CaseInsensitiveOption};
+    if (useRegex && !regex.isValid())
+        return false;
+
+    // consecutive commits mostly share the blobs one of them changed, -1 stands for a binary blob
+    QHash<Oid, int> counts;
+    const auto occurrences = [&](const Oid &blobId) {
+        if (blobId.isNull())
+            return 0;
+        auto it = counts.constFind(blobId);
+        if (it != counts.cend())
+            return *it;
+
+        const auto blob = blobs->findByOid(blobId);
+        const auto count = !blob || blob->isBinary() ? -1 : countOccurrences(blob->text(), options, regex);
+        counts.insert(blobId, count);
+        return count;
+    };
+
+    git_diff_options lineOptions = GIT_DIFF_OPTIONS_INIT;
+    lineOptions.context_lines = 0;
+    lineOptions.interhunk_lines = 0;
+
+    for (const auto &id : commits) {
+        HistoryCommit commit;
+        HistoryCommit parent;
+        if (!readHistoryCommit(repo, graph, id, &commit))
+            continue;
+        if (!commit.parents.isEmpty() && !readHistoryCommit(repo, graph, commit.parents.first(), &parent))
+            continue;
+
+        git_tree *oldTree{nullptr};
+        git_tree *newTree{nullptr};
+        git_diff *diff{nullptr};
+
+        // a tree diff compares ids only and skips identical subtrees, no blob is read here
+        BEGIN
+        if (!commit.parents.isEmpty())
+            STEP git_tree_lookup(&oldTree, repo, parent.tree.oidPtr());
+        STEP git_tree_lookup(&newTree, repo, commit.tree.oidPtr());
+        STEP git_diff_tree_to_tree(&diff, repo, oldTree, newTree, nullptr);
+        PRINT_ERROR;
+
+        PickaxeMatch match{id, {}};
+        const auto count = IS_OK ? git_diff_num_deltas(diff) : 0;
+        for (size_t i = 0; i < count; ++i) {
+            const auto delta = git_diff_get_delta(diff, i);
+            if (delta->old_file.mode == GIT_FILEMODE_COMMIT || delta->new_file.mode == GIT_FILEMODE_COMMIT)
+                continue;
+
+            const auto path = QString::fromUtf8(delta->new_file.path);
+            if (!options.path.isEmpty() && !path.contains(options.path))
+                continue;
+
+            const Oid oldBlob{delta->old_file.id};
+            const Oid newBlob{delta->new_file.id};
+
+            // like git, binary files are left out
+            if (options.mode == PickaxeOptions::Mode::Occurrences) {
+                const auto oldCount = occurrences(oldBlob);
+                const auto newCount = occurrences(newBlob);
+                if (oldCount != -1 && newCount != -1 && oldCount != newCount)
+                    match.paths << path;
+                continue;
+            }
+
+            const auto oldBlobPtr = oldBlob.isNull() ? QSharedPointer<Blob>{} : blobs->findByOid(oldBlob);
+            const auto newBlobPtr = newBlob.isNull() ? QSharedPointer<Blob>{} : blobs->findByOid(newBlob);
+            if ((oldBlobPtr && oldBlobPtr->isBinary()) || (newBlobPtr && newBlobPtr->isBinary()))
+                continue;
+
+            ChangedLineMatch lineMatch{&regex};
+            git_diff_blobs(oldBlobPtr ? oldBlobPtr->gitBlob() : nullptr,
+                           nullptr,
+                           newBlobPtr ? newBlobPtr->gitBlob() : nullptr,
+                           nullptr,
+                           &lineOptions,
+                           nullptr,
+                           nullptr,
+                           nullptr,
+                           &matchChangedLine,
+                           &lineMatch);
+            if (lineMatch.found)
+                match.paths << path;
+        }
+
+        git_diff_free(diff);
+        git_tree_free(newTree);
+        git_tree_free(oldTree);
+
+        if (!match.paths.isEmpty() && !callback(match))
+            return false;
+    }
+
+    return true;
+}
+
+}
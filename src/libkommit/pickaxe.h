@@ -0,0 +1,41 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "entities/oid.h"
+
+#include <QString>
+#include <QStringList>
+
+namespace Git
+{
+
+// What Manager::pickaxe() looks for in the diff of a commit to its first parent
+struct PickaxeOptions {
+    enum class Mode {
+        // a file has a different number of occurrences of text, like git log -S
+        Occurrences,
+        // an added or removed line matches text as a regular expression, like git log -G
+        ChangedLines,
+    };
+
+    QString text;
+    Mode mode{Mode::Occurrences};
+    // text is a regular expression in Occurrences mode as well, like --pickaxe-regex
+    bool regularExpression{false};
+    Qt::CaseSensitivity caseSensitivity{Qt::CaseSensitive};
+    // only files whose path contains this
+    QString path;
+};
+
+// A commit the pickaxe found, as plain values so matches can cross threads
+struct PickaxeMatch {
+    Oid commitId;
+    QStringList paths;
+};
+
+}
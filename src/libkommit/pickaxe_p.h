@@ -0,0 +1,32 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "pickaxe.h"
+
+#include <QList>
+
+#include <git2/types.h>
+
+#include <functional>
+
+namespace Git
+{
+
+class BlobsCache;
+class CommitGraph;
+
+// The search behind Manager::pickaxe(). Trees are diffed by id and only the blobs of changed files
+// are read, through blobs so neighbouring commits share them.
+bool commitsPickaxe(git_repository *repo,
+                    CommitGraph *graph,
+                    BlobsCache *blobs,
+                    const QList<Oid> &commits,
+                    const PickaxeOptions &options,
+                    const std::function<bool(const PickaxeMatch &)> &callback);
+
+}
@@ -0,0 +1,234 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "repositorywatcher.h"
+#include "entities/oid.h"
+#include "gitmanager.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+
+#include <git2/refs.h>
+#include <git2/repository.h>
+
+#include <algorithm>
+
+namespace Git
+{
+
+namespace
+{
+
+constexpr int checkDelay = 100;
+
+// git replaces these files through a lock file, so a new stamp means new content
+QString fileStamp(const QString &path)
+{
+    const QFileInfo info{path};
+    if (!info.exists())
+        return {};
+    return QStringLiteral("%1:%2").arg(info.lastModified().toMSecsSinceEpoch()).arg(info.size());
+}
+
+QString referenceTarget(git_reference *ref)
+{
+    if (git_reference_type(ref) == GIT_REFERENCE_SYMBOLIC)
+        return QString::fromUtf8(git_reference_symbolic_target(ref));
+    return Oid{git_reference_target(ref)}.toString();
+}
+
+}
+
+RepositoryWatcher::RepositoryWatcher(Manager *manager)
+    : QObject{manager}
+    , mManager{manager}
+{
+    mTimer.setSingleShot(true);
+    mTimer.setInterval(checkDelay);
+
+    connect(&mTimer, &QTimer::timeout, this, &RepositoryWatcher::check);
+    connect(&mWatcher, &QFileSystemWatcher::directoryChanged, this, &RepositoryWatcher::directoryChanged);
+
+    reset();
+}
+
+void RepositoryWatcher::reset()
+{
+    mTimer.stop();
+
+    const auto directories = mWatcher.directories();
+    if (!directories.isEmpty())
+        mWatcher.removePaths(directories);
+
+    mGitDir.clear();
+    mCommonDir.clear();
+    mRefsDirty = false;
+    mRefs.clear();
+    mHead.clear();
+    mIndex.clear();
+    mStash.clear();
+    mMergeHead.clear();
+    mPackedRefs.clear();
+
+    auto repo = mManager->repoPtr();
+    if (!repo)
+        return;
+
+    mGitDir = QDir::cleanPath(QString::fromUtf8(git_repository_path(repo)));
+    mCommonDir = QDir::cleanPath(QString::fromUtf8(git_repository_commondir(repo)));
+
+    mRefs = readRefs();
+    mHead = readHead();
+    mIndex = fileStamp(mGitDir + QStringLiteral("/index"));
+    mMergeHead = fileStamp(mGitDir + QStringLiteral("/MERGE_HEAD"));
+    mStash = fileStamp(mCommonDir + QStringLiteral("/logs/refs/stash"));
+    mPackedRefs = fileStamp(mCommonDir + QStringLiteral("/packed-refs"));
+
+    mWatcher.addPath(mGitDir);
+    if (mCommonDir != mGitDir)
+        mWatcher.addPath(mCommonDir);
+    if (QFileInfo::exists(mCommonDir + QStringLiteral("/logs/refs")))
+        mWatcher.addPath(mCommonDir + QStringLiteral("/logs/refs"));
+    watchRefDirectories(mCommonDir + QStringLiteral("/refs"));
+}
+
+void RepositoryWatcher::check()
+{
+    mTimer.stop();
+
+    if (mGitDir.isEmpty())
+        return;
+
+    const auto packedRefs = fileStamp(mCommonDir + QStringLiteral("/packed-refs"));
+    if (packedRefs != mPackedRefs) {
+        mPackedRefs = packedRefs;
+        mRefsDirty = true;
+    }
+
+    QStringList changedRefs;
+    if (mRefsDirty) {
+        mRefsDirty = false;
+
+        const auto refs = readRefs();
+        for (auto i = refs.constBegin(); i != refs.constEnd(); ++i) {
+            auto it = mRefs.constFind(i.key());
+            if (it == mRefs.constEnd() || *it != i.value())
+                changedRefs << i.key();
+        }
+        for (auto i = mRefs.constBegin(); i != mRefs.constEnd(); ++i)
+            if (!refs.contains(i.key()))
+                changedRefs << i.key();
+        mRefs = refs;
+
+        // branches like feature/x bring directories of their own
+        watchRefDirectories(mCommonDir + QStringLiteral("/refs"));
+    }
+
+    const auto head = readHead();
+    const auto index = fileStamp(mGitDir + QStringLiteral("/index"));
+    const auto mergeHead = fileStamp(mGitDir + QStringLiteral("/MERGE_HEAD"));
+    const auto stash = fileStamp(mCommonDir + QStringLiteral("/logs/refs/stash"));
+
+    // dropping a stash other than the newest one only rewrites the reflog
+    const auto stashDiffers = stash != mStash || changedRefs.contains(QStringLiteral("refs/stash"));
+    const auto headDiffers = head != mHead;
+    const auto indexDiffers = index != mIndex;
+    const auto mergeDiffers = mergeHead.isEmpty() != mMergeHead.isEmpty();
+
+    mHead = head;
+    mIndex = index;
+    mMergeHead = mergeHead;
+    mStash = stash;
+
+    if (!changedRefs.isEmpty()) {
+        changedRefs.sort();
+        Q_EMIT refsChanged(changedRefs);
+    }
+    if (headDiffers)
+        Q_EMIT headMoved();
+    if (indexDiffers)
+        Q_EMIT indexChanged();
+    if (stashDiffers)
+        Q_EMIT stashChanged();
+    if (mergeDiffers)
+        Q_EMIT mergeStateChanged();
+}
+
+bool RepositoryWatcher::containsRefsUnder(const QStringList &names, const QString &prefix)
+{
+    return std::any_of(names.cbegin(), names.cend(), [&prefix](const QString &name) {
+        return name.startsWith(prefix);
+    });
+}
+
+void RepositoryWatcher::directoryChanged(const QString &path)
+{
+    const auto refsPath = mCommonDir + QStringLiteral("/refs");
+    if (path == refsPath || path.startsWith(refsPath + QLatin1Char('/')))
+        mRefsDirty = true;
+
+    // the stash reflog directory only shows up with the first reflog
+    if (path == mCommonDir && QFileInfo::exists(mCommonDir + QStringLiteral("/logs/refs")))
+        mWatcher.addPath(mCommonDir + QStringLiteral("/logs/refs"));
+
+    mTimer.start();
+}
+
+void RepositoryWatcher::watchRefDirectories(const QString &path)
+{
+    QStringList directories{path};
+    QDirIterator it{path, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories};
+    while (it.hasNext())
+        directories << it.next();
+
+    const auto watched = mWatcher.directories();
+    directories.erase(std::remove_if(directories.begin(),
+                                     directories.end(),
+                                     [&watched](const QString &directory) {
+                                         return watched.contains(directory);
+                                     }),
+                      directories.end());
+    if (!directories.isEmpty())
+        mWatcher.addPaths(directories);
+}
+
+QHash<QString, QString> RepositoryWatcher::readRefs() const
+{
+    QHash<QString, QString> refs;
+
+    git_reference_iterator *iterator{nullptr};
+    if (git_reference_iterator_new(&iterator, mManager->repoPtr()))
+        return refs;
+
+    git_reference *ref{nullptr};
+    while (!git_reference_next(&ref, iterator)) {
+        refs.insert(QString::fromUtf8(git_reference_name(ref)), referenceTarget(ref));
+        git_reference_free(ref);
+    }
+    git_reference_iterator_free(iterator);
+
+    return refs;
+}
+
+QString RepositoryWatcher::readHead() const
+{
+    git_reference *head{nullptr};
+    if (git_reference_lookup(&head, mManager->repoPtr(), "HEAD"))
+        return {};
+
+    auto target = referenceTarget(head);
+    git_reference_free(head);
+
+    // the branch HEAD points to may move as well
+    git_oid oid;
+    if (!git_reference_name_to_id(&oid, mManager->repoPtr(), "HEAD"))
+        target += QLatin1Char(':') + Oid{&oid}.toString();
+    return target;
+}
+
+}
@@ -0,0 +1,79 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "libkommit_export.h"
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+namespace Git
+{
+
+class Manager;
+
+/**
+ * Tells what changed in the git dir, whoever changed it.
+ *
+ * Watches HEAD, the index, MERGE_HEAD, packed-refs, the refs/ tree and the stash reflog, and after
+ * a short delay compares them with the last known state. Every kind of change has a signal of its
+ * own, so caches and models only reload what is affected; the manager drops the matching caches
+ * before any other receiver is called. Lives in the thread of its manager.
+ */
+class LIBKOMMIT_EXPORT RepositoryWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RepositoryWatcher(Manager *manager);
+
+    // Starts over on the repository the manager has open now
+    void reset();
+    // Compares with the last known state right away instead of waiting for the timer
+    void check();
+
+    // Whether any of the full ref names starts with prefix (e.g. "refs/tags/")
+    Q_REQUIRED_RESULT static bool containsRefsUnder(const QStringList &names, const QString &prefix);
+
+Q_SIGNALS:
+    // Full names of the refs that were created, moved or deleted
+    void refsChanged(const QStringList &names);
+    // HEAD points to another branch or commit
+    void headMoved();
+    void indexChanged();
+    void stashChanged();
+    // A merge started or finished
+    void mergeStateChanged();
+
+private:
+    void directoryChanged(const QString &path);
+    void watchRefDirectories(const QString &path);
+    QHash<QString, QString> readRefs() const;
+    QString readHead() const;
+
+    Manager *const mManager;
+    QFileSystemWatcher mWatcher;
+    QTimer mTimer;
+    QString mGitDir;
+    // refs, packed-refs and logs are shared by all work trees of a repository
+    QString mCommonDir;
+    bool mRefsDirty{false};
+
+    // name to target, an oid or the name of another ref
+    QHash<QString, QString> mRefs;
+    QString mHead;
+    QString mIndex;
+    QString mStash;
+    QString mMergeHead;
+    QString mPackedRefs;
+};
+
+}
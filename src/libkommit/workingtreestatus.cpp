@@ -0,0 +1,236 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "workingtreestatus.h"
+#include "gitmanager.h"
+#include "repositorywatcher.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+#include <git2/index.h>
+#include <git2/repository.h>
+
+#include <utility>
+
+namespace Git
+{
+
+namespace
+{
+
+// inotify watches are a limited per-user resource, larger trees fall back to index changes and refresh()
+constexpr int maxWatchedDirectories = 8192;
+constexpr int updateDelay = 100;
+
+QString parentDirectory(const QString &path)
+{
+    auto index = path.lastIndexOf(QLatin1Char('/'));
+    return index == -1 ? QString{} : path.left(index);
+}
+
+}
+
+bool WorkingTreeStatus::Delta::isEmpty() const
+{
+    return added.isEmpty() && changed.isEmpty() && removed.isEmpty();
+}
+
+WorkingTreeStatus::WorkingTreeStatus(Manager *manager)
+    : QObject{manager}
+    , mManager{manager}
+{
+    mTimer.setSingleShot(true);
+    mTimer.setInterval(updateDelay);
+
+    connect(&mTimer, &QTimer::timeout, this, &WorkingTreeStatus::update);
+    connect(&mWatcher, &QFileSystemWatcher::directoryChanged, this, &WorkingTreeStatus::directoryChanged);
+    connect(manager->watcher(), &RepositoryWatcher::indexChanged, this, &WorkingTreeStatus::scheduleRefresh);
+    connect(manager->watcher(), &RepositoryWatcher::headMoved, this, &WorkingTreeStatus::scheduleRefresh);
+}
+
+const QMap<QString, ChangeStatus> &WorkingTreeStatus::files()
+{
+    if (!mLoaded)
+        load();
+    return mFiles;
+}
+
+void WorkingTreeStatus::update()
+{
+    mTimer.stop();
+
+    if (!mLoaded || mDirtyDirectories.isEmpty())
+        return;
+
+    // a directory is scanned with everything below it, so its dirty subdirectories are dropped
+    QStringList directories;
+    for (const auto &directory : std::as_const(mDirtyDirectories)) {
+        auto covered{false};
+        for (auto parent = directory; !parent.isEmpty() && !covered;) {
+            parent = parentDirectory(parent);
+            covered = mDirtyDirectories.contains(parent);
+        }
+        if (!covered)
+            directories << directory;
+    }
+    mDirtyDirectories.clear();
+
+    if (directories.contains(QString{})) {
+        refresh();
+        return;
+    }
+
+    apply(directories, mManager->changedFilesIn(directories));
+}
+
+void WorkingTreeStatus::refresh()
+{
+    if (!mLoaded) {
+        load();
+        return;
+    }
+
+    mTimer.stop();
+    mDirtyDirectories.clear();
+
+    apply({QString{}}, mManager->changedFiles());
+}
+
+void WorkingTreeStatus::reset()
+{
+    mTimer.stop();
+
+    const auto directories = mWatcher.directories();
+    if (!directories.isEmpty())
+        mWatcher.removePaths(directories);
+
+    mFiles.clear();
+    mDirtyDirectories.clear();
+    mWatchedDirectories.clear();
+    mWorkDir.clear();
+    mLoaded = false;
+}
+
+void WorkingTreeStatus::load()
+{
+    reset();
+    mLoaded = true;
+
+    auto repo = mManager->repoPtr();
+    if (!repo || git_repository_is_bare(repo))
+        return;
+
+    mWorkDir = QDir::cleanPath(QString::fromUtf8(git_repository_workdir(repo)));
+    mFiles = mManager->changedFiles();
+
+    watchDirectory(QString{});
+
+    git_index *index{nullptr};
+    if (!git_repository_index(&index, repo)) {
+        // entries are sorted by path, so consecutive entries mostly share their directory
+        QString lastDirectory;
+        const auto count = git_index_entrycount(index);
+        for (size_t i = 0; i < count && mWatchedDirectories.size() < maxWatchedDirectories; ++i) {
+            auto directory = parentDirectory(QString::fromUtf8(git_index_get_byindex(index, i)->path));
+            if (directory != lastDirectory) {
+                watchDirectory(directory);
+                lastDirectory = directory;
+            }
+        }
+        git_index_free(index);
+    }
+
+    watchDirectoriesOf(mFiles.keys());
+}
+
+void WorkingTreeStatus::apply(const QStringList &directories, const QMap<QString, ChangeStatus> &files)
+{
+    Delta delta;
+
+    for (const auto &directory : directories) {
+        const auto prefix = directory.isEmpty() ? QString{} : directory + QLatin1Char('/');
+        for (auto it = mFiles.lowerBound(prefix); it != mFiles.end() && it.key().startsWith(prefix); ++it)
+            if (!files.contains(it.key()))
+                delta.removed << it.key();
+    }
+
+    for (auto i = files.constBegin(); i != files.constEnd(); ++i) {
+        auto it = mFiles.constFind(i.key());
+        if (it == mFiles.constEnd())
+            delta.added.insert(i.key(), i.value());
+        else if (*it != i.value())
+            delta.changed.insert(i.key(), i.value());
+    }
+
+    if (delta.isEmpty())
+        return;
+
+    for (const auto &file : std::as_const(delta.removed))
+        mFiles.remove(file);
+    for (auto i = delta.added.constBegin(); i != delta.added.constEnd(); ++i)
+        mFiles.insert(i.key(), i.value());
+    for (auto i = delta.changed.constBegin(); i != delta.changed.constEnd(); ++i)
+        mFiles.insert(i.key(), i.value());
+
+    watchDirectoriesOf(delta.added.keys());
+
+    Q_EMIT changed(delta);
+}
+
+void WorkingTreeStatus::watchDirectoriesOf(const QStringList &files)
+{
+    for (const auto &file : files) {
+        // untracked or ignored directories that were not recursed into are listed with a trailing slash
+        if (mFiles.value(file) == ChangeStatus::Ignored)
+            continue;
+        watchDirectory(parentDirectory(file));
+    }
+}
+
+void WorkingTreeStatus::watchDirectory(const QString &directory)
+{
+    // parents are added first, so the walk stops at the first directory already known
+    QStringList missing;
+    for (auto path = directory; !mWatchedDirectories.contains(path); path = parentDirectory(path)) {
+        missing.prepend(path);
+        if (path.isEmpty())
+            break;
+    }
+
+    for (const auto &path : std::as_const(missing)) {
+        if (mWatchedDirectories.size() >= maxWatchedDirectories)
+            return;
+        mWatchedDirectories.insert(path);
+        mWatcher.addPath(path.isEmpty() ? mWorkDir : mWorkDir + QLatin1Char('/') + path);
+    }
+}
+
+void WorkingTreeStatus::directoryChanged(const QString &path)
+{
+    if (path != mWorkDir && !path.startsWith(mWorkDir + QLatin1Char('/')))
+        return;
+
+    const auto directory = path == mWorkDir ? QString{} : path.mid(mWorkDir.size() + 1);
+
+    // the watcher drops removed directories by itself; their parent reports the removal
+    if (!QFileInfo::exists(path))
+        mWatchedDirectories.remove(directory);
+
+    mDirtyDirectories.insert(directory);
+    mTimer.start();
+}
+
+void WorkingTreeStatus::scheduleRefresh()
+{
+    if (!mLoaded)
+        return;
+
+    mDirtyDirectories.insert(QString{});
+    mTimer.start();
+}
+
+}
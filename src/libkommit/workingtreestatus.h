@@ -0,0 +1,86 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "libkommit_export.h"
+#include "types.h"
+
+#include <QFileSystemWatcher>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+namespace Git
+{
+
+class Manager;
+
+/**
+ * The status of the work tree, kept up to date as files change.
+ *
+ * The first call to files() runs a full status; after that the directories of the work tree
+ * are watched and only directories that saw a change are scanned again. A change of the index or
+ * HEAD (staging, checkout, commit), as reported by the manager's RepositoryWatcher, rescans
+ * everything. The difference to the previous result is published through changed().
+ *
+ * Directory watches report files being created, removed or renamed; most editors save that way,
+ * but a file written in place is only picked up by the next refresh(). Views that are opened or
+ * actions that act on the whole status call refresh(), the watches keep them current after that.
+ * Lives in the thread of its manager.
+ */
+class LIBKOMMIT_EXPORT WorkingTreeStatus : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Delta {
+        QMap<QString, ChangeStatus> added;
+        QMap<QString, ChangeStatus> changed;
+        QStringList removed;
+
+        Q_REQUIRED_RESULT bool isEmpty() const;
+    };
+
+    explicit WorkingTreeStatus(Manager *manager);
+
+    // Same as Manager::changedFiles() as of the last update
+    Q_REQUIRED_RESULT const QMap<QString, ChangeStatus> &files();
+
+    // Rescans the directories changed since the last update without waiting for the timer,
+    // files written in place are missed
+    void update();
+    // Rescans the whole work tree
+    void refresh();
+    // Drops the result and all watches, the next files() call scans again
+    void reset();
+
+Q_SIGNALS:
+    void changed(const Git::WorkingTreeStatus::Delta &delta);
+
+private:
+    void load();
+    void apply(const QStringList &directories, const QMap<QString, ChangeStatus> &files);
+    void watchDirectoriesOf(const QStringList &files);
+    void watchDirectory(const QString &directory);
+    void directoryChanged(const QString &path);
+    void scheduleRefresh();
+
+    Manager *const mManager;
+    QFileSystemWatcher mWatcher;
+    QTimer mTimer;
+    QMap<QString, ChangeStatus> mFiles;
+    QSet<QString> mDirtyDirectories;
+    QString mWorkDir;
+    // relative to the work tree, "" is the root
+    QSet<QString> mWatchedDirectories;
+    bool mLoaded{false};
+};
+
+}
@@ -16,6 +16,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "gitmanager.h"
 #include "models/stashesmodel.h"
 #include "windows/diffwindow.h"
+#include "workingtreestatus.h"
 #include <entities/commit.h>
 
 StashActions::StashActions(Git::Manager *git, QWidget *parent)
@@ -67,7 +68,9 @@ void StashActions::diff()
 
 void StashActions::create()
 {
-    if (mGit->changedFiles().empty()) {
+    auto status = mGit->workingTreeStatus();
+    status->refresh();
+    if (status->files().empty()) {
         KMessageBoxHelper::information(mParent, i18n("You don't have any changes!"), i18nc("@title:window", "Stash"));
         return;
     }
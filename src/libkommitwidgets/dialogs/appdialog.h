@@ -27,6 +27,10 @@ public:
     bool event(QEvent *event) override;
 
 protected:
+    // results of background jobs are handed to the dialog in batches, so the event loop is not flooded
+    static constexpr int batchSize{100};
+    static constexpr qint64 batchInterval{50};
+
     Git::Manager *const mGit;
 
     template<typename _Enum>
@@ -11,6 +11,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "core/kmessageboxhelper.h"
 #include "gitmanager.h"
 #include "models/changedfilesmodel.h"
+#include "workingtreestatus.h"
 
 #include <KLocalizedString>
 #include <KSharedConfig>
@@ -30,10 +31,10 @@ ChangedFilesDialog::ChangedFilesDialog(Git::Manager *git, QWidget *parent)
 {
     setupUi(this);
 
-    connect(mActions, &ChangedFileActions::reloadNeeded, mModel, &ChangedFilesModel::reload);
+    connect(mActions, &ChangedFileActions::reloadNeeded, mModel, &ChangedFilesModel::refresh);
 
     connect(pushButtonCommitPush, &QPushButton::clicked, this, &ChangedFilesDialog::slotPushCommit);
-    connect(pushButtonReload, &QPushButton::clicked, mModel, &ChangedFilesModel::reload);
+    connect(pushButtonReload, &QPushButton::clicked, mModel, &ChangedFilesModel::refresh);
     connect(pushButtonStashChanges, &QPushButton::clicked, this, &ChangedFilesDialog::slotStash);
     connect(listView, &QListView::doubleClicked, this, &ChangedFilesDialog::slotItemDoubleClicked);
     connect(listView, &QListView::customContextMenuRequested, this, &ChangedFilesDialog::slotCustomContextMenuRequested);
@@ -57,7 +58,9 @@ void ChangedFilesDialog::slotPushCommit()
 
 void ChangedFilesDialog::slotStash()
 {
-    if (mGit->changedFiles().empty()) {
+    auto status = mGit->workingTreeStatus();
+    status->refresh();
+    if (status->files().empty()) {
         KMessageBoxHelper::information(this, i18n("You don't have any changes!"), i18nc("@title:window", "Stash"));
         return;
     }
@@ -54,7 +54,7 @@ CommitPushDialog::CommitPushDialog(Git::Manager *git, QWidget *parent)
     connect(mModel, &ChangedFilesModel::checkedCountChanged, this, &CommitPushDialog::checkButtonsEnable);
     connect(textEditMessage, &QTextEdit::textChanged, this, &CommitPushDialog::checkButtonsEnable);
     connect(checkBoxAmend, &QCheckBox::toggled, this, &CommitPushDialog::checkButtonsEnable);
-    connect(mActions, &ChangedFileActions::reloadNeeded, mModel, &ChangedFilesModel::reload);
+    connect(mActions, &ChangedFileActions::reloadNeeded, mModel, &ChangedFilesModel::refresh);
 
     listView->setModel(mModel);
     mModel->reload();
@@ -205,13 +205,20 @@ void CommitPushDialog::slotPushButtonPushClicked()
 void CommitPushDialog::addFiles()
 {
     auto index = mGit->index();
+    if (!index || !index->begin())
+        return;
+
+    QStringList added;
+    QStringList removed;
     for (const auto &file : mModel->data()) {
         if (file.status == Git::ChangeStatus::Removed)
-            Q_UNUSED(index->removeByPath(file.filePath))
+            removed << file.filePath;
         else
-            Q_UNUSED(index->addByPath(file.filePath))
+            added << file.filePath;
     }
-    index->write();
+    Q_UNUSED(index->removePaths(removed))
+    Q_UNUSED(index->addPaths(added))
+    index->commit();
 }
 
 void CommitPushDialog::slotToolButtonAddAllClicked()
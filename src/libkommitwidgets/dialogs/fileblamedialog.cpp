@@ -6,11 +6,16 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "fileblamedialog.h"
 
+#include "blamedata.h"
+#include "filehistorydialog.h"
 #include "gitmanager.h"
+#include "linehistory.h"
 #include "models/commitsmodel.h"
 
 #include <KLocalizedString>
-#include <QThread>
+#include <QCursor>
+#include <QElapsedTimer>
+#include <QMenu>
 
 FileBlameDialog::FileBlameDialog(Git::Manager *git, QSharedPointer<Git::File> file, QWidget *parent)
     : AppDialog(git, parent)
@@ -23,20 +28,76 @@ FileBlameDialog::FileBlameDialog(Git::Manager *git, QSharedPointer<Git::File> fi
 
     connect(plainTextEdit, &BlameCodeView::blockSelected, this, &FileBlameDialog::slotPlainTextEditBlockSelected);
 
-    // if (git->commitsCache()->isLoaded())
+    plainTextEdit->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(plainTextEdit, &BlameCodeView::customContextMenuRequested, this, &FileBlameDialog::slotPlainTextEditCustomContextMenuRequested);
+
     loadData();
-    // else
-    //     connect(mGit->logsModel(), &Git::LogsModel::loaded, this, &FileBlameDialog::loadData);
+}
+
+FileBlameDialog::~FileBlameDialog()
+{
+    mBlameCanceled = true;
+    mBlameLoader.waitForFinished();
 }
 
 void FileBlameDialog::loadData()
 {
     plainTextEdit->setHighlighting(mFile->fileName());
 
-    const auto b = mGit->blame(mFile);
-    plainTextEdit->setBlameData(b);
+    // the text shows up right away, the blame of each line as soon as it is known
+    mLines = mFile->content().split(QLatin1Char('\n'));
+    plainTextEdit->setContent(mLines);
 
     setWindowTitle(i18nc("@title:window", "Blame file: %1", mFile->fileName()));
+
+    Git::BlameOptions options;
+    if (!mFile->place().isEmpty())
+        options.revision = mFile->place();
+    const auto fileName = mFile->fileName();
+
+    mBlameLoader = mGit->runAsync([this, options, fileName](Git::Manager *manager) {
+        QList<Git::BlameHunk> batch;
+        QElapsedTimer timer;
+        timer.start();
+
+        const auto flush = [this, &batch, &timer]() {
+            if (!batch.isEmpty())
+                QMetaObject::invokeMethod(
+                    this,
+                    [this, batch]() {
+                        addHunks(batch);
+                    },
+                    Qt::QueuedConnection);
+            batch.clear();
+            timer.restart();
+        };
+
+        manager->blame(
+            fileName,
+            [this, &batch, &timer, &flush](const Git::BlameHunk &hunk) {
+                if (mBlameCanceled)
+                    return false;
+
+                batch << hunk;
+                if (batch.size() >= batchSize || timer.elapsed() >= batchInterval)
+                    flush();
+                return true;
+            },
+            options);
+
+        flush();
+    });
+}
+
+void FileBlameDialog::addHunks(const QList<Git::BlameHunk> &hunks)
+{
+    // commits are looked up here, the worker's ones belong to its own handle
+    Git::BlameData rows;
+    rows.reserve(hunks.size());
+    for (const auto &hunk : hunks)
+        rows.append(mGit->blameDataRow(hunk, mLines));
+
+    plainTextEdit->addBlameData(rows);
 }
 
 void FileBlameDialog::slotPlainTextEditBlockSelected()
@@ -45,4 +106,25 @@ void FileBlameDialog::slotPlainTextEditBlockSelected()
     widgetCommitDetails->setCommit(data ? static_cast<Git::Commit *>(data->data) : nullptr);
 }
 
+void FileBlameDialog::slotPlainTextEditCustomContextMenuRequested()
+{
+    QScopedPointer<QMenu> menu{plainTextEdit->createStandardContextMenu()};
+    menu->addSeparator();
+    menu->addAction(i18n("Show History of Selected Lines"), this, &FileBlameDialog::showSelectedLinesHistory);
+    menu->exec(QCursor::pos());
+}
+
+void FileBlameDialog::showSelectedLinesHistory()
+{
+    const auto cursor = plainTextEdit->textCursor();
+    const auto document = plainTextEdit->document();
+    const auto first = document->findBlock(cursor.selectionStart()).blockNumber();
+    const auto last = document->findBlock(cursor.selectionEnd()).blockNumber();
+
+    // the line numbers are those of the blamed version, not of HEAD
+    const auto revision = mFile->place().isEmpty() ? QStringLiteral("HEAD") : mFile->place();
+    FileHistoryDialog d(mGit, mFile->fileName(), {Git::LineRange{first + 1, last - first + 1}}, revision, this);
+    d.exec();
+}
+
 #include "moc_fileblamedialog.cpp"
@@ -11,9 +11,14 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "libkommitwidgets_export.h"
 #include "ui_fileblamedialog.h"
 
+#include <QFuture>
+
+#include <atomic>
+
 namespace Git
 {
 class Manager;
+struct BlameHunk;
 }
 
 class LIBKOMMITWIDGETS_EXPORT FileBlameDialog : public AppDialog, private Ui::FileBlameDialog
@@ -22,12 +27,20 @@ class LIBKOMMITWIDGETS_EXPORT FileBlameDialog : public AppDialog, private Ui::Fi
 
 public:
     explicit FileBlameDialog(Git::Manager *git, QSharedPointer<Git::File> file, QWidget *parent = nullptr);
+    ~FileBlameDialog() override;
 
 private:
     LIBKOMMITWIDGETS_NO_EXPORT void loadData();
+    LIBKOMMITWIDGETS_NO_EXPORT void addHunks(const QList<Git::BlameHunk> &hunks);
 
     LIBKOMMITWIDGETS_NO_EXPORT void slotPlainTextEditBlockSelected();
+    LIBKOMMITWIDGETS_NO_EXPORT void slotPlainTextEditCustomContextMenuRequested();
+    LIBKOMMITWIDGETS_NO_EXPORT void showSelectedLinesHistory();
 
     QString mFileName;
     QSharedPointer<Git::File> const mFile;
+    QStringList mLines;
+
+    QFuture<void> mBlameLoader;
+    std::atomic_bool mBlameCanceled{false};
 };
@@ -9,36 +9,34 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <caches/commitscache.h>
 #include <entities/commit.h>
+#include <entities/oid.h>
 #include <gitmanager.h>
 
 #include <KLocalizedString>
+#include <QElapsedTimer>
 
 FileHistoryDialog::FileHistoryDialog(Git::Manager *git, const QString &fileName, QWidget *parent)
+    : FileHistoryDialog(git, fileName, QList<Git::LineRange>{}, QStringLiteral("HEAD"), parent)
+{
+}
+
+FileHistoryDialog::FileHistoryDialog(Git::Manager *git,
+                                     const QString &fileName,
+                                     const QList<Git::LineRange> &lines,
+                                     const QString &revision,
+                                     QWidget *parent)
     : AppDialog(git, parent)
     , mFileName(fileName)
+    , mLines(lines)
+    , mRevision(revision)
 {
     setupUi(this);
 
-    const auto hashes = git->fileLog(fileName);
-
-    const auto logs = git->commits();
-
-    for (const auto &hash : hashes) {
-        auto log = logs->find(hash);
-        if (!log)
-            continue;
-
-        auto item = new QListWidgetItem(log->message());
-        item->setData(dataRole, log->commitHash());
-        listWidget->addItem(item);
-
-        auto treeItem = new QTreeWidgetItem{treeWidget};
-        treeItem->setText(0, log->message());
-        treeItem->setData(0, dataRole, log->commitHash());
-        treeWidget->addTopLevelItem(treeItem);
-    }
     plainTextEdit->setHighlighting(fileName);
-    setWindowTitle(i18nc("@title:window", "File log: %1", fileName));
+    if (lines.isEmpty())
+        setWindowTitle(i18nc("@title:window", "File log: %1", fileName));
+    else
+        setWindowTitle(i18nc("@title:window", "Line log: %1, lines %2-%3", fileName, lines.first().start, lines.last().start + lines.last().count - 1));
 
     connect(listWidget, &QListWidget::currentItemChanged, this, &FileHistoryDialog::slotListWidgetItemClicked);
     connect(treeWidget, &QTreeWidget::itemClicked, this, &FileHistoryDialog::slotTreeViewItemClicked);
@@ -51,6 +49,8 @@ FileHistoryDialog::FileHistoryDialog(Git::Manager *git, const QString &fileName,
     treeWidget->header()->setSectionResizeMode(2, QHeaderView::Fixed);
     treeWidget->header()->setStretchLastSection(false);
     radioButtonRegularView->setChecked(true);
+
+    loadHistory();
 }
 
 FileHistoryDialog::FileHistoryDialog(Git::Manager *git, QSharedPointer<Git::File> file, QWidget *parent)
@@ -58,10 +58,97 @@ FileHistoryDialog::FileHistoryDialog(Git::Manager *git, QSharedPointer<Git::File
 {
 }
 
+FileHistoryDialog::~FileHistoryDialog()
+{
+    mHistoryCanceled = true;
+    mHistoryLoader.waitForFinished();
+}
+
+void FileHistoryDialog::loadHistory()
+{
+    // entries are sent to the dialog in small batches so the first commits show up before the
+    // whole history is walked
+    mHistoryLoader = mGit->runAsync([this](Git::Manager *manager) {
+        QList<HistoryEntry> batch;
+        QElapsedTimer timer;
+        timer.start();
+
+        const auto flush = [this, &batch, &timer]() {
+            if (!batch.isEmpty())
+                QMetaObject::invokeMethod(
+                    this,
+                    [this, batch]() {
+                        addEntries(batch);
+                    },
+                    Qt::QueuedConnection);
+            batch.clear();
+            timer.restart();
+        };
+
+        const auto add = [this, &batch, &timer, &flush](const HistoryEntry &entry) {
+            if (mHistoryCanceled)
+                return false;
+
+            batch << entry;
+            if (batch.size() >= batchSize || timer.elapsed() >= batchInterval)
+                flush();
+            return true;
+        };
+
+        if (mLines.isEmpty())
+            manager->fileLog(
+                mFileName,
+                [&add](const Git::Oid &commit, const QString &path) {
+                    return add(HistoryEntry{commit, path, 0});
+                },
+                true);
+        else
+            manager->lineHistory(
+                mFileName,
+                mLines,
+                [&add](const Git::LineHistoryEntry &entry) {
+                    return add(HistoryEntry{entry.commitId, entry.path, entry.ranges.isEmpty() ? 0 : entry.ranges.first().start});
+                },
+                mRevision);
+
+        flush();
+    });
+}
+
+void FileHistoryDialog::addEntries(const QList<HistoryEntry> &entries)
+{
+    const auto commits = mGit->commits();
+
+    for (const auto &entry : entries) {
+        auto log = commits->findByOid(entry.commit);
+        if (!log)
+            continue;
+
+        auto item = new QListWidgetItem(log->subject());
+        item->setData(dataRole, log->commitHash());
+        item->setData(pathRole, entry.path);
+        item->setData(lineRole, entry.line);
+        listWidget->addItem(item);
+
+        auto treeItem = new QTreeWidgetItem{treeWidget};
+        treeItem->setText(0, log->subject());
+        treeItem->setData(0, dataRole, log->commitHash());
+        treeItem->setData(0, pathRole, entry.path);
+        treeWidget->addTopLevelItem(treeItem);
+    }
+}
+
 void FileHistoryDialog::slotListWidgetItemClicked(QListWidgetItem *item)
 {
-    const auto content = mGit->fileContent(item->data(dataRole).toString(), mFileName);
+    if (!item)
+        return;
+
+    const auto content = mGit->fileContent(item->data(dataRole).toString(), item->data(pathRole).toString());
     plainTextEdit->setPlainText(content);
+
+    // the followed lines may have moved in that version
+    if (const auto line = item->data(lineRole).toInt())
+        plainTextEdit->gotoLineNumber(line - 1);
 }
 
 void FileHistoryDialog::slotRadioButtonRegularViewToggled(bool toggle)
@@ -85,8 +172,8 @@ void FileHistoryDialog::compareFiles()
     if (!mLeftFile || !mRightFile)
         return;
 
-    widgetDiffView->setOldFile(QSharedPointer<Git::File>{new Git::File{mGit, mLeftFile->data(0, dataRole).toString(), mFileName}});
-    widgetDiffView->setNewFile(QSharedPointer<Git::File>{new Git::File{mGit, mRightFile->data(0, dataRole).toString(), mFileName}});
+    widgetDiffView->setOldFile(QSharedPointer<Git::File>{new Git::File{mGit, mLeftFile->data(0, dataRole).toString(), mLeftFile->data(0, pathRole).toString()}});
+    widgetDiffView->setNewFile(QSharedPointer<Git::File>{new Git::File{mGit, mRightFile->data(0, dataRole).toString(), mRightFile->data(0, pathRole).toString()}});
     widgetDiffView->compare();
 }
 
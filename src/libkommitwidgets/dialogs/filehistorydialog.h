@@ -7,9 +7,15 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
 
 #include "appdialog.h"
+#include "entities/oid.h"
 #include "libkommitwidgets_export.h"
+#include "linehistory.h"
 #include "ui_filehistorydialog.h"
 
+#include <QFuture>
+
+#include <atomic>
+
 namespace Git
 {
 class Manager;
@@ -23,9 +29,25 @@ class LIBKOMMITWIDGETS_EXPORT FileHistoryDialog : public AppDialog, private Ui::
 public:
     explicit FileHistoryDialog(Git::Manager *git, const QString &fileName, QWidget *parent = nullptr);
     explicit FileHistoryDialog(Git::Manager *git, QSharedPointer<Git::File> file, QWidget *parent = nullptr);
+    // History of some lines of the file only, like git log -L; lines are those of the file at revision
+    FileHistoryDialog(Git::Manager *git, const QString &fileName, const QList<Git::LineRange> &lines, const QString &revision, QWidget *parent = nullptr);
+    ~FileHistoryDialog() override;
 
 private:
     static constexpr int dataRole{Qt::UserRole + 1};
+    // name of the file in that commit, differs from mFileName before a rename
+    static constexpr int pathRole{Qt::UserRole + 2};
+    // first followed line in that commit's version of the file
+    static constexpr int lineRole{Qt::UserRole + 3};
+
+    struct HistoryEntry {
+        Git::Oid commit;
+        QString path;
+        int line{0};
+    };
+
+    LIBKOMMITWIDGETS_NO_EXPORT void loadHistory();
+    LIBKOMMITWIDGETS_NO_EXPORT void addEntries(const QList<HistoryEntry> &entries);
 
     LIBKOMMITWIDGETS_NO_EXPORT void slotListWidgetItemClicked(QListWidgetItem *item);
     LIBKOMMITWIDGETS_NO_EXPORT void slotTreeViewItemClicked(QTreeWidgetItem *item, int column);
@@ -34,6 +56,11 @@ private:
     LIBKOMMITWIDGETS_NO_EXPORT void compareFiles();
 
     const QString mFileName;
+    const QList<Git::LineRange> mLines;
+    const QString mRevision;
     QTreeWidgetItem *mLeftFile{nullptr};
     QTreeWidgetItem *mRightFile{nullptr};
+
+    QFuture<void> mHistoryLoader;
+    std::atomic_bool mHistoryCanceled{false};
 };
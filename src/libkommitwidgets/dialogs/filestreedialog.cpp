@@ -8,7 +8,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "actions/fileactions.h"
 #include "core/kmessageboxhelper.h"
 #include "gitmanager.h"
-#include "models/treemodel.h"
+#include "models/treedirectoriesmodel.h"
 
 #include <entities/tree.h>
 
@@ -16,67 +16,28 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include <QFileDialog>
 #include <QFileIconProvider>
 #include <QMenu>
+#include <QProgressDialog>
 #include <interfaces.h>
 
 FilesTreeDialog::FilesTreeDialog(Git::Manager *git, const QString &place, QWidget *parent)
     : AppDialog(git, parent)
-    , mTreeModel(new TreeModel(this))
+    , mTreeModel(new TreeDirectoriesModel(this))
     , mPlace(place)
     , mActions(new FileActions(git, this))
+    , mTree{git->tree(place)}
     , mTreeViewMenu{new QMenu{this}}
 {
     setupUi(this);
 
-    // mActions->setPlace(place);
-
-    mTreeModel->setSeparator(QStringLiteral("/"));
-
-    const auto files = git->ls(place);
-
-    mTreeModel->setShowRoot(true);
-    mTreeModel->setLastPartAsData(true);
-    QFileIconProvider p;
-    mTreeModel->setDefaultIcon(p.icon(QFileIconProvider::Folder));
-    mTreeModel->addData(files);
-    treeView->setModel(mTreeModel);
-
     setWindowTitle(i18nc("@title:window", "Browse files: %1", place));
-
     lineEditBranchName->setText(place);
 
-    listWidget->clear();
-
-    const auto rootData = mTreeModel->rootData();
-    for (const auto &f : rootData) {
-        const QFileInfo fi(f);
-        const auto icon = p.icon(fi);
-        auto item = new QListWidgetItem(listWidget);
-        item->setText(f);
-        item->setIcon(icon);
-        listWidget->addItem(item);
-    }
-
-    connect(treeView, &QTreeView::clicked, this, &FilesTreeDialog::slotTreeViewClicked);
-    connect(listWidget, &QListWidget::customContextMenuRequested, this, &FilesTreeDialog::slotListWidgetCustomContextMenuRequested);
+    initModel();
 }
 
-// FilesTreeDialog::FilesTreeDialog(Git::Manager *git, QSharedPointer<Git::Tree> tree, QWidget *parent)
-//     : AppDialog(nullptr, parent)
-//     , mTreeModel(new TreeModel(this))
-//     , mPlace{}
-//     , mActions(new FileActions(git, this))
-//     , mTree{tree}
-// {
-//     setupUi(this);
-
-//     auto files = tree->entries(Git::Tree::EntryType::File);
-
-//     initModel(files);
-// }
-
 FilesTreeDialog::FilesTreeDialog(Git::Manager *git, QSharedPointer<Git::ITree> tree, QWidget *parent)
     : AppDialog(nullptr, parent)
-    , mTreeModel(new TreeModel(this))
+    , mTreeModel(new TreeDirectoriesModel(this))
     , mPlace{}
     , mActions(new FileActions(git, this))
     , mTree{tree->tree()}
@@ -84,34 +45,22 @@ FilesTreeDialog::FilesTreeDialog(Git::Manager *git, QSharedPointer<Git::ITree> t
 {
     setupUi(this);
 
-    auto files = tree->tree()->entries(Git::Tree::EntryType::File);
     lineEditBranchName->setText(tree->treeTitle());
     setWindowTitle(i18nc("@title:window", "Browse files: %1", tree->treeTitle()));
 
-    initModel(files);
+    initModel();
 }
 
 void FilesTreeDialog::slotTreeViewCustomContextMenuRequested(const QPoint &pos)
 {
-    mExtractPrefix = mTreeModel->fullPath(treeView->currentIndex());
+    mExtractPrefix = mTreeModel->path(treeView->currentIndex());
 
     mTreeViewMenu->popup(treeView->mapToGlobal(pos));
 }
 
 void FilesTreeDialog::slotTreeViewClicked(const QModelIndex &index)
 {
-    QFileIconProvider p;
-    listWidget->clear();
-
-    const auto d = mTreeModel->data(index);
-    for (const auto &f : d) {
-        const QFileInfo fi(f);
-        const auto icon = p.icon(fi);
-        auto item = new QListWidgetItem(listWidget);
-        item->setText(f);
-        item->setIcon(icon);
-        listWidget->addItem(item);
-    }
+    showFiles(mTreeModel->path(index));
 }
 
 void FilesTreeDialog::slotExtract()
@@ -119,7 +68,22 @@ void FilesTreeDialog::slotExtract()
     auto path = QFileDialog::getExistingDirectory(this, i18n("Extract to"));
     if (path.isEmpty())
         return;
-    auto ok = mTree->extract(path, mExtractPrefix);
+
+    QProgressDialog progressDialog(this);
+    progressDialog.setWindowTitle(i18nc("@title:window", "Extracting files"));
+    progressDialog.setLabelText(i18n("Please wait while the files are being extracted…"));
+    progressDialog.setMinimumDuration(500);
+    progressDialog.setModal(true);
+
+    Git::Tree::ExtractOptions options;
+    options.progress = [&progressDialog](int written, int total) {
+        progressDialog.setMaximum(total);
+        progressDialog.setValue(written);
+        return !progressDialog.wasCanceled();
+    };
+    auto ok = mTree->extract(path, mExtractPrefix, options);
+    if (progressDialog.wasCanceled())
+        return;
 
     if (ok)
         KMessageBoxHelper::information(this, i18n("All file(s) extracted successfully"));
@@ -127,24 +91,14 @@ void FilesTreeDialog::slotExtract()
         KMessageBoxHelper::error(this, i18n("An error occurred while extracting file(s)"));
 }
 
-void FilesTreeDialog::initModel(const QStringList &files)
+void FilesTreeDialog::initModel()
 {
-    mTreeModel->setShowRoot(true);
-    mTreeModel->setLastPartAsData(true);
-    QFileIconProvider p;
-    mTreeModel->setDefaultIcon(p.icon(QFileIconProvider::Folder));
-    mTreeModel->addData(files);
+    // directories are read as they are expanded, the files of one when it is clicked
+    mTreeModel->setTree(mTree);
     treeView->setModel(mTreeModel);
-
-    const auto rootData = mTreeModel->rootData();
-    for (const auto &f : rootData) {
-        const QFileInfo fi(f);
-        const auto icon = p.icon(fi);
-        auto item = new QListWidgetItem(listWidget);
-        item->setText(f);
-        item->setIcon(icon);
-        listWidget->addItem(item);
-    }
+    treeView->expand(mTreeModel->rootIndex());
+    treeView->setCurrentIndex(mTreeModel->rootIndex());
+    showFiles(QString{});
 
     connect(treeView, &QTreeView::clicked, this, &FilesTreeDialog::slotTreeViewClicked);
     connect(listWidget, &QListWidget::customContextMenuRequested, this, &FilesTreeDialog::slotListWidgetCustomContextMenuRequested);
@@ -154,16 +108,31 @@ void FilesTreeDialog::initModel(const QStringList &files)
     connect(extractAction, &QAction::triggered, this, &FilesTreeDialog::slotExtract);
 }
 
-void FilesTreeDialog::slotListWidgetCustomContextMenuRequested(const QPoint &pos)
+void FilesTreeDialog::showFiles(const QString &path)
 {
-    auto path = mTreeModel->fullPath(treeView->currentIndex());
+    listWidget->clear();
+    if (!mTree)
+        return;
 
-    if (path == QLatin1Char('/'))
-        path = listWidget->currentItem()->text();
-    else
-        path += QLatin1Char('/') + listWidget->currentItem()->text();
+    QFileIconProvider p;
+    const auto files = mTree->entries(path, Git::Tree::EntryType::File);
+    for (const auto &f : files) {
+        const QFileInfo fi(f);
+        auto item = new QListWidgetItem(listWidget);
+        item->setText(f);
+        item->setIcon(p.icon(fi));
+        listWidget->addItem(item);
+    }
+}
+
+void FilesTreeDialog::slotListWidgetCustomContextMenuRequested(const QPoint &pos)
+{
+    if (!listWidget->currentItem())
+        return;
 
-    auto file = mTree->file(path);
+    const auto directory = mTreeModel->path(treeView->currentIndex());
+    const auto name = listWidget->currentItem()->text();
+    auto file = mTree->file(directory.isEmpty() ? name : directory + QLatin1Char('/') + name);
 
     mActions->setFile(file);
     mActions->popup(listWidget->mapToGlobal(pos));
@@ -18,7 +18,7 @@ class ITree;
 };
 
 class FileActions;
-class TreeModel;
+class TreeDirectoriesModel;
 class LIBKOMMITWIDGETS_EXPORT FilesTreeDialog : public AppDialog, private Ui::FilesTreeDialog
 {
     Q_OBJECT
@@ -33,9 +33,10 @@ private:
     LIBKOMMITWIDGETS_NO_EXPORT void slotListWidgetCustomContextMenuRequested(const QPoint &pos);
     LIBKOMMITWIDGETS_NO_EXPORT void slotTreeViewClicked(const QModelIndex &index);
     LIBKOMMITWIDGETS_NO_EXPORT void slotExtract();
-    LIBKOMMITWIDGETS_NO_EXPORT void initModel(const QStringList &files);
+    LIBKOMMITWIDGETS_NO_EXPORT void initModel();
+    LIBKOMMITWIDGETS_NO_EXPORT void showFiles(const QString &path);
 
-    TreeModel *const mTreeModel;
+    TreeDirectoriesModel *const mTreeModel;
     const QString mPlace;
     FileActions *const mActions;
     QSharedPointer<Git::Tree> mTree;
@@ -0,0 +1,182 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "pickaxedialog.h"
+#include "actions/commitactions.h"
+#include "core/kmessageboxhelper.h"
+#include "models/commitsmodel.h"
+#include "models/commitssubsetmodel.h"
+
+#include <KLocalizedString>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <entities/commit.h>
+#include <gitmanager.h>
+#include <pickaxe.h>
+
+namespace
+{
+// commits a job searches between two progress updates
+constexpr int progressStep{64};
+}
+
+PickaxeDialog::PickaxeDialog(Git::Manager *git, CommitsModel *commitsModel, QWidget *parent)
+    : AppDialog(git, parent)
+    , mCommitsModel{commitsModel}
+    , mModel{new CommitsSubsetModel{commitsModel, this}}
+    , mActions{new CommitActions{git, this}}
+{
+    setupUi(this);
+    treeView->setModel(mModel);
+
+    // the graph lanes of the whole history make no sense for a few rows out of it
+    if (!commitsModel->fullDetails())
+        treeView->setColumnHidden(0, true);
+
+    connect(radioButtonOccurrences, &QRadioButton::toggled, checkBoxRegularExpression, &QCheckBox::setEnabled);
+    connect(pushButtonSearch, &QPushButton::clicked, this, &PickaxeDialog::search);
+    connect(treeView, &QTreeView::doubleClicked, this, &PickaxeDialog::slotTreeViewDoubleClicked);
+    connect(treeView, &QTreeView::customContextMenuRequested, this, &PickaxeDialog::slotTreeViewCustomContextMenuRequested);
+}
+
+PickaxeDialog::~PickaxeDialog()
+{
+    cancelSearch();
+}
+
+void PickaxeDialog::cancelSearch()
+{
+    mCanceled = true;
+    for (auto &job : mJobs)
+        job.waitForFinished();
+    mJobs.clear();
+    mCanceled = false;
+}
+
+void PickaxeDialog::search()
+{
+    Git::PickaxeOptions options;
+    options.text = lineEditText->text();
+    options.path = lineEditPath->text();
+    options.mode = radioButtonOccurrences->isChecked() ? Git::PickaxeOptions::Mode::Occurrences : Git::PickaxeOptions::Mode::ChangedLines;
+    options.regularExpression = checkBoxRegularExpression->isChecked();
+    options.caseSensitivity = checkBoxCaseSensitive->isChecked() ? Qt::CaseSensitive : Qt::CaseInsensitive;
+
+    if (options.text.isEmpty())
+        return;
+    if (options.regularExpression || options.mode == Git::PickaxeOptions::Mode::ChangedLines) {
+        const QRegularExpression regex{options.text};
+        if (!regex.isValid()) {
+            KMessageBoxHelper::error(this, i18n("Invalid regular expression: %1", regex.errorString()));
+            return;
+        }
+    }
+
+    cancelSearch();
+    mModel->clear();
+
+    QList<Git::Oid> commits;
+    commits.reserve(mCommitsModel->rowCount({}));
+    for (int i = 0; i < mCommitsModel->rowCount({}); ++i)
+        commits << mCommitsModel->at(i)->oid();
+
+    progressBar->setMaximum(commits.size());
+    progressBar->setValue(0);
+    mProgress = 0;
+    if (!mProgressTimer)
+        mProgressTimer = startTimer(500);
+    pushButtonSearch->setEnabled(false);
+
+    // every job takes a run of neighbouring commits, which mostly share the blobs one of them changed
+    const auto searchId = ++mSearchId;
+    const auto started =
+        mGit->runParallel(static_cast<int>(commits.size()), [this, commits, options, searchId](Git::Manager *git, int job, int jobs) {
+            const auto runLength = (commits.size() + jobs - 1) / jobs;
+            const auto run = commits.mid(job * runLength, runLength);
+
+            QList<Git::Oid> results;
+            QElapsedTimer timer;
+            timer.start();
+
+            const auto flush = [this, &results, &timer, searchId]() {
+                if (!results.isEmpty())
+                    QMetaObject::invokeMethod(
+                        this,
+                        [this, results, searchId]() {
+                            addResults(results, searchId);
+                        },
+                        Qt::QueuedConnection);
+                results.clear();
+                timer.restart();
+            };
+
+            for (int start = 0; start < run.size() && !mCanceled; start += progressStep) {
+                const auto step = run.mid(start, progressStep);
+                git->pickaxe(step, options, [this, &results, &timer, &flush](const Git::PickaxeMatch &match) {
+                    results << match.commitId;
+                    if (results.size() >= batchSize || timer.elapsed() >= batchInterval)
+                        flush();
+                    return !mCanceled;
+                });
+                mProgress += step.size();
+            }
+
+            flush();
+            QMetaObject::invokeMethod(
+                this,
+                [this, searchId]() {
+                    jobFinished(searchId);
+                },
+                Qt::QueuedConnection);
+        });
+    mRunningJobs = started.size();
+    mJobs << started;
+}
+
+void PickaxeDialog::addResults(const QList<Git::Oid> &commits, int searchId)
+{
+    if (searchId == mSearchId)
+        mModel->addCommits(commits);
+}
+
+void PickaxeDialog::jobFinished(int searchId)
+{
+    if (searchId != mSearchId || --mRunningJobs)
+        return;
+
+    killTimer(mProgressTimer);
+    mProgressTimer = 0;
+    progressBar->setValue(progressBar->maximum());
+    pushButtonSearch->setEnabled(true);
+}
+
+void PickaxeDialog::slotTreeViewDoubleClicked(const QModelIndex &index)
+{
+    auto commit = mModel->fromIndex(index);
+    if (!commit)
+        return;
+
+    mActions->setCommit(commit);
+    mActions->actionDiff()->trigger();
+}
+
+void PickaxeDialog::slotTreeViewCustomContextMenuRequested(const QPoint &pos)
+{
+    auto commit = mModel->fromIndex(treeView->indexAt(pos));
+    if (!commit)
+        return;
+
+    mActions->setCommit(commit);
+    mActions->popup();
+}
+
+void PickaxeDialog::timerEvent(QTimerEvent *event)
+{
+    Q_UNUSED(event)
+    progressBar->setValue(mProgress);
+}
+
+#include "moc_pickaxedialog.cpp"
@@ -0,0 +1,58 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "appdialog.h"
+#include "entities/oid.h"
+#include "libkommitwidgets_export.h"
+#include "ui_pickaxedialog.h"
+
+#include <QFuture>
+
+#include <atomic>
+
+namespace Git
+{
+class Manager;
+}
+
+class CommitActions;
+class CommitsSubsetModel;
+class CommitsModel;
+
+// Commits of a commits model that added or removed some text, like git log -S and -G
+class LIBKOMMITWIDGETS_EXPORT PickaxeDialog : public AppDialog, private Ui::PickaxeDialog
+{
+    Q_OBJECT
+
+public:
+    explicit PickaxeDialog(Git::Manager *git, CommitsModel *commitsModel, QWidget *parent = nullptr);
+    ~PickaxeDialog() override;
+
+protected:
+    void timerEvent(QTimerEvent *event) override;
+
+private:
+    LIBKOMMITWIDGETS_NO_EXPORT void search();
+    LIBKOMMITWIDGETS_NO_EXPORT void cancelSearch();
+    LIBKOMMITWIDGETS_NO_EXPORT void addResults(const QList<Git::Oid> &commits, int searchId);
+    LIBKOMMITWIDGETS_NO_EXPORT void jobFinished(int searchId);
+    LIBKOMMITWIDGETS_NO_EXPORT void slotTreeViewDoubleClicked(const QModelIndex &index);
+    LIBKOMMITWIDGETS_NO_EXPORT void slotTreeViewCustomContextMenuRequested(const QPoint &pos);
+
+    CommitsModel *const mCommitsModel;
+    CommitsSubsetModel *const mModel;
+    CommitActions *const mActions;
+
+    QList<QFuture<void>> mJobs;
+    std::atomic_int mProgress{0};
+    int mRunningJobs{0};
+    int mProgressTimer{0};
+    // results of a search that was replaced by a newer one are dropped
+    int mSearchId{0};
+    std::atomic_bool mCanceled{false};
+};
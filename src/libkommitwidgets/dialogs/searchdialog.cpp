@@ -7,16 +7,31 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "searchdialog.h"
 #include "caches/branchescache.h"
 #include "caches/commitscache.h"
+#include "caches/trigramindex.h"
+#include "core/kmessageboxhelper.h"
 #include "fileviewerdialog.h"
 
 #include <entities/tree.h>
 
 #include <KLocalizedString>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QRegularExpression>
 #include <QStandardItemModel>
-#include <QtConcurrent>
+#include <caches/blobscache.h>
+#include <entities/blob.h>
 #include <entities/commit.h>
-#include <gitloglist.h>
 #include <gitmanager.h>
+#include <grep.h>
+#include <historyblobs.h>
+
+#include <git2/blob.h>
+
+namespace
+{
+// work tree files a job searches between two progress updates
+constexpr int filesPerGrep{64};
+}
 
 SearchDialog::SearchDialog(const QString &path, Git::Manager *git, QWidget *parent)
     : AppDialog(git, parent)
@@ -30,14 +45,21 @@ SearchDialog::SearchDialog(const QString &path, Git::Manager *git, QWidget *pare
 
     connect(pushButtonSearch, &QPushButton::clicked, this, &SearchDialog::slotPushButtonSearchClicked);
     connect(treeView, &QTreeView::doubleClicked, this, &SearchDialog::slotTreeViewDoubleClicked);
+    connect(radioButtonSearchWorkingTree, &QRadioButton::toggled, checkBoxIncludeUntracked, &QCheckBox::setEnabled);
+    connect(radioButtonSearchWorkingTree, &QRadioButton::toggled, checkBoxUseIndex, &QCheckBox::setDisabled);
 }
 
 void SearchDialog::initModel()
 {
     mModel->setColumnCount(3);
     mModel->setHeaderData(0, Qt::Horizontal, i18n("File name"));
-    mModel->setHeaderData(1, Qt::Horizontal, i18n("Branch"));
-    mModel->setHeaderData(2, Qt::Horizontal, i18n("Commit"));
+    if (mWorkingTreeResults) {
+        mModel->setHeaderData(1, Qt::Horizontal, i18n("Line"));
+        mModel->setHeaderData(2, Qt::Horizontal, i18n("Text"));
+    } else {
+        mModel->setHeaderData(1, Qt::Horizontal, i18n("Branch"));
+        mModel->setHeaderData(2, Qt::Horizontal, i18n("Commit"));
+    }
 }
 
 SearchDialog::SearchDialog(Git::Manager *git, QWidget *parent)
@@ -50,26 +72,321 @@ SearchDialog::SearchDialog(Git::Manager *git, QWidget *parent)
 
     connect(pushButtonSearch, &QPushButton::clicked, this, &SearchDialog::slotPushButtonSearchClicked);
     connect(treeView, &QTreeView::doubleClicked, this, &SearchDialog::slotTreeViewDoubleClicked);
+    connect(radioButtonSearchWorkingTree, &QRadioButton::toggled, checkBoxIncludeUntracked, &QCheckBox::setEnabled);
+    connect(radioButtonSearchWorkingTree, &QRadioButton::toggled, checkBoxUseIndex, &QCheckBox::setDisabled);
+}
+
+SearchDialog::~SearchDialog()
+{
+    cancelSearch();
+}
+
+void SearchDialog::cancelSearch()
+{
+    mCanceled = true;
+    for (auto &job : mJobs)
+        job.waitForFinished();
+    mJobs.clear();
+    mCanceled = false;
 }
 
 void SearchDialog::slotPushButtonSearchClicked()
 {
+    cancelSearch();
+
+    const SearchOptions options{lineEditPath->text(),
+                                lineEditText->text(),
+                                checkBoxCaseSensetive->isChecked() ? Qt::CaseSensitive : Qt::CaseInsensitive,
+                                checkBoxRegularExpression->isChecked(),
+                                checkBoxUseIndex->isChecked() && !radioButtonSearchWorkingTree->isChecked(),
+                                checkBoxIncludeUntracked->isChecked()};
+    if (options.regularExpression) {
+        const QRegularExpression regex{options.text};
+        if (!regex.isValid()) {
+            KMessageBoxHelper::error(this, i18n("Invalid regular expression: %1", regex.errorString()));
+            return;
+        }
+    }
+
+    // blobs the index has not seen yet are searched anyway, so the search does not wait for it
+    if (options.useIndex)
+        mGit->trigramIndex()->update();
+
+    mWorkingTreeResults = radioButtonSearchWorkingTree->isChecked();
     mModel->clear();
     initModel();
     startTimer(500);
     pushButtonSearch->setEnabled(false);
-    mProgress.total = mProgress.value = 0;
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-    auto f = QtConcurrent::run(this, &SearchDialog::beginSearch);
-#else
-    auto f = QtConcurrent::run(&SearchDialog::beginSearch, this);
-#endif
+
+    if (mWorkingTreeResults) {
+        searchWorkingTree(options, ++mSearchId);
+        return;
+    }
+
+    QList<QPair<QString, QString>> places;
+    if (radioButtonSearchBranches->isChecked()) {
+        const auto branches = mGit->branches()->names(Git::BranchType::LocalBranch);
+        for (const auto &branch : branches)
+            places << qMakePair(branch, QString());
+    } else {
+        const auto commits = mGit->commits()->allCommits();
+        for (const auto &commit : commits)
+            places << qMakePair(QString(), commit->commitHash());
+    }
+    mPlaces = places;
+
+    mProgress.total = places.size();
+    mProgress.value = 0;
+
+    // the trees are collected first, so a file that stays the same over many commits is searched once
+    const auto searchId = ++mSearchId;
+    mRunningJobs = 1;
+    mJobs << mGit->runAsync([this, places, options, searchId](Git::Manager *git) {
+        QSharedPointer<Git::HistoryBlobs> history{new Git::HistoryBlobs};
+        const auto filter = [&options](const QString &path) {
+            return options.path.isEmpty() || path.contains(options.path);
+        };
+
+        for (const auto &place : places) {
+            if (mCanceled)
+                break;
+            history->addPlace(git, place.first.isEmpty() ? place.second : place.first, filter);
+            ++mProgress.value;
+        }
+
+        QMetaObject::invokeMethod(
+            this,
+            [this, history, options, searchId]() {
+                if (searchId == mSearchId)
+                    searchBlobs(history, options, searchId);
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void SearchDialog::searchBlobs(QSharedPointer<const Git::HistoryBlobs> history, const SearchOptions &options, int searchId)
+{
+    Git::TrigramIndex::BlobFilter mayMatch;
+    if (options.useIndex) {
+        const auto query = options.regularExpression ? Git::TrigramIndex::Query::fromRegularExpression(options.text, options.caseSensitivity)
+                                                     : Git::TrigramIndex::Query::fromText(options.text, options.caseSensitivity);
+        mayMatch = mGit->trigramIndex()->filter(query);
+    }
+
+    const auto blobs = history->blobs();
+    QList<QPair<Git::Oid, QList<int>>> allBlobs;
+    allBlobs.reserve(blobs.size());
+    for (auto i = blobs.constBegin(); i != blobs.constEnd(); ++i)
+        if (!mayMatch || mayMatch(i.key()))
+            allBlobs << qMakePair(i.key(), i.value());
+
+    mProgress.total = allBlobs.size();
+    mProgress.value = 0;
+
+    // every job searches its share of the blobs with a repository handle of its own
+    const auto started =
+        mGit->runParallel(static_cast<int>(allBlobs.size()), [this, history, allBlobs, options, searchId](Git::Manager *git, int job, int jobs) {
+            const auto share = Git::Manager::jobShare(allBlobs, job, jobs);
+
+            QList<QPair<QString, int>> results;
+            QElapsedTimer timer;
+            timer.start();
+
+            const QRegularExpression regex{options.text,
+                                           options.caseSensitivity == Qt::CaseSensitive ? QRegularExpression::NoPatternOption
+                                                                                        : QRegularExpression::CaseInsensitiveOption};
+            const auto matches = [&regex, &options](const QString &text) {
+                return options.regularExpression ? text.contains(regex) : text.contains(options.text, options.caseSensitivity);
+            };
+
+            const auto flush = [this, &results, &timer, searchId]() {
+                if (!results.isEmpty())
+                    QMetaObject::invokeMethod(
+                        this,
+                        [this, results, searchId]() {
+                            addResults(results, searchId);
+                        },
+                        Qt::QueuedConnection);
+                results.clear();
+                timer.restart();
+            };
+
+            for (const auto &blob : share) {
+                if (mCanceled)
+                    break;
+
+                ++mProgress.value;
+
+                // every blob is read once, so it bypasses the blobs cache instead of filling it
+                git_blob *gitBlob{nullptr};
+                if (git_blob_lookup(&gitBlob, git->repoPtr(), blob.first.oidPtr()))
+                    continue;
+                const Git::Blob content{gitBlob};
+                if (content.isBinary() || !matches(content.text()))
+                    continue;
+
+                for (const auto file : blob.second) {
+                    const auto &path = history->files().at(file).path;
+                    for (const auto place : history->placesOf(file))
+                        results << qMakePair(path, place);
+                }
+                if (results.size() >= batchSize || timer.elapsed() >= batchInterval)
+                    flush();
+            }
+
+            flush();
+            QMetaObject::invokeMethod(
+                this,
+                [this, searchId]() {
+                    jobFinished(searchId);
+                },
+                Qt::QueuedConnection);
+        });
+    mRunningJobs = started.size();
+    mJobs << started;
+}
+
+void SearchDialog::addResults(const QList<QPair<QString, int>> &results, int searchId)
+{
+    if (searchId != mSearchId)
+        return;
+
+    for (const auto &result : results) {
+        const auto &place = mPlaces.at(result.second);
+        mModel->appendRow({new QStandardItem(result.first), new QStandardItem(place.first), new QStandardItem(place.second)});
+    }
+}
+
+void SearchDialog::jobFinished(int searchId)
+{
+    if (searchId == mSearchId && !--mRunningJobs)
+        pushButtonSearch->setEnabled(true);
+}
+
+void SearchDialog::searchWorkingTree(const SearchOptions &options, int searchId)
+{
+    // the top level entries are shared out, each job lists the files below its own ones
+    auto entries = QDir{mGit->path()}.entryList(QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+    entries.removeOne(QStringLiteral(".git"));
+
+    mFiles.clear();
+    mProgress.total = 0;
+    mProgress.value = 0;
+
+    const auto started =
+        mGit->runParallel(static_cast<int>(entries.size()), [this, entries, options, searchId](Git::Manager *git, int job, int jobs) {
+            const auto share = Git::Manager::jobShare(entries, job, jobs);
+
+            // no paths would list the whole tree
+            QStringList files;
+            if (!share.isEmpty() && !mCanceled)
+                files = git->workingTreeFiles(share, options.includeUntracked);
+            if (!options.path.isEmpty())
+                files = files.filter(options.path);
+
+            QMetaObject::invokeMethod(
+                this,
+                [this, files, options, searchId]() {
+                    addFiles(files, options, searchId);
+                },
+                Qt::QueuedConnection);
+        });
+    mRunningJobs = started.size();
+    mJobs << started;
+}
+
+void SearchDialog::addFiles(const QStringList &files, const SearchOptions &options, int searchId)
+{
+    if (searchId != mSearchId)
+        return;
+
+    mFiles << files;
+    if (!--mRunningJobs)
+        grepFiles(options, searchId);
+}
+
+void SearchDialog::grepFiles(const SearchOptions &options, int searchId)
+{
+    const auto files = mFiles;
+    mFiles.clear();
+
+    mProgress.total = files.size();
+    mProgress.value = 0;
+
+    const Git::GrepOptions grepOptions{options.text, options.regularExpression, options.caseSensitivity};
+
+    // files of one directory go to different jobs, so a directory of large files is not left to one of them
+    const auto started =
+        mGit->runParallel(static_cast<int>(files.size()), [this, files, grepOptions, searchId](Git::Manager *git, int job, int jobs) {
+            const auto share = Git::Manager::jobShare(files, job, jobs);
+
+            QList<Git::GrepMatch> matches;
+            QElapsedTimer timer;
+            timer.start();
+
+            const auto flush = [this, &matches, &timer, searchId]() {
+                if (!matches.isEmpty())
+                    QMetaObject::invokeMethod(
+                        this,
+                        [this, matches, searchId]() {
+                            addMatches(matches, searchId);
+                        },
+                        Qt::QueuedConnection);
+                matches.clear();
+                timer.restart();
+            };
+
+            for (int start = 0; start < share.size() && !mCanceled; start += filesPerGrep) {
+                const auto step = share.mid(start, filesPerGrep);
+                git->grep(step, grepOptions, [this, &matches, &timer, &flush](const Git::GrepMatch &match) {
+                    matches << match;
+                    if (matches.size() >= batchSize || timer.elapsed() >= batchInterval)
+                        flush();
+                    return !mCanceled;
+                });
+                mProgress.value += step.size();
+                if (timer.elapsed() >= batchInterval)
+                    flush();
+            }
+
+            flush();
+            QMetaObject::invokeMethod(
+                this,
+                [this, searchId]() {
+                    jobFinished(searchId);
+                },
+                Qt::QueuedConnection);
+        });
+    mRunningJobs = started.size();
+    mJobs << started;
+}
+
+void SearchDialog::addMatches(const QList<Git::GrepMatch> &matches, int searchId)
+{
+    if (searchId != mSearchId)
+        return;
+
+    for (const auto &match : matches) {
+        auto line = new QStandardItem;
+        line->setData(match.line, Qt::DisplayRole);
+        mModel->appendRow({new QStandardItem(match.path), line, new QStandardItem(match.text.trimmed())});
+    }
 }
 
 void SearchDialog::slotTreeViewDoubleClicked(const QModelIndex &index)
 {
     if (!index.isValid())
         return;
+
+    if (mWorkingTreeResults) {
+        const auto file = mModel->data(mModel->index(index.row(), 0)).toString();
+        auto d = new FileViewerDialog(QSharedPointer<Git::File>{new Git::File{QDir{mGit->path()}.filePath(file)}});
+        d->setWindowModality(Qt::ApplicationModal);
+        d->setAttribute(Qt::WA_DeleteOnClose, true);
+        d->show();
+        return;
+    }
+
     const auto file = mModel->data(mModel->index(index.row(), 0)).toString();
     const auto branch = mModel->data(mModel->index(index.row(), 1)).toString();
     const auto commit = mModel->data(mModel->index(index.row(), 2)).toString();
@@ -87,49 +404,9 @@ void SearchDialog::slotTreeViewDoubleClicked(const QModelIndex &index)
     d->show();
 }
 
-void SearchDialog::beginSearch()
-{
-    if (radioButtonSearchBranches->isChecked()) {
-        const auto branchesList = mGit->branches()->names(Git::BranchType::LocalBranch);
-        mProgress.total = branchesList.size();
-        for (const auto &branch : branchesList) {
-            searchOnPlace(branch, QString());
-            mProgress.value++;
-        }
-    } else {
-        auto commits = mGit->commits()->allCommits();
-        Git::LogList list;
-        list.load(mGit);
-
-        mProgress.total = list.size();
-        for (const auto &branch : std::as_const(list)) {
-            searchOnPlace(QString(), branch->commitHash());
-            mProgress.value++;
-        }
-    }
-
-    pushButtonSearch->setEnabled(true);
-}
-
-void SearchDialog::searchOnPlace(const QString &branch, const QString &commit)
-{
-    const QString place = branch.isEmpty() ? commit : branch;
-    const auto files = mGit->ls(place);
-
-    for (const auto &file : files) {
-        if (!lineEditPath->text().isEmpty() && !file.contains(lineEditPath->text()))
-            continue;
-
-        bool ok = mGit->fileContent(place, file).contains(lineEditText->text(), checkBoxCaseSensetive->isChecked() ? Qt::CaseSensitive : Qt::CaseInsensitive);
-        if (ok) {
-            mModel->appendRow({new QStandardItem(file), new QStandardItem(branch), new QStandardItem(commit)});
-        }
-    }
-}
-
 void SearchDialog::searchOnCommit(QSharedPointer<Git::Commit> commit)
 {
-    mProgress.currentPlace = commit->message();
+    mProgress.currentPlace = commit->subject();
     // auto tree = commit->tree();
     // tree.create()
 }
@@ -10,10 +10,16 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "libkommitwidgets_export.h"
 #include "ui_searchdialog.h"
 
+#include <QFuture>
+
+#include <atomic>
+
 namespace Git
 {
 class Manager;
 class Commit;
+class HistoryBlobs;
+struct GrepMatch;
 }
 
 class QStandardItemModel;
@@ -24,6 +30,7 @@ class LIBKOMMITWIDGETS_EXPORT SearchDialog : public AppDialog, private Ui::Searc
 public:
     explicit SearchDialog(const QString &path, Git::Manager *git, QWidget *parent = nullptr);
     explicit SearchDialog(Git::Manager *git, QWidget *parent = nullptr);
+    ~SearchDialog() override;
 
     void initModel();
 
@@ -31,16 +38,43 @@ protected:
     void timerEvent(QTimerEvent *event) override;
 
 private:
+    struct SearchOptions {
+        QString path;
+        QString text;
+        Qt::CaseSensitivity caseSensitivity;
+        bool regularExpression;
+        bool useIndex;
+        bool includeUntracked;
+    };
+
     LIBKOMMITWIDGETS_NO_EXPORT void slotPushButtonSearchClicked();
     LIBKOMMITWIDGETS_NO_EXPORT void slotTreeViewDoubleClicked(const QModelIndex &index);
-    LIBKOMMITWIDGETS_NO_EXPORT void beginSearch();
-    LIBKOMMITWIDGETS_NO_EXPORT void searchOnPlace(const QString &place, const QString &commit);
+    LIBKOMMITWIDGETS_NO_EXPORT void searchBlobs(QSharedPointer<const Git::HistoryBlobs> history, const SearchOptions &options, int searchId);
+    // a file path and the index of a place in mPlaces
+    LIBKOMMITWIDGETS_NO_EXPORT void addResults(const QList<QPair<QString, int>> &results, int searchId);
+    LIBKOMMITWIDGETS_NO_EXPORT void jobFinished(int searchId);
+    LIBKOMMITWIDGETS_NO_EXPORT void searchWorkingTree(const SearchOptions &options, int searchId);
+    LIBKOMMITWIDGETS_NO_EXPORT void addFiles(const QStringList &files, const SearchOptions &options, int searchId);
+    LIBKOMMITWIDGETS_NO_EXPORT void grepFiles(const SearchOptions &options, int searchId);
+    LIBKOMMITWIDGETS_NO_EXPORT void addMatches(const QList<Git::GrepMatch> &matches, int searchId);
     LIBKOMMITWIDGETS_NO_EXPORT void searchOnCommit(QSharedPointer<Git::Commit> commit);
+    LIBKOMMITWIDGETS_NO_EXPORT void cancelSearch();
     struct {
-        int value;
-        int total;
+        std::atomic_int value{0};
+        int total{0};
         QString message;
         QString currentPlace;
     } mProgress;
     QStandardItemModel *const mModel;
+    // branch, commit
+    QList<QPair<QString, QString>> mPlaces;
+    // work tree files to search, collected by several jobs
+    QStringList mFiles;
+    // the rows are lines of work tree files instead of files in commits
+    bool mWorkingTreeResults{false};
+    QList<QFuture<void>> mJobs;
+    int mRunningJobs{0};
+    // results of a search that was replaced by a newer one are dropped
+    int mSearchId{0};
+    std::atomic_bool mCanceled{false};
 };
@@ -6,6 +6,8 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "gitgraphlane.h"
 
+#include <QDataStream>
+
 GraphLane::GraphLane()
 {
     generateRandomColor();
@@ -42,3 +44,16 @@ GraphLane::GraphLane(GraphLane::Type type)
 {
     generateRandomColor();
 }
+
+QDataStream &operator<<(QDataStream &stream, const GraphLane &lane)
+{
+    return stream << static_cast<qint8>(lane.mType) << lane.mBottomJoins << lane.mUpJoins;
+}
+
+QDataStream &operator>>(QDataStream &stream, GraphLane &lane)
+{
+    qint8 type;
+    stream >> type >> lane.mBottomJoins >> lane.mUpJoins;
+    lane.mType = static_cast<GraphLane::Type>(type);
+    return stream;
+}
@@ -8,6 +8,8 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "libkommitwidgets_export.h"
 #include <QList>
 
+class QDataStream;
+
 namespace Impl
 {
 struct LanesFactory;
@@ -43,5 +45,9 @@ private:
     friend class LogList;
     friend struct LanesFactory;
     friend struct Impl::LanesFactory;
+    friend QDataStream &operator<<(QDataStream &stream, const GraphLane &lane);
+    friend QDataStream &operator>>(QDataStream &stream, GraphLane &lane);
 };
 bool operator==(const GraphLane &, const GraphLane &);
+QDataStream &operator<<(QDataStream &stream, const GraphLane &lane);
+QDataStream &operator>>(QDataStream &stream, GraphLane &lane);
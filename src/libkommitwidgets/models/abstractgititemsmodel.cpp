@@ -6,6 +6,10 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "abstractgititemsmodel.h"
 #include "gitmanager.h"
+#include "managerpool.h"
+
+#include <QFutureWatcher>
+#include <QtConcurrent>
 
 AbstractGitItemsModel::AbstractGitItemsModel(Git::Manager *git)
     : AbstractGitItemsModel{git, git}
@@ -19,6 +23,11 @@ AbstractGitItemsModel::AbstractGitItemsModel(Git::Manager *git, QObject *parent)
     connect(git, &Git::Manager::pathChanged, this, &AbstractGitItemsModel::load);
 }
 
+AbstractGitItemsModel::~AbstractGitItemsModel()
+{
+    waitForLoad();
+}
+
 bool AbstractGitItemsModel::isLoaded() const
 {
     return m_status == Loaded;
@@ -40,13 +49,95 @@ Git::Manager *AbstractGitItemsModel::manager() const
 
 void AbstractGitItemsModel::load()
 {
+    if (mAsyncLoadRunning) {
+        mAsyncLoadPending = true;
+        return;
+    }
+
     setStatus(Loading);
     beginResetModel();
     reload();
+    mDataManager.reset();
     endResetModel();
     setStatus(Loaded);
 }
 
+void AbstractGitItemsModel::loadAsync()
+{
+    if (mAsyncLoadRunning) {
+        mAsyncLoadPending = true;
+        return;
+    }
+
+    if (!mGit->isValid()) {
+        load();
+        return;
+    }
+
+    setStatus(Loading);
+    mAsyncLoadRunning = true;
+    prepareFetch();
+
+    // libgit2 handles are not safe to share between threads, so the worker uses one of its own.
+    // It is kept alive for as long as the entities it created are shown by this model.
+    auto worker = mGit->workerPool()->acquire();
+
+    auto watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher, worker]() {
+        watcher->deleteLater();
+        finishAsyncLoad(worker);
+    });
+    mLoadJob = QtConcurrent::run([this, worker]() {
+        fetchData(worker.data());
+    });
+    watcher->setFuture(mLoadJob);
+}
+
+void AbstractGitItemsModel::prepareFetch()
+{
+}
+
+void AbstractGitItemsModel::fetchData(Git::Manager *manager)
+{
+    Q_UNUSED(manager)
+}
+
+void AbstractGitItemsModel::applyData()
+{
+    reload();
+}
+
+bool AbstractGitItemsModel::mergeData()
+{
+    return false;
+}
+
+void AbstractGitItemsModel::waitForLoad()
+{
+    mLoadJob.waitForFinished();
+}
+
+void AbstractGitItemsModel::finishAsyncLoad(QSharedPointer<Git::Manager> worker)
+{
+    mAsyncLoadRunning = false;
+
+    if (mAsyncLoadPending) {
+        mAsyncLoadPending = false;
+        loadAsync();
+        return;
+    }
+
+    if (mergeData()) {
+        mDataManager = worker;
+    } else {
+        beginResetModel();
+        applyData();
+        mDataManager = worker;
+        endResetModel();
+    }
+    setStatus(Loaded);
+}
+
 void AbstractGitItemsModel::setStatus(Status newStatus)
 {
     if (m_status == newStatus)
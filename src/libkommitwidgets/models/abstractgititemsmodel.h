@@ -11,6 +11,8 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
 #include "libkommitwidgets_export.h"
 #include <QAbstractListModel>
+#include <QFuture>
+#include <QSharedPointer>
 
 namespace Git
 {
@@ -25,6 +27,7 @@ class LIBKOMMITWIDGETS_EXPORT AbstractGitItemsModel : public QAbstractListModel
 public:
     explicit AbstractGitItemsModel(Git::Manager *git);
     explicit AbstractGitItemsModel(Git::Manager *git, QObject *parent);
+    ~AbstractGitItemsModel() override;
 
     enum Status { NotLoaded, Loading, Loaded };
     Q_ENUM(Status)
@@ -36,16 +39,38 @@ public:
 
 public Q_SLOTS:
     void load();
+    void loadAsync();
 
 protected:
     void setStatus(Status newStatus);
     Git::Manager *mGit{nullptr};
     virtual void reload() = 0;
 
+    // Called on the GUI thread before fetchData(); copies what the fetch needs from state the GUI
+    // thread may change while the worker runs, as plain values rather than entities.
+    virtual void prepareFetch();
+    // Called from a worker thread by loadAsync(); the given manager owns its own repository
+    // handle and must be the only one used here. Store the result in pending members only.
+    virtual void fetchData(Git::Manager *manager);
+    // Called on the GUI thread between beginResetModel/endResetModel to swap pending data in.
+    virtual void applyData();
+    // Called on the GUI thread before applyData(); may swap pending data in with row level
+    // signals instead, keeping the selection of views. Returns false to get a reset.
+    virtual bool mergeData();
+    // Blocks until a running fetchData() returns. Models that fetch into members of their own
+    // call it first in their destructor, before those members are gone.
+    void waitForLoad();
+
 Q_SIGNALS:
     void loaded();
     void statusChanged();
 
 private:
+    LIBKOMMITWIDGETS_NO_EXPORT void finishAsyncLoad(QSharedPointer<Git::Manager> worker);
+
     Status m_status{NotLoaded};
+    bool mAsyncLoadRunning{false};
+    bool mAsyncLoadPending{false};
+    QSharedPointer<Git::Manager> mDataManager;
+    QFuture<void> mLoadJob;
 };
@@ -8,8 +8,12 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "caches/branchescache.h"
 #include "entities/branch.h"
 #include "gitmanager.h"
+#include "repositorywatcher.h"
 
 #include <KLocalizedString>
+#include <QHash>
+
+#include <algorithm>
 
 class BranchesModelPrivate
 {
@@ -20,22 +24,39 @@ public:
     BranchesModelPrivate(BranchesModel *parent);
 
     void calculateCommitStats();
+    // Row of the branch with that ref name, -1 if there is none
+    int rowOf(const QString &refName) const;
+    void applyChanges(const Git::BranchesCache::ChangeSet &changes);
 
     QMap<QSharedPointer<Git::Branch>, QPair<int, int>> compareWithRef;
     QList<QSharedPointer<Git::Branch>> data;
+    QMap<QSharedPointer<Git::Branch>, QPair<int, int>> pendingCompareWithRef;
+    QList<QSharedPointer<Git::Branch>> pendingData;
     QString currentBranch;
     QString referenceBranch;
+    // referenceBranch when the fetch started
+    QString fetchReferenceBranch;
 };
 
 BranchesModel::BranchesModel(Git::Manager *git)
     : AbstractGitItemsModel{git}
     , d_ptr{new BranchesModelPrivate{this}}
 {
-    connect(git->branches(), &Git::BranchesCache::reseted, this, &BranchesModel::reload);
+    connect(git->watcher(), &Git::RepositoryWatcher::refsChanged, this, [this](const QStringList &names) {
+        if (Git::RepositoryWatcher::containsRefsUnder(names, QStringLiteral("refs/heads/"))
+            || Git::RepositoryWatcher::containsRefsUnder(names, QStringLiteral("refs/remotes/")))
+            loadAsync();
+    });
+    connect(git->watcher(), &Git::RepositoryWatcher::headMoved, this, &BranchesModel::loadAsync);
+    connect(git->branches(), &Git::BranchesCache::changed, this, [this](const Git::BranchesCache::ChangeSet &changes) {
+        Q_D(BranchesModel);
+        d->applyChanges(changes);
+    });
 }
 
 BranchesModel::~BranchesModel()
 {
+    waitForLoad();
     Q_D(BranchesModel);
     delete d;
 }
@@ -128,16 +149,92 @@ QSharedPointer<Git::Branch> BranchesModel::findByName(const QString &branchName)
 }
 
 void BranchesModel::reload()
+{
+    prepareFetch();
+    fetchData(mGit);
+    applyData();
+}
+
+void BranchesModel::prepareFetch()
+{
+    Q_D(BranchesModel);
+    d->fetchReferenceBranch = d->referenceBranch;
+}
+
+void BranchesModel::fetchData(Git::Manager *manager)
 {
     Q_D(BranchesModel);
 
-    if (mGit->isValid()) {
-        d->data = mGit->branches()->allBranches(Git::BranchType::AllBranches);
-        d->calculateCommitStats();
+    d->pendingCompareWithRef.clear();
+
+    if (manager->isValid()) {
+        d->pendingData = manager->branches()->allBranches(Git::BranchType::AllBranches);
+        for (auto const &b : std::as_const(d->pendingData))
+            d->pendingCompareWithRef.insert(b, manager->uniqueCommitsOnBranches(d->fetchReferenceBranch, b->name()));
     } else {
-        d->data.clear();
-        d->compareWithRef.clear();
+        d->pendingData.clear();
+    }
+}
+
+void BranchesModel::applyData()
+{
+    Q_D(BranchesModel);
+
+    d->compareWithRef.swap(d->pendingCompareWithRef);
+    d->data.swap(d->pendingData);
+    d->pendingCompareWithRef.clear();
+    d->pendingData.clear();
+}
+
+bool BranchesModel::mergeData()
+{
+    Q_D(BranchesModel);
+
+    if (d->data.isEmpty() || d->pendingData.isEmpty())
+        return false;
+
+    QHash<QString, int> pendingRows;
+    pendingRows.reserve(d->pendingData.size());
+    for (int row = 0; row < d->pendingData.size(); ++row)
+        pendingRows.insert(d->pendingData.at(row)->refName(), row);
+
+    // rows keep their place, so views keep the selection; gone branches are removed from the bottom up
+    for (auto row = d->data.size() - 1; row >= 0;) {
+        if (pendingRows.contains(d->data.at(row)->refName())) {
+            --row;
+            continue;
+        }
+
+        auto first = row;
+        while (first > 0 && !pendingRows.contains(d->data.at(first - 1)->refName()))
+            --first;
+
+        beginRemoveRows({}, first, row);
+        d->data.erase(d->data.begin() + first, d->data.begin() + row + 1);
+        endRemoveRows();
+        row = first - 1;
+    }
+
+    // the entities and counts of the others come from the new load
+    for (auto &branch : d->data)
+        branch = d->pendingData.at(pendingRows.take(branch->refName()));
+    d->compareWithRef.swap(d->pendingCompareWithRef);
+    if (!d->data.isEmpty())
+        Q_EMIT dataChanged(index(0, 0), index(d->data.size() - 1, columnCount({}) - 1));
+
+    // what is left in pendingRows is new, in the order of the load
+    QList<int> newRows{pendingRows.cbegin(), pendingRows.cend()};
+    std::sort(newRows.begin(), newRows.end());
+    if (!newRows.isEmpty()) {
+        beginInsertRows({}, d->data.size(), d->data.size() + newRows.size() - 1);
+        for (const auto row : std::as_const(newRows))
+            d->data << d->pendingData.at(row);
+        endInsertRows();
     }
+
+    d->pendingCompareWithRef.clear();
+    d->pendingData.clear();
+    return true;
 }
 
 const QString &BranchesModel::referenceBranch() const
@@ -151,6 +248,44 @@ BranchesModelPrivate::BranchesModelPrivate(BranchesModel *parent)
 {
 }
 
+int BranchesModelPrivate::rowOf(const QString &refName) const
+{
+    for (int row = 0; row < data.size(); ++row)
+        if (data.at(row)->refName() == refName)
+            return row;
+    return -1;
+}
+
+void BranchesModelPrivate::applyChanges(const Git::BranchesCache::ChangeSet &changes)
+{
+    Q_Q(BranchesModel);
+
+    // only branches this process created or removed are in here, the next load brings the rest
+    for (const auto &branch : changes.removed) {
+        const auto row = rowOf(branch->refName());
+        if (row == -1)
+            continue;
+        q->beginRemoveRows({}, row, row);
+        compareWithRef.remove(data.takeAt(row));
+        q->endRemoveRows();
+    }
+
+    for (const auto &branch : changes.inserted) {
+        if (rowOf(branch->refName()) != -1)
+            continue;
+        q->beginInsertRows({}, data.size(), data.size());
+        compareWithRef.insert(branch, q->manager()->uniqueCommitsOnBranches(referenceBranch, branch->name()));
+        data << branch;
+        q->endInsertRows();
+    }
+
+    for (const auto &branch : changes.updated) {
+        const auto row = rowOf(branch->refName());
+        if (row != -1)
+            Q_EMIT q->dataChanged(q->index(row, 0), q->index(row, q->columnCount({}) - 1));
+    }
+}
+
 void BranchesModelPrivate::calculateCommitStats()
 {
     Q_Q(BranchesModel);
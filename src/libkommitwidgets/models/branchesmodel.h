@@ -44,6 +44,12 @@ public:
     void clear() override;
     void reload() override;
 
+protected:
+    void prepareFetch() override;
+    void fetchData(Git::Manager *manager) override;
+    void applyData() override;
+    bool mergeData() override;
+
 private:
     BranchesModelPrivate *d_ptr;
     Q_DECLARE_PRIVATE(BranchesModel)
@@ -15,6 +15,9 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include <QDebug>
 #include <QIcon>
+#include <QSet>
+
+#include <algorithm>
 #include <entities/submodule.h>
 
 namespace Impl
@@ -86,6 +89,32 @@ ChangedFilesModel::ChangedFilesModel(Git::Manager *git, bool checkable, QObject
 }
 
 void ChangedFilesModel::reload()
+{
+    auto status = mGit->workingTreeStatus();
+    connect(status, &Git::WorkingTreeStatus::changed, this, &ChangedFilesModel::applyDelta, Qt::UniqueConnection);
+
+    // the rows are rebuilt anyway, deltas found on the way are not worth applying. A full rescan,
+    // the watches do not see files written in place
+    mResetting = true;
+    status->refresh();
+    mResetting = false;
+
+    resetRows();
+}
+
+void ChangedFilesModel::refresh()
+{
+    auto status = mGit->workingTreeStatus();
+    connect(status, &Git::WorkingTreeStatus::changed, this, &ChangedFilesModel::applyDelta, Qt::UniqueConnection);
+
+    mResetting = true;
+    status->refresh();
+    mResetting = false;
+
+    resetRows();
+}
+
+void ChangedFilesModel::resetRows()
 {
     beginResetModel();
 
@@ -108,7 +137,7 @@ void ChangedFilesModel::reload()
         }
     }
 
-    auto files = mGit->changedFiles();
+    const auto &files = mGit->workingTreeStatus()->files();
     for (auto i = files.begin(); i != files.end(); ++i) {
         if (i.value() == Git::ChangeStatus::Ignored)
             continue;
@@ -125,6 +154,79 @@ void ChangedFilesModel::reload()
     endResetModel();
 }
 
+void ChangedFilesModel::applyDelta(const Git::WorkingTreeStatus::Delta &delta)
+{
+    if (mResetting)
+        return;
+
+    QSet<QString> removed{delta.removed.begin(), delta.removed.end()};
+    for (auto i = delta.changed.constBegin(); i != delta.changed.constEnd(); ++i)
+        if (i.value() == Git::ChangeStatus::Ignored)
+            removed.insert(i.key());
+
+    const auto checkedBefore = checkedCount();
+
+    for (auto i = mData.size() - 1; i >= 0; --i) {
+        const auto &row = mData.at(i);
+        if (row.submodule)
+            continue;
+
+        if (removed.contains(row.filePath)) {
+            beginRemoveRows({}, i, i);
+            mData.removeAt(i);
+            endRemoveRows();
+            continue;
+        }
+
+        auto changed = delta.changed.constFind(row.filePath);
+        if (changed != delta.changed.constEnd()) {
+            mData[i].status = *changed;
+            createIcon(*changed);
+            Q_EMIT dataChanged(index(i), index(i));
+        }
+    }
+
+    for (auto i = delta.added.constBegin(); i != delta.added.constEnd(); ++i)
+        if (i.value() != Git::ChangeStatus::Ignored)
+            insertRow(i.key(), i.value());
+
+    // a file that stops being ignored shows up as changed
+    for (auto i = delta.changed.constBegin(); i != delta.changed.constEnd(); ++i) {
+        if (i.value() == Git::ChangeStatus::Ignored)
+            continue;
+        auto exists = std::any_of(mData.cbegin(), mData.cend(), [&i](const Row &row) {
+            return !row.submodule && row.filePath == i.key();
+        });
+        if (!exists)
+            insertRow(i.key(), i.value());
+    }
+
+    if (checkedCount() != checkedBefore)
+        Q_EMIT checkedCountChanged();
+}
+
+void ChangedFilesModel::insertRow(const QString &filePath, Git::ChangeStatus status)
+{
+    // file rows follow the submodules, sorted by path as the status lists them
+    auto begin = std::find_if(mData.begin(), mData.end(), [](const Row &row) {
+        return !row.submodule;
+    });
+    auto position = std::lower_bound(begin, mData.end(), filePath, [](const Row &row, const QString &path) {
+        return row.filePath < path;
+    });
+    const auto i = static_cast<int>(position - mData.begin());
+
+    Row d;
+    d.filePath = filePath;
+    d.status = status;
+    d.checked = true;
+    createIcon(d.status);
+
+    beginInsertRows({}, i, i);
+    mData.insert(i, d);
+    endInsertRows();
+}
+
 int ChangedFilesModel::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent)
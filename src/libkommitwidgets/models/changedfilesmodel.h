@@ -7,6 +7,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
 
 #include "types.h"
+#include "workingtreestatus.h"
 #include <entities/submodule.h>
 
 #include <QAbstractListModel>
@@ -18,7 +19,10 @@ class ChangedFilesModel : public QAbstractListModel
 
 public:
     explicit ChangedFilesModel(Git::Manager *git, bool checkable = false, QObject *parent = nullptr);
+    // Rebuilds the rows from the watched status, then follows its changes
     void reload();
+    // Same as reload() with a full rescan, for changes the directory watches miss
+    void refresh();
 
     Q_REQUIRED_RESULT int rowCount(const QModelIndex &parent) const override;
     Q_REQUIRED_RESULT int columnCount(const QModelIndex &parent) const override;
@@ -48,9 +52,13 @@ Q_SIGNALS:
 
 private:
     void createIcon(Git::ChangeStatus status);
+    void resetRows();
+    void applyDelta(const Git::WorkingTreeStatus::Delta &delta);
+    void insertRow(const QString &filePath, Git::ChangeStatus status);
 
     Git::Manager *mGit{nullptr};
     QList<Row> mData;
     QMap<Git::ChangeStatus, QIcon> mIcons;
     bool mCheckable = false;
+    bool mResetting = false;
 };
@@ -12,6 +12,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "qdebug.h"
 
 #include <KLocalizedString>
+#include <QDataStream>
 #include <QDebug>
 
 #include <git2/commit.h>
@@ -21,13 +22,16 @@ struct CommitsLaneData {
     QVector<GraphLane> lanes;
 };
 
+static const QByteArray graphIndexExtension = QByteArrayLiteral("lanes");
+
 namespace Impl
 {
 
 struct LanesFactory {
-    QStringList _hashes;
+    // a null oid marks a free lane
+    QList<Git::Oid> _hashes;
 
-    QList<int> findByChild(const QString &hash)
+    QList<int> findByChild(const Git::Oid &hash)
     {
         int index{0};
         QList<int> ret;
@@ -39,30 +43,24 @@ struct LanesFactory {
         return ret;
     }
 
-    int indexOfChild(const QString &hash)
+    int indexOfChild(const Git::Oid &hash)
     {
-        int index{0};
-        for (auto const &h : std::as_const(_hashes)) {
-            if (hash == h)
-                return index;
-            index++;
-        }
-        return -1;
+        return _hashes.indexOf(hash);
     }
 
-    QVector<GraphLane> initLanes(const QString &myHash, int &myIndex)
+    QVector<GraphLane> initLanes(const Git::Oid &myHash, int &myIndex)
     {
         if (_hashes.empty())
             return {};
 
-        while (!_hashes.empty() && _hashes.last() == QString())
+        while (!_hashes.empty() && _hashes.last().isNull())
             _hashes.removeLast();
 
         int index{0};
         QVector<GraphLane> lanes;
         lanes.reserve(_hashes.size());
         for (const auto &hash : std::as_const(_hashes)) {
-            if (hash == QString()) {
+            if (hash.isNull()) {
                 lanes.append(GraphLane::Transparent);
             } else {
                 if (hash == myHash) {
@@ -77,7 +75,7 @@ struct LanesFactory {
         return lanes;
     }
 
-    QList<int> setHashes(const QStringList &children, int myIndex)
+    QList<int> setHashes(const QList<Git::Oid> &children, int myIndex)
     {
         QList<int> ret;
         bool myIndexSet{myIndex == -1};
@@ -90,7 +88,7 @@ struct LanesFactory {
                 myIndexSet = true;
             }
             if (index == -1)
-                index = indexOfChild(QString());
+                index = indexOfChild(Git::Oid{});
 
             if (index == -1) {
                 _hashes.append(h);
@@ -103,14 +101,14 @@ struct LanesFactory {
         return ret;
     }
 
-    void start(const QString &hash, QVector<GraphLane> &lanes)
+    void start(const Git::Oid &hash, QVector<GraphLane> &lanes)
     {
         Q_UNUSED(hash)
-        _hashes.append(QString());
+        _hashes.append(Git::Oid{});
         set(_hashes.size() - 1, GraphLane::Start, lanes);
     }
 
-    void join(const QString &hash, QVector<GraphLane> &lanes, int &myIndex)
+    void join(const Git::Oid &hash, QVector<GraphLane> &lanes, int &myIndex)
     {
         // TODO: fix me
         int firstIndex{-1};
@@ -126,12 +124,12 @@ struct LanesFactory {
                 lane.mType = GraphLane::Transparent;
                 set(*i, lane, lanes);
             }
-            _hashes.replace(*i, QString());
+            _hashes.replace(*i, Git::Oid{});
         }
         myIndex = firstIndex;
     }
 
-    void fork(const QStringList &childrenList, QVector<GraphLane> &lanes, int myInedx)
+    void fork(const QList<Git::Oid> &childrenList, QVector<GraphLane> &lanes, int myInedx)
     {
         // TODO: fix me
         const auto list = setHashes(childrenList, -1);
@@ -185,17 +183,19 @@ struct LanesFactory {
     QVector<GraphLane> apply(Git::Commit *log)
     {
         int myIndex = -1;
-        QVector<GraphLane> lanes = initLanes(log->commitHash(), myIndex);
+        const auto hash = log->oid();
+        const auto children = log->childOids();
+        QVector<GraphLane> lanes = initLanes(hash, myIndex);
         // TODO: fix me
-        if (!log->parents().empty())
-            join(log->commitHash(), lanes, myIndex);
-        else if (!log->children().empty()) {
-            start(log->children().first(), lanes);
+        if (!log->parentOids().empty())
+            join(hash, lanes, myIndex);
+        else if (!children.empty()) {
+            start(children.first(), lanes);
             myIndex = _hashes.size() - 1;
         }
 
-        if (!log->children().empty()) {
-            fork(log->children(), lanes, myIndex);
+        if (!children.empty()) {
+            fork(children, lanes, myIndex);
         } else if (myIndex != -1) {
             lanes[myIndex].mType = GraphLane::End;
         }
@@ -210,17 +210,23 @@ class CommitsModelPrivate
 {
 public:
     void initChilds();
-    void initGraph();
+    void initGraph(const QList<CommitsLaneData *> &lanesData);
+    bool readGraph(const QByteArray &serialized, const QList<CommitsLaneData *> &lanesData);
+    QByteArray writeGraph(const QList<CommitsLaneData *> &lanesData) const;
 
     bool fullDetails{false};
     QSharedPointer<Git::Branch> branch;
     QList<CommitsLaneData *> data;
     QList<QSharedPointer<Git::Commit>> list;
     QStringList branches;
-    QMap<QString, QSharedPointer<Git::Commit>> dataByCommitHashLong;
-    QMap<QString, QSharedPointer<Git::Commit>> dataByCommitHashShort;
+    QHash<Git::Oid, int> rowByOid;
+
+    QList<CommitsLaneData *> pendingData;
+    QList<QSharedPointer<Git::Commit>> pendingList;
+    // reference name of branch when the fetch started, empty for all commits
+    QString fetchRefName;
+    QHash<Git::Oid, int> pendingRowByOid;
     QCalendar calendar;
-    QSet<QString> seenHashes;
 
     CommitsModelPrivate(CommitsModel *parent);
 
@@ -232,12 +238,11 @@ CommitsModel::CommitsModel(Git::Manager *git, QObject *parent)
     : AbstractGitItemsModel(git, parent)
     , d_ptr{new CommitsModelPrivate{this}}
 {
-    connect(git->commits(), &Git::CommitsCache::added, this, &CommitsModel::reload);
-    connect(git, &Git::Manager::pathChanged, this, &CommitsModel::reload);
 }
 
 CommitsModel::~CommitsModel()
 {
+    waitForLoad();
     Q_D(CommitsModel);
     delete d;
 }
@@ -331,7 +336,7 @@ QVariant CommitsModel::data(const QModelIndex &index, int role) const
     if (d->fullDetails) {
         switch (index.column()) {
         case 0:
-            return log->message();
+            return log->subject();
         case 1: {
             if (d->calendar.isValid())
                 return log->committer()->time().toLocalTime().toString(QStringLiteral("yyyy-MM-dd HH:mm:ss"), d->calendar);
@@ -346,7 +351,7 @@ QVariant CommitsModel::data(const QModelIndex &index, int role) const
         case 0:
             return QString();
         case 1:
-            return log->message();
+            return log->subject();
         }
     }
 
@@ -374,66 +379,190 @@ QVector<GraphLane> CommitsModel::lanesFromIndex(const QModelIndex &index) const
 }
 
 QModelIndex CommitsModel::findIndexByHash(const QString &hash) const
+{
+    return findIndexByOid(Git::Oid::fromString(hash));
+}
+
+QModelIndex CommitsModel::findIndexByOid(const Git::Oid &oid) const
 {
     Q_D(const CommitsModel);
 
-    int idx{0};
-    for (auto &log : d->list)
-        if (log->commitHash() == hash)
-            return index(idx);
-        else
-            idx++;
-    return {};
+    auto row = d->rowByOid.value(oid, -1);
+    if (row == -1)
+        return {};
+    return index(row);
 }
 
 QSharedPointer<Git::Commit> CommitsModel::findLogByHash(const QString &hash, LogMatchType matchType) const
 {
     Q_D(const CommitsModel);
 
-    QList<QSharedPointer<Git::Commit>>::ConstIterator i;
+    const auto oid = Git::Oid::fromString(hash);
+    if (oid.isNull())
+        return nullptr;
 
     switch (matchType) {
     case LogMatchType::ExactMatch:
-        i = std::find_if(d->list.begin(), d->list.end(), [&hash](QSharedPointer<Git::Commit> log) {
-            return log->commitHash() == hash;
-        });
-        break;
-    case LogMatchType::BeginMatch:
-        i = std::find_if(d->list.begin(), d->list.end(), [&hash](QSharedPointer<Git::Commit> log) {
-            return log->commitHash().startsWith(hash);
+        if (hash.size() != GIT_OID_HEXSZ)
+            return nullptr;
+        return at(d->rowByOid.value(oid, -1));
+
+    case LogMatchType::BeginMatch: {
+        auto i = std::find_if(d->list.begin(), d->list.end(), [&oid, &hash](const QSharedPointer<Git::Commit> &log) {
+            return log->oid().startsWith(oid, hash.size());
         });
+        if (i != d->list.end())
+            return *i;
         break;
     }
-    if (i == d->list.end())
-        return nullptr;
-    return *i;
+    }
+    return nullptr;
 }
 
 void CommitsModel::reload()
+{
+    prepareFetch();
+    fetchData(mGit);
+    applyData();
+}
+
+void CommitsModel::prepareFetch()
 {
     Q_D(CommitsModel);
+    d->fetchRefName = d->branch.isNull() ? QString{} : d->branch->refName();
+}
 
-    qDeleteAll(d->data);
-    d->data.clear();
+void CommitsModel::fetchData(Git::Manager *manager)
+{
+    Q_D(CommitsModel);
+
+    qDeleteAll(d->pendingData);
+    d->pendingData.clear();
+    d->pendingRowByOid.clear();
 
-    if (mGit->isValid()) {
-        if (d->branch.isNull())
-            d->list = mGit->commits()->allCommits();
+    if (manager->isValid()) {
+        if (d->fetchRefName.isEmpty())
+            d->pendingList = manager->commits()->allCommits();
         else
-            d->list = mGit->commits()->commitsInBranch(d->branch);
-        d->dataByCommitHashLong.clear();
+            d->pendingList = manager->commits()->commitsInBranch(d->fetchRefName);
 
-        d->data.reserve(d->list.size());
-        for (auto const &commit : std::as_const(d->list)) {
-            d->dataByCommitHashLong.insert(commit->commitHash(), commit);
-            d->data << new CommitsLaneData{commit, {}};
+        d->pendingData.reserve(d->pendingList.size());
+        d->pendingRowByOid.reserve(d->pendingList.size());
+        for (auto const &commit : std::as_const(d->pendingList)) {
+            d->pendingRowByOid.insert(commit->oid(), d->pendingData.size());
+            d->pendingData << new CommitsLaneData{commit, {}};
         }
     } else {
-        d->list.clear();
-        d->dataByCommitHashLong.clear();
+        d->pendingList.clear();
     }
+
+    if (!manager->isValid() || !d->fetchRefName.isEmpty()) {
+        d->initGraph(d->pendingData);
+        return;
+    }
+
+    // lanes of the whole history only change when the commit index does, so they are stored in it
+    if (!d->readGraph(manager->commits()->indexExtension(graphIndexExtension), d->pendingData)) {
+        d->initGraph(d->pendingData);
+        manager->commits()->setIndexExtension(graphIndexExtension, d->writeGraph(d->pendingData));
+    }
+}
+
+void CommitsModel::applyData()
+{
+    Q_D(CommitsModel);
+
+    qDeleteAll(d->data);
+    d->data.clear();
+
+    d->data.swap(d->pendingData);
+    d->list.swap(d->pendingList);
+    d->rowByOid.swap(d->pendingRowByOid);
+
+    d->pendingList.clear();
+    d->pendingRowByOid.clear();
     d->initChilds();
-    d->initGraph();
+}
+
+bool CommitsModel::mergeData()
+{
+    Q_D(CommitsModel);
+
+    if (d->list.isEmpty() || d->pendingList.isEmpty())
+        return false;
+
+    // rows can only be inserted and removed if the commits in both lists keep their order
+    QList<int> removedRows;
+    int lastRow{-1};
+    for (int row = 0; row < d->list.size(); ++row) {
+        auto newRow = d->pendingRowByOid.value(d->list.at(row)->oid(), -1);
+        if (newRow == -1) {
+            removedRows << row;
+            continue;
+        }
+        if (newRow < lastRow)
+            return false;
+        lastRow = newRow;
+    }
+
+    // views catch up faster with a reset than with that many row signals
+    const auto insertedCount = d->pendingList.size() - (d->list.size() - removedRows.size());
+    if (removedRows.size() + insertedCount > d->list.size() / 2)
+        return false;
+
+    // removed from the bottom up so the rows above keep their numbers
+    for (auto i = removedRows.size() - 1; i >= 0;) {
+        auto last = removedRows.at(i);
+        auto first = last;
+        while (i > 0 && removedRows.at(i - 1) == first - 1)
+            first = removedRows.at(--i);
+        --i;
+
+        beginRemoveRows({}, first, last);
+        for (auto row = last; row >= first; --row) {
+            delete d->data.takeAt(row);
+            d->list.removeAt(row);
+        }
+        endRemoveRows();
+    }
+
+    // the remaining rows are the surviving commits in their new order, so new commits go to their final rows
+    for (int row = 0; row < d->pendingList.size();) {
+        if (d->rowByOid.contains(d->pendingList.at(row)->oid())) {
+            ++row;
+            continue;
+        }
+
+        auto last = row;
+        while (last + 1 < d->pendingList.size() && !d->rowByOid.contains(d->pendingList.at(last + 1)->oid()))
+            ++last;
+
+        beginInsertRows({}, row, last);
+        for (auto i = row; i <= last; ++i) {
+            d->list.insert(i, d->pendingList.at(i));
+            d->data.insert(i, d->pendingData.at(i));
+            d->pendingData[i] = nullptr;
+        }
+        endInsertRows();
+        row = last + 1;
+    }
+
+    // every lane may have moved, and the entities now come from the new load
+    for (int row = 0; row < d->data.size(); ++row) {
+        if (auto laneData = d->pendingData.at(row)) {
+            delete d->data.at(row);
+            d->data[row] = laneData;
+        }
+    }
+    d->pendingData.clear();
+    d->list.swap(d->pendingList);
+    d->rowByOid.swap(d->pendingRowByOid);
+    d->pendingList.clear();
+    d->pendingRowByOid.clear();
+
+    if (!d->list.isEmpty())
+        Q_EMIT dataChanged(index(0, 0), index(d->list.size() - 1, columnCount({}) - 1));
+    return true;
 }
 
 bool CommitsModel::fullDetails() const
@@ -465,15 +594,47 @@ void CommitsModelPrivate::initChilds()
     // }
 }
 
-void CommitsModelPrivate::initGraph()
+void CommitsModelPrivate::initGraph(const QList<CommitsLaneData *> &lanesData)
 {
     Impl::LanesFactory factory;
-    for (auto i = data.rbegin(); i != data.rend(); i++) {
+    for (auto i = lanesData.rbegin(); i != lanesData.rend(); i++) {
         auto d = *i;
         d->lanes = factory.apply(d->commit.data());
     }
 }
 
+bool CommitsModelPrivate::readGraph(const QByteArray &serialized, const QList<CommitsLaneData *> &lanesData)
+{
+    if (serialized.isEmpty())
+        return false;
+
+    QDataStream stream{serialized};
+    stream.setVersion(QDataStream::Qt_5_15);
+
+    quint32 count;
+    stream >> count;
+    if (count != static_cast<quint32>(lanesData.size()))
+        return false;
+
+    for (auto d : lanesData)
+        stream >> d->lanes;
+
+    return stream.status() == QDataStream::Ok;
+}
+
+QByteArray CommitsModelPrivate::writeGraph(const QList<CommitsLaneData *> &lanesData) const
+{
+    QByteArray serialized;
+    QDataStream stream{&serialized, QIODevice::WriteOnly};
+    stream.setVersion(QDataStream::Qt_5_15);
+
+    stream << static_cast<quint32>(lanesData.size());
+    for (auto d : lanesData)
+        stream << d->lanes;
+
+    return serialized;
+}
+
 QString CommitsModel::calendarType() const
 {
     Q_D(const CommitsModel);
@@ -17,6 +17,7 @@ namespace Git
 class Branch;
 class Commit;
 class Manager;
+class Oid;
 }
 
 class CommitsModelPrivate;
@@ -39,6 +40,7 @@ public:
     QVector<GraphLane> lanesFromIndex(const QModelIndex &index) const;
 
     QModelIndex findIndexByHash(const QString &hash) const;
+    QModelIndex findIndexByOid(const Git::Oid &oid) const;
     QSharedPointer<Git::Commit> findLogByHash(const QString &hash, LogMatchType matchType = LogMatchType::ExactMatch) const;
 
     Q_REQUIRED_RESULT QSharedPointer<Git::Branch> branch() const;
@@ -54,6 +56,10 @@ public:
 
 protected:
     void reload() override;
+    void prepareFetch() override;
+    void fetchData(Git::Manager *manager) override;
+    void applyData() override;
+    bool mergeData() override;
 
 private:
     CommitsModelPrivate *d_ptr;
@@ -0,0 +1,58 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "commitssubsetmodel.h"
+#include "commitsmodel.h"
+#include "entities/commit.h"
+
+CommitsSubsetModel::CommitsSubsetModel(CommitsModel *commitsModel, QObject *parent)
+    : QSortFilterProxyModel{parent}
+    , mCommitsModel{commitsModel}
+{
+    setSourceModel(commitsModel);
+}
+
+void CommitsSubsetModel::addCommits(const QList<Git::Oid> &commits)
+{
+    auto added{false};
+    for (const auto &commit : commits)
+        if (!mCommits.contains(commit)) {
+            mCommits.insert(commit);
+            added = true;
+        }
+
+    if (added)
+        invalidateFilter();
+}
+
+void CommitsSubsetModel::clear()
+{
+    if (mCommits.isEmpty())
+        return;
+
+    mCommits.clear();
+    invalidateFilter();
+}
+
+bool CommitsSubsetModel::contains(const Git::Oid &commit) const
+{
+    return mCommits.contains(commit);
+}
+
+QSharedPointer<Git::Commit> CommitsSubsetModel::fromIndex(const QModelIndex &index) const
+{
+    return mCommitsModel->fromIndex(mapToSource(index));
+}
+
+bool CommitsSubsetModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    Q_UNUSED(sourceParent)
+
+    const auto commit = mCommitsModel->at(sourceRow);
+    return commit && mCommits.contains(commit->oid());
+}
+
+#include "moc_commitssubsetmodel.cpp"
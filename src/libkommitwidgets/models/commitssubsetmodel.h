@@ -0,0 +1,48 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "entities/oid.h"
+#include "libkommitwidgets_export.h"
+
+#include <QSet>
+#include <QSharedPointer>
+#include <QSortFilterProxyModel>
+
+namespace Git
+{
+class Commit;
+}
+
+class CommitsModel;
+
+/**
+ * The rows of a CommitsModel for a set of commits, e.g. those a search found so far.
+ *
+ * Commits are kept by id, so rows keep the order of the commits model and follow it when it
+ * reloads; a commit it does not list yet shows up once it does.
+ */
+class LIBKOMMITWIDGETS_EXPORT CommitsSubsetModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit CommitsSubsetModel(CommitsModel *commitsModel, QObject *parent = nullptr);
+
+    void addCommits(const QList<Git::Oid> &commits);
+    void clear();
+
+    Q_REQUIRED_RESULT bool contains(const Git::Oid &commit) const;
+    Q_REQUIRED_RESULT QSharedPointer<Git::Commit> fromIndex(const QModelIndex &index) const;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    CommitsModel *const mCommitsModel;
+    QSet<Git::Oid> mCommits;
+};
@@ -18,6 +18,7 @@ RemotesModel::RemotesModel(Git::Manager *git)
 
 RemotesModel::~RemotesModel()
 {
+    waitForLoad();
 }
 
 int RemotesModel::columnCount(const QModelIndex &parent) const
@@ -83,11 +84,23 @@ void RemotesModel::clear()
 
 void RemotesModel::reload()
 {
-    if (mGit->isValid()) {
-        mData = mGit->remotes()->allRemotes();
+    fetchData(mGit);
+    applyData();
+}
+
+void RemotesModel::fetchData(Git::Manager *manager)
+{
+    if (manager->isValid()) {
+        mPendingData = manager->remotes()->allRemotes();
     } else {
-        mData.clear();
+        mPendingData.clear();
     }
 }
 
+void RemotesModel::applyData()
+{
+    mData.swap(mPendingData);
+    mPendingData.clear();
+}
+
 #include "moc_remotesmodel.cpp"
@@ -37,7 +37,10 @@ public:
 
 protected:
     void reload() override;
+    void fetchData(Git::Manager *manager) override;
+    void applyData() override;
 
 private:
     QList<QSharedPointer<Git::Remote>> mData;
+    QList<QSharedPointer<Git::Remote>> mPendingData;
 };
@@ -11,6 +11,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "entities/signature.h"
 #include "entities/stash.h"
 #include "gitmanager.h"
+#include "repositorywatcher.h"
 #include <KLocalizedString>
 
 #include <git2/stash.h>
@@ -18,6 +19,12 @@ SPDX-License-Identifier: GPL-3.0-or-later
 StashesModel::StashesModel(Git::Manager *git, QObject *parent)
     : AbstractGitItemsModel(git, parent)
 {
+    connect(git->watcher(), &Git::RepositoryWatcher::stashChanged, this, &StashesModel::loadAsync);
+}
+
+StashesModel::~StashesModel()
+{
+    waitForLoad();
 }
 
 int StashesModel::rowCount(const QModelIndex &parent) const
@@ -93,10 +100,22 @@ void StashesModel::clear()
 
 void StashesModel::reload()
 {
-    if (mGit->isValid())
-        mData = mGit->stashes()->allStashes();
+    fetchData(mGit);
+    applyData();
+}
+
+void StashesModel::fetchData(Git::Manager *manager)
+{
+    if (manager->isValid())
+        mPendingData = manager->stashes()->allStashes();
     else
-        mData.clear();
+        mPendingData.clear();
+}
+
+void StashesModel::applyData()
+{
+    mData.swap(mPendingData);
+    mPendingData.clear();
 }
 
 #include "moc_stashesmodel.cpp"
@@ -29,6 +29,7 @@ public:
         LastColumn = Time,
     };
     explicit StashesModel(Git::Manager *git, QObject *parent = nullptr);
+    ~StashesModel() override;
 
     int rowCount(const QModelIndex &parent) const override;
     int columnCount(const QModelIndex &parent) const override;
@@ -40,7 +41,10 @@ public:
 
 protected:
     void reload() override;
+    void fetchData(Git::Manager *manager) override;
+    void applyData() override;
 
 private:
     QList<QSharedPointer<Git::Stash>> mData;
+    QList<QSharedPointer<Git::Stash>> mPendingData;
 };
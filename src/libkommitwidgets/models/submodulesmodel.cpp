@@ -15,6 +15,7 @@ class SubmodulesModelPrivate
 public:
     explicit SubmodulesModelPrivate(SubmodulesModel *parent, Git::Manager *manager);
     QList<QSharedPointer<Git::Submodule>> list;
+    QList<QSharedPointer<Git::Submodule>> pendingList;
     Git::Manager *manager;
     Git::SubmodulesCache *cache;
 
@@ -26,11 +27,20 @@ SubmodulesModel::SubmodulesModel(Git::Manager *manager)
     : AbstractGitItemsModel{manager}
     , d_ptr{new SubmodulesModelPrivate{this, manager}}
 {
-    connect(manager->submodules(), &Git::SubmodulesCache::added, this, &SubmodulesModel::append);
+    connect(manager->submodules(), &Git::SubmodulesCache::changed, this, [this](const Git::SubmodulesCache::ChangeSet &changes) {
+        Q_D(SubmodulesModel);
+        if (changes.inserted.isEmpty())
+            return;
+
+        beginInsertRows({}, d->list.size(), d->list.size() + changes.inserted.size() - 1);
+        d->list.append(changes.inserted);
+        endInsertRows();
+    });
 }
 
 SubmodulesModel::~SubmodulesModel()
 {
+    waitForLoad();
     Q_D(SubmodulesModel);
     delete d;
 }
@@ -112,10 +122,24 @@ QSharedPointer<Git::Submodule> SubmodulesModel::fromIndex(const QModelIndex &ind
 void SubmodulesModel::reload()
 {
     Q_D(SubmodulesModel);
-    if (d->manager->isValid())
-        d->list = d->manager->submodules()->allSubmodules();
+    fetchData(d->manager);
+    applyData();
+}
+
+void SubmodulesModel::fetchData(Git::Manager *manager)
+{
+    Q_D(SubmodulesModel);
+    if (manager->isValid())
+        d->pendingList = manager->submodules()->allSubmodules();
     else
-        d->list.clear();
+        d->pendingList.clear();
+}
+
+void SubmodulesModel::applyData()
+{
+    Q_D(SubmodulesModel);
+    d->list.swap(d->pendingList);
+    d->pendingList.clear();
 }
 
 SubmodulesModelPrivate::SubmodulesModelPrivate(SubmodulesModel *parent, Git::Manager *manager)
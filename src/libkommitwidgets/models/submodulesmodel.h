@@ -35,6 +35,10 @@ public:
 
     void reload() override;
 
+protected:
+    void fetchData(Git::Manager *manager) override;
+    void applyData() override;
+
 private:
     SubmodulesModelPrivate *d_ptr;
     Q_DECLARE_PRIVATE(SubmodulesModel);
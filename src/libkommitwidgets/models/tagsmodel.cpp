@@ -8,12 +8,22 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include "caches/tagscache.h"
 #include "entities/tag.h"
 #include "gitmanager.h"
+#include "repositorywatcher.h"
 
 #include <KLocalizedString>
 
 TagsModel::TagsModel(Git::Manager *git, QObject *parent)
     : AbstractGitItemsModel(git, parent)
 {
+    connect(git->watcher(), &Git::RepositoryWatcher::refsChanged, this, [this](const QStringList &names) {
+        if (Git::RepositoryWatcher::containsRefsUnder(names, QStringLiteral("refs/tags/")))
+            loadAsync();
+    });
+}
+
+TagsModel::~TagsModel()
+{
+    waitForLoad();
 }
 
 int TagsModel::rowCount(const QModelIndex &parent) const
@@ -85,10 +95,22 @@ void TagsModel::clear()
 
 void TagsModel::reload()
 {
-    if (mGit->isValid())
-        mData = mGit->tags()->allTags();
+    fetchData(mGit);
+    applyData();
+}
+
+void TagsModel::fetchData(Git::Manager *manager)
+{
+    if (manager->isValid())
+        mPendingData = manager->tags()->allTags();
     else
-        mData.clear();
+        mPendingData.clear();
+}
+
+void TagsModel::applyData()
+{
+    mData.swap(mPendingData);
+    mPendingData.clear();
 }
 
 #include "moc_tagsmodel.cpp"
@@ -28,6 +28,7 @@ public:
     };
     Q_ENUM(TagsModelRoles)
     explicit TagsModel(Git::Manager *git, QObject *parent = nullptr);
+    ~TagsModel() override;
 
     int rowCount(const QModelIndex &parent) const override;
     int columnCount(const QModelIndex &parent) const override;
@@ -39,7 +40,10 @@ public:
 
 protected:
     void reload() override;
+    void fetchData(Git::Manager *manager) override;
+    void applyData() override;
 
 private:
     QList<QSharedPointer<Git::Tag>> mData;
+    QList<QSharedPointer<Git::Tag>> mPendingData;
 };
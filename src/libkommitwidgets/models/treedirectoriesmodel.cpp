@@ -0,0 +1,154 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "treedirectoriesmodel.h"
+
+#include <entities/tree.h>
+
+#include <QFileIconProvider>
+
+TreeDirectoriesModel::TreeDirectoriesModel(QObject *parent)
+    : QAbstractItemModel(parent)
+    , mRoot{new Node}
+    , mIcon{QFileIconProvider{}.icon(QFileIconProvider::Folder)}
+{
+}
+
+TreeDirectoriesModel::~TreeDirectoriesModel()
+{
+    delete mRoot;
+}
+
+void TreeDirectoriesModel::setTree(QSharedPointer<Git::Tree> tree)
+{
+    beginResetModel();
+    qDeleteAll(mRoot->children);
+    mRoot->children.clear();
+
+    mTree = tree;
+    if (mTree) {
+        auto root = new Node;
+        root->title = QStringLiteral("/");
+        root->parent = mRoot;
+        mRoot->children << root;
+    }
+    endResetModel();
+}
+
+QSharedPointer<Git::Tree> TreeDirectoriesModel::tree() const
+{
+    return mTree;
+}
+
+QString TreeDirectoriesModel::path(const QModelIndex &index) const
+{
+    return index.isValid() ? node(index)->path : QString{};
+}
+
+QModelIndex TreeDirectoriesModel::rootIndex() const
+{
+    return index(0, 0);
+}
+
+QModelIndex TreeDirectoriesModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!hasIndex(row, column, parent))
+        return {};
+    return createIndex(row, column, node(parent)->children.at(row));
+}
+
+QModelIndex TreeDirectoriesModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid())
+        return {};
+
+    auto parentNode = node(child)->parent;
+    if (parentNode == mRoot)
+        return {};
+    return createIndex(parentNode->row, 0, parentNode);
+}
+
+int TreeDirectoriesModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0)
+        return 0;
+    return node(parent)->children.size();
+}
+
+int TreeDirectoriesModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return 1;
+}
+
+QVariant TreeDirectoriesModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return {};
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return node(index)->title;
+    case Qt::DecorationRole:
+        return mIcon;
+    }
+    return {};
+}
+
+bool TreeDirectoriesModel::hasChildren(const QModelIndex &parent) const
+{
+    if (!parent.isValid())
+        return !mRoot->children.isEmpty();
+
+    auto n = node(parent);
+    return n->fetched ? !n->children.isEmpty() : !directories(n).isEmpty();
+}
+
+bool TreeDirectoriesModel::canFetchMore(const QModelIndex &parent) const
+{
+    return parent.isValid() && !node(parent)->fetched;
+}
+
+void TreeDirectoriesModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+
+    auto n = node(parent);
+    n->fetched = true;
+
+    const auto &names = directories(n);
+    if (names.isEmpty())
+        return;
+
+    const auto prefix = n->path.isEmpty() ? QString{} : n->path + QLatin1Char('/');
+    beginInsertRows(parent, 0, names.size() - 1);
+    for (const auto &name : names) {
+        auto child = new Node;
+        child->title = name;
+        child->path = prefix + name;
+        child->parent = n;
+        child->row = n->children.size();
+        n->children << child;
+    }
+    endInsertRows();
+}
+
+TreeDirectoriesModel::Node *TreeDirectoriesModel::node(const QModelIndex &index) const
+{
+    return index.isValid() ? static_cast<Node *>(index.internalPointer()) : mRoot;
+}
+
+const QStringList &TreeDirectoriesModel::directories(Node *node) const
+{
+    if (!node->listed && mTree) {
+        node->directories = mTree->entries(node->path, Git::Tree::EntryType::Dir);
+        node->listed = true;
+    }
+    return node->directories;
+}
+
+#include "moc_treedirectoriesmodel.cpp"
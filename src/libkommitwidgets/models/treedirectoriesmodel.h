@@ -0,0 +1,74 @@
+/*
+SPDX-FileCopyrightText: 2021 Hamed Masafi <hamed.masfi@gmail.com>
+
+SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#pragma once
+
+#include "libkommitwidgets_export.h"
+
+#include <QAbstractItemModel>
+#include <QIcon>
+#include <QSharedPointer>
+#include <QStringList>
+
+namespace Git
+{
+class Tree;
+}
+
+/**
+ * The directories of a tree under a single root row, read one level at a time as the view
+ * expands them, so a large tree costs only what is shown of it.
+ */
+class LIBKOMMITWIDGETS_EXPORT TreeDirectoriesModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    explicit TreeDirectoriesModel(QObject *parent = nullptr);
+    ~TreeDirectoriesModel() override;
+
+    void setTree(QSharedPointer<Git::Tree> tree);
+    Q_REQUIRED_RESULT QSharedPointer<Git::Tree> tree() const;
+
+    // Path of the directory relative to the tree, "" for the root row
+    Q_REQUIRED_RESULT QString path(const QModelIndex &index) const;
+    Q_REQUIRED_RESULT QModelIndex rootIndex() const;
+
+    Q_REQUIRED_RESULT QModelIndex index(int row, int column, const QModelIndex &parent = {}) const override;
+    Q_REQUIRED_RESULT QModelIndex parent(const QModelIndex &child) const override;
+    Q_REQUIRED_RESULT int rowCount(const QModelIndex &parent = {}) const override;
+    Q_REQUIRED_RESULT int columnCount(const QModelIndex &parent = {}) const override;
+    Q_REQUIRED_RESULT QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    Q_REQUIRED_RESULT bool hasChildren(const QModelIndex &parent = {}) const override;
+    Q_REQUIRED_RESULT bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+private:
+    struct Node {
+        QString title;
+        QString path;
+        Node *parent{nullptr};
+        int row{0};
+        QList<Node *> children;
+        bool fetched{false};
+        // the subdirectories, known once the view asked whether there are any
+        bool listed{false};
+        QStringList directories;
+
+        ~Node()
+        {
+            qDeleteAll(children);
+        }
+    };
+
+    LIBKOMMITWIDGETS_NO_EXPORT Node *node(const QModelIndex &index) const;
+    LIBKOMMITWIDGETS_NO_EXPORT const QStringList &directories(Node *node) const;
+
+    QSharedPointer<Git::Tree> mTree;
+    // holds the root row
+    Node *const mRoot;
+    const QIcon mIcon;
+};
@@ -24,26 +24,60 @@ const Git::BlameData &BlameCodeView::blameData() const
 
 void BlameCodeView::setBlameData(const Git::BlameData &newBlameData)
 {
-    BlockType type{Odd};
-    const QVector<QColor> colors{QColor(200, 150, 150, 100), QColor(150, 200, 150, 100)};
-    int currentColor{0};
-    mBlameData = newBlameData;
-    QString lastCommit;
-    for (const auto &blame : newBlameData) {
-        const QString commitHash = blame.finalCommit ? blame.finalCommit->commitHash() : QString();
-
-        if (lastCommit != commitHash) {
-            currentColor = (currentColor + 1) % colors.size();
-            type = type == Odd ? Even : Odd;
-        }
+    QStringList lines;
+    for (const auto &blame : newBlameData)
+        lines << blame.code.split(QLatin1Char('\n'));
 
+    setContent(lines);
+    addBlameData(newBlameData);
+}
+
+void BlameCodeView::setContent(const QStringList &lines)
+{
+    clearAll();
+    mBlameData.clear();
+    mLines.fill(nullptr, lines.size());
+
+    setPlainText(lines.join(QLatin1Char('\n')));
+}
+
+void BlameCodeView::addBlameData(const Git::BlameData &rows)
+{
+    for (const auto &row : rows) {
+        const int firstLine = static_cast<int>(row.finalStartLineNumber) - 1;
+        const int lastLine = std::min<int>(firstLine + row.code.count(QLatin1Char('\n')), mLines.size() - 1);
+        if (firstLine < 0 || firstLine > lastLine)
+            continue;
+
+        const auto type = blockType(firstLine, lastLine, row);
         auto data = new BlockData{-1, nullptr, type};
-        data->extraText = blame.finalCommit ? blame.finalCommit->committer()->name() : i18n("Uncommited");
-        data->data = blame.finalCommit.data();
+        data->extraText = row.finalCommit ? row.finalCommit->committer()->name() : i18n("Uncommited");
+        data->data = row.finalCommit.data();
+
+        setBlocksData(firstLine, lastLine - firstLine + 1, type, data);
+        for (int line = firstLine; line <= lastLine; ++line)
+            mLines[line] = data;
 
-        append(blame.code, type, data);
-        lastCommit = commitHash;
+        mBlameData.append(row);
     }
 }
 
+CodeEditor::BlockType BlameCodeView::blockType(int firstLine, int lastLine, const Git::BlameDataRow &row) const
+{
+    // neighbouring hunks of different commits get different colors, whichever of them came first
+    const auto neighbour = [this, &row](int line) -> BlockType {
+        auto data = line >= 0 && line < mLines.size() ? mLines.at(line) : nullptr;
+        if (!data)
+            return Empty;
+        if (data->data == row.finalCommit.data())
+            return data->type;
+        return data->type == Odd ? Even : Odd;
+    };
+
+    auto type = neighbour(firstLine - 1);
+    if (type == Empty)
+        type = neighbour(lastLine + 1);
+    return type == Empty ? Odd : type;
+}
+
 #include "moc_blamecodeview.cpp"
@@ -11,6 +11,8 @@ SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "libkommitwidgets_export.h"
 
+#include <QVector>
+
 class LIBKOMMITWIDGETS_EXPORT BlameCodeView : public CodeEditor
 {
     Q_OBJECT
@@ -20,6 +22,15 @@ public:
     const Git::BlameData &blameData() const;
     void setBlameData(const Git::BlameData &newBlameData);
 
+    // Shows the lines of the blamed version before any of them is attributed
+    void setContent(const QStringList &lines);
+    // Attributes rows to the lines shown by setContent(), they may come in any order
+    void addBlameData(const Git::BlameData &rows);
+
 private:
+    LIBKOMMITWIDGETS_NO_EXPORT BlockType blockType(int firstLine, int lastLine, const Git::BlameDataRow &row) const;
+
     Git::BlameData mBlameData;
+    // data of every line attributed so far, by line index
+    QVector<BlockData *> mLines;
 };
@@ -19,6 +19,7 @@ SPDX-License-Identifier: GPL-3.0-or-later
 #include <QLabel>
 #include <QPainter>
 #include <QPalette>
+#include <QSet>
 
 #include <QtMath>
 
@@ -581,13 +582,29 @@ void CodeEditor::highlightSegment(Diff::Segment *segment)
     qCDebug(KOMMIT_WIDGETS_LOG) << "Segment not found";
 }
 
+void CodeEditor::setBlocksData(int blockNumber, int count, CodeEditor::BlockType type, BlockData *data)
+{
+    auto block = document()->findBlockByNumber(blockNumber);
+    QTextCursor cursor{block};
+    for (int i = 0; i < count && block.isValid(); ++i, block = block.next()) {
+        cursor.setPosition(block.position());
+        cursor.setBlockFormat(mFormats.value(type));
+        mBlocksData.insert(block, data);
+    }
+
+    // the sidebar grows with the longest extra text
+    updateViewPortGeometry();
+    mSideBar->update();
+}
+
 void CodeEditor::clearAll()
 {
     mSegments.clear();
     clear();
     mLastLineNumber = 0;
-    auto tmp = mBlocksData.values();
-    qDeleteAll(tmp);
+    // blocks of one blame hunk share their data
+    const auto tmp = mBlocksData.values();
+    qDeleteAll(QSet<BlockData *>{tmp.cbegin(), tmp.cend()});
     mBlocksData.clear();
 }
 
@@ -86,6 +86,8 @@ protected:
     void paintEvent(QPaintEvent *e) override;
     int sidebarWidth() const;
     void sidebarPaintEvent(QPaintEvent *event);
+    // Sets the type and data of count existing blocks from blockNumber on, data is shared by them
+    void setBlocksData(int blockNumber, int count, CodeEditor::BlockType type, BlockData *data);
     KSyntaxHighlighting::SyntaxHighlighter *const mHighlighter;
     CodeEditorSidebar *const mSideBar;
 
@@ -72,7 +72,7 @@ void CommitDetails::setCommit(Git::Commit *commit)
         return;
 
     labelCommitHash->setText(commit->commitHash());
-    labelCommitSubject->setText(commit->message());
+    labelCommitSubject->setText(commit->subject());
 
     showSignature(commit->author(), labelAuthorAvatar, labelAuthor, labelAuthTime, mEnableEmailsLinks);
     showSignature(commit->committer(), labelCommiterAvatar, labelCommitter, labelCommitTime, mEnableEmailsLinks);
@@ -205,7 +205,7 @@ QString CommitDetails::generateCommitLink(const QString &hash)
     if (mLogsModel) {
         auto commit = mLogsModel->findLogByHash(hash);
         if (commit)
-            subject = commit->message();
+            subject = commit->subject();
     }
     if (mEnableCommitsLinks)
         return QStringLiteral(R"(<a href="%1">%2</a> )").arg(hash, subject);
@@ -26,7 +26,7 @@ private:
     void slotCredentialRequeted(const QString &url, Git::Credential *cred);
     void slotTransferProgress(const Git::FetchTransferStat *stat);
     void slotPackProgress(const Git::PackProgress *progress);
-    void slotUpdateRef(QSharedPointer<Git::Reference> reference, QSharedPointer<Git::Oid> a, QSharedPointer<Git::Oid> b);
+    void slotUpdateRef(QSharedPointer<Git::Reference> reference, const Git::Oid &a, const Git::Oid &b);
     void slotFinished();
 
     Git::FetchObserver *mObserver{nullptr};